@@ -0,0 +1,107 @@
+// bench_broadphase.cpp  -- SpatialHash pair-finding time vs swarm size, against the O(n^2) check
+
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <vector>
+
+#include "tutorial17_rotations/SpatialHash.hpp"
+#include "tutorial17_rotations/SwarmRng.hpp"
+
+static const float kSize = 0.20f; // ECE_UAV::size_m
+
+struct Cloud
+{
+    std::vector<float> x, y, z;
+};
+
+// Uniform field at a fixed density of one drone per 0.5 m^3, so the contact count grows linearly
+static Cloud uniformField(std::size_t n, SwarmRng &rng)
+{
+    Cloud c;
+    float side = std::cbrt(0.5f * static_cast<float>(n));
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        c.x.push_back(rng.next01() * side);
+        c.y.push_back(rng.next01() * side);
+        c.z.push_back(rng.next01() * side);
+    }
+    return c;
+}
+
+// Everyone on the 10 m roaming sphere around (0, 50, 0): what the swarm looks like in steady state
+static Cloud roamingShell(std::size_t n, SwarmRng &rng)
+{
+    Cloud c;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        float u = 2.0f * rng.next01() - 1.0f;
+        float phi = 6.2831853f * rng.next01();
+        float s = std::sqrt(1.0f - u * u);
+        c.x.push_back(10.0f * s * std::cos(phi));
+        c.y.push_back(50.0f + 10.0f * s * std::sin(phi));
+        c.z.push_back(10.0f * u);
+    }
+    return c;
+}
+
+static std::size_t bruteForce(const Cloud &c)
+{
+    std::size_t pairs = 0;
+    const std::size_t n = c.x.size();
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = i + 1; j < n; ++j)
+            if (std::fabs(c.x[j] - c.x[i]) < kSize && std::fabs(c.y[j] - c.y[i]) < kSize &&
+                std::fabs(c.z[j] - c.z[i]) < kSize)
+                ++pairs;
+    return pairs;
+}
+
+template <class F> static double bestOfMs(int reps, F &&f)
+{
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t0;
+        if (ms.count() < best)
+            best = ms.count();
+    }
+    return best;
+}
+
+static void run(const char *name, Cloud (*make)(std::size_t, SwarmRng &))
+{
+    printf("\n%s\n%10s %10s %12s %12s %14s\n", name, "drones", "pairs", "hash ms", "ns/drone", "brute ms");
+    const std::size_t sizes[] = {15, 100, 1000, 10000, 100000};
+    for (std::size_t n : sizes)
+    {
+        SwarmRng rng(static_cast<std::uint32_t>(n));
+        Cloud c = make(n, rng);
+        SpatialHash hash;
+        std::vector<ContactPair> pairs;
+        double hashMs = bestOfMs(n > 10000 ? 5 : 20, [&]() {
+            hash.findPairs(c.x.data(), c.y.data(), c.z.data(), n, kSize, pairs);
+        });
+
+        if (n <= 10000)
+        {
+            std::size_t expected = 0;
+            double bruteMs = bestOfMs(n > 1000 ? 1 : 5, [&]() { expected = bruteForce(c); });
+            printf("%10zu %10zu %12.4f %12.1f %14.4f%s\n", n, pairs.size(), hashMs, hashMs * 1e6 / n, bruteMs,
+                   expected == pairs.size() ? "" : "  MISMATCH");
+        }
+        else
+        {
+            printf("%10zu %10zu %12.4f %12.1f %14s\n", n, pairs.size(), hashMs, hashMs * 1e6 / n, "-");
+        }
+    }
+}
+
+int main(void)
+{
+    run("uniform field, 0.5 m^3 per drone", uniformField);
+    run("roaming shell, r = 10 m", roamingShell);
+    return 0;
+}
@@ -0,0 +1,195 @@
+// bench_bullet.cpp  -- BulletScene's Dbvt broadphase against SpatialHash on a moving swarm, and the
+// drone-obstacle narrowphase
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "common/meshcache.hpp"
+#include "tutorial17_rotations/BulletScene.hpp"
+#include "tutorial17_rotations/SpatialHash.hpp"
+#include "tutorial17_rotations/SwarmRng.hpp"
+
+static const float kSize = 0.20f; // ECE_UAV::size_m
+static const float kDt = 0.01f;
+static const int kWarmupTicks = 10;
+static const int kTicks = 50;
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Drones at a fixed density of one per 0.5 m^3 flying straight at up to 10 m/s, bouncing off the walls of
+// their box: the Dbvt has to move every proxy every tick, which is its worst case
+struct Swarm
+{
+    std::vector<float> x, y, z, vx, vy, vz;
+    float side = 0.0f;
+
+    Swarm(std::size_t n, SwarmRng &rng) : side(std::cbrt(0.5f * static_cast<float>(n)))
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            x.push_back(rng.next01() * side);
+            y.push_back(rng.next01() * side);
+            z.push_back(rng.next01() * side);
+            vx.push_back(20.0f * rng.next01() - 10.0f);
+            vy.push_back(20.0f * rng.next01() - 10.0f);
+            vz.push_back(20.0f * rng.next01() - 10.0f);
+        }
+    }
+
+    void step()
+    {
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            move(x[i], vx[i]);
+            move(y[i], vy[i]);
+            move(z[i], vz[i]);
+        }
+    }
+
+    void move(float &p, float &v)
+    {
+        p += v * kDt;
+        if (p < 0.0f || p > side)
+        {
+            v = -v;
+            p = std::max(0.0f, std::min(p, side));
+        }
+    }
+};
+
+static bool samePairs(std::vector<ContactPair> a, std::vector<ContactPair> b)
+{
+    auto less = [](const ContactPair &p, const ContactPair &q) { return p.a != q.a ? p.a < q.a : p.b < q.b; };
+    std::sort(a.begin(), a.end(), less);
+    std::sort(b.begin(), b.end(), less);
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (a[i].a != b[i].a || a[i].b != b[i].b)
+            return false;
+    return true;
+}
+
+static void swarmVsSwarm()
+{
+    printf("moving swarm, 0.5 m^3 per drone, mean ms per tick over %d ticks\n", kTicks);
+    printf("%10s %9s %10s %10s %10s %10s %10s %10s %8s\n", "drones", "pairs", "hash", "bullet", "update", "broad",
+           "narrow", "cached", "ns/drone");
+    const std::size_t sizes[] = {1000, 10000, 50000, 100000};
+    for (std::size_t n : sizes)
+    {
+        SwarmRng rng(static_cast<std::uint32_t>(n));
+        Swarm swarm(n, rng);
+        SpatialHash hash;
+        BulletScene scene;
+        std::vector<ContactPair> hashPairs, bulletPairs;
+        std::vector<ObstacleContact> hits;
+        double hashMs = 0.0, bulletMs = 0.0, updateMs = 0.0, broadMs = 0.0, narrowMs = 0.0;
+        std::size_t pairs = 0, cached = 0;
+        bool match = true;
+        for (int t = 0; t < kWarmupTicks + kTicks; ++t)
+        {
+            swarm.step();
+            Clock::time_point t0 = Clock::now();
+            hash.findPairs(swarm.x.data(), swarm.y.data(), swarm.z.data(), n, kSize, hashPairs);
+            const double h = msSince(t0);
+            t0 = Clock::now();
+            scene.collide(swarm.x.data(), swarm.y.data(), swarm.z.data(), n, kSize, bulletPairs, hits);
+            const double b = msSince(t0);
+            match = match && samePairs(hashPairs, bulletPairs);
+            if (t < kWarmupTicks)
+                continue; // the first tick inserts every proxy
+            hashMs += h;
+            bulletMs += b;
+            updateMs += scene.stats().updateMs;
+            broadMs += scene.stats().broadphaseMs;
+            narrowMs += scene.stats().narrowphaseMs;
+            pairs += bulletPairs.size();
+            cached += scene.stats().cachedPairs;
+        }
+        printf("%10zu %9zu %10.3f %10.3f %10.3f %10.3f %10.3f %10zu %8.0f%s\n", n, pairs / kTicks, hashMs / kTicks,
+               bulletMs / kTicks, updateMs / kTicks, broadMs / kTicks, narrowMs / kTicks, cached / kTicks,
+               bulletMs / kTicks * 1e6 / n, match ? "" : "  MISMATCH");
+    }
+}
+
+// A roaming sphere of r = 40 m with Suzannes sitting on it, the swarm circling through them
+static void swarmVsObstacles(const MeshFile &mesh)
+{
+    printf("\nroaming shell r = 40 m with 6 Suzannes (%zu triangles each, 25 m across) on it\n", mesh.indexCount() / 3);
+    printf("%10s %10s %10s %10s %10s %10s\n", "drones", "hits", "bullet", "update", "broad", "narrow");
+    const std::size_t sizes[] = {1000, 10000, 100000};
+    const glm::vec3 seats[] = {glm::vec3(40, 50, 0), glm::vec3(-40, 50, 0), glm::vec3(0, 90, 0),
+                               glm::vec3(0, 10, 0),  glm::vec3(0, 50, 40),  glm::vec3(0, 50, -40)};
+    for (std::size_t n : sizes)
+    {
+        BulletScene scene;
+        for (const glm::vec3 &p : seats)
+            scene.addObstacle(mesh.positions(), mesh.vertexCount(), mesh.indices(), mesh.indexCount(),
+                              mesh.indexSize() == 2,
+                              glm::scale(glm::translate(glm::mat4(1.0f), p), glm::vec3(10.0f)));
+
+        // each drone circles the centre in its own plane at 0.25 rad/s, 10 m/s
+        SwarmRng rng(static_cast<std::uint32_t>(n));
+        std::vector<glm::vec3> axisA(n), axisB(n);
+        std::vector<float> phase(n), x(n), y(n), z(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const float u = 2.0f * rng.next01() - 1.0f, phi = 6.2831853f * rng.next01();
+            const float s = std::sqrt(1.0f - u * u);
+            axisA[i] = glm::vec3(s * std::cos(phi), s * std::sin(phi), u);
+            const glm::vec3 other = std::fabs(axisA[i].x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+            axisB[i] = glm::normalize(glm::cross(axisA[i], other));
+            phase[i] = 6.2831853f * rng.next01();
+        }
+
+        std::vector<ContactPair> pairs;
+        std::vector<ObstacleContact> hits;
+        double bulletMs = 0.0, updateMs = 0.0, broadMs = 0.0, narrowMs = 0.0;
+        std::size_t hitCount = 0;
+        for (int t = 0; t < kWarmupTicks + kTicks; ++t)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const float a = phase[i] + 0.25f * t * kDt;
+                const glm::vec3 p = glm::vec3(0, 50, 0) + 40.0f * (std::cos(a) * axisA[i] + std::sin(a) * axisB[i]);
+                x[i] = p.x;
+                y[i] = p.y;
+                z[i] = p.z;
+            }
+            const Clock::time_point t0 = Clock::now();
+            scene.collide(x.data(), y.data(), z.data(), n, kSize, pairs, hits);
+            const double b = msSince(t0);
+            if (t < kWarmupTicks)
+                continue;
+            bulletMs += b;
+            updateMs += scene.stats().updateMs;
+            broadMs += scene.stats().broadphaseMs;
+            narrowMs += scene.stats().narrowphaseMs;
+            hitCount += hits.size();
+        }
+        printf("%10zu %10zu %10.3f %10.3f %10.3f %10.3f\n", n, hitCount / kTicks, bulletMs / kTicks,
+               updateMs / kTicks, broadMs / kTicks, narrowMs / kTicks);
+    }
+}
+
+int main(void)
+{
+    swarmVsSwarm();
+
+    MeshFile suzanne;
+    if (!loadOBJCached(SCENE_DIR "suzanne.obj", suzanne, MeshCacheWeldPositions))
+        return 1;
+    swarmVsObstacles(suzanne);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// bench_cull.cpp  -- frustum culling time vs swarm size, SIMD against the scalar reference
+
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "tutorial17_rotations/FrustumCull.hpp"
+#include "tutorial17_rotations/SwarmRng.hpp"
+
+static const float kSize = 0.20f; // ECE_UAV::size_m
+
+// Drones spread through a 200 m box around the camera: most are outside the 100 m far plane or behind
+static std::vector<glm::vec3> openField(std::size_t n, SwarmRng &rng)
+{
+    std::vector<glm::vec3> p(n);
+    for (glm::vec3 &q : p)
+        q = glm::vec3(200.0f * rng.next01() - 100.0f, 100.0f * rng.next01(), 200.0f * rng.next01() - 100.0f);
+    return p;
+}
+
+// Everyone on the 10 m roaming sphere around (0, 50, 0): what the swarm looks like in steady state
+static std::vector<glm::vec3> roamingShell(std::size_t n, SwarmRng &rng)
+{
+    std::vector<glm::vec3> p(n);
+    for (glm::vec3 &q : p)
+    {
+        float u = 2.0f * rng.next01() - 1.0f;
+        float phi = 6.2831853f * rng.next01();
+        float s = std::sqrt(1.0f - u * u);
+        q = glm::vec3(10.0f * s * std::cos(phi), 50.0f + 10.0f * s * std::sin(phi), 10.0f * u);
+    }
+    return p;
+}
+
+template <class F> static double bestOfMs(int reps, F &&f)
+{
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t0;
+        if (ms.count() < best)
+            best = ms.count();
+    }
+    return best;
+}
+
+static void run(const char *name, std::vector<glm::vec3> (*make)(std::size_t, SwarmRng &), const Frustum &frustum)
+{
+    printf("\n%s\n%10s %10s %10s %12s %12s %12s\n", name, "drones", "visible", "culled", "simd ms", "ns/drone",
+           "scalar ms");
+    const std::size_t sizes[] = {15, 1000, 10000, 100000, 1000000};
+    for (std::size_t n : sizes)
+    {
+        SwarmRng rng(static_cast<std::uint32_t>(n));
+        std::vector<glm::vec3> p = make(n, rng);
+        std::vector<std::uint32_t> visible, expected;
+        CullStats stats, reference;
+        const int reps = n > 100000 ? 5 : 50;
+        double simdMs = bestOfMs(reps, [&]() { stats = cullCubes(frustum, p.data(), n, kSize, visible); });
+        double scalarMs =
+            bestOfMs(reps, [&]() { reference = cullCubesScalar(frustum, p.data(), n, kSize, expected); });
+        printf("%10zu %10zu %10zu %12.4f %12.2f %12.4f%s\n", n, stats.visible, stats.culled, simdMs, simdMs * 1e6 / n,
+               scalarMs, visible == expected ? "" : "  MISMATCH");
+    }
+}
+
+int main(void)
+{
+    // tutorial17's camera: 45 degree perspective, 0.1 to 100, at (0, 0.5, 5) looking up at the swarm
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    const glm::vec3 eye(0.0f, 0.5f, 5.0f);
+    const glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 50.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    printf("cull kernel: %s\n", cullKernelName());
+    run("open field, 200 m box", openField, frustum);
+    run("roaming shell, r = 10 m", roamingShell, frustum);
+    return 0;
+}
@@ -0,0 +1,59 @@
+// bench_meshopt.cpp  -- ACMR of the repo's OBJ assets before and after optimizeMesh, and their LOD chains
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+#include "common/meshoptimizer.hpp"
+#include "common/meshsimplify.hpp"
+#include "common/objloader.hpp"
+
+#ifndef OBJ_DIR
+#define OBJ_DIR "OBJ files/"
+#endif
+
+int main(void)
+{
+    const char *assets[] = {"Pingu_obj.obj", "Torus.obj",          "chicken_01.obj", "cono_hi.obj",
+                            "duck-float.obj", "mpm_vol.08_p16.OBJ"};
+
+    printf("%-20s %8s %8s %22s %22s %10s\n", "asset", "tris", "verts", "ACMR fifo16 before/after",
+           "ACMR fifo32 before/after", "opt ms");
+    for (const char *name : assets)
+    {
+        ObjMesh mesh;
+        if (!loadOBJ((std::string(OBJ_DIR) + name).c_str(), mesh) || mesh.indices.empty())
+            continue;
+        const std::size_t verts = mesh.vertices.size() / 3;
+        const float before16 = computeACMR(mesh.indices.data(), mesh.indices.size(), verts, 16);
+        const float before32 = computeACMR(mesh.indices.data(), mesh.indices.size(), verts, 32);
+
+        auto t0 = std::chrono::steady_clock::now();
+        optimizeMesh(mesh);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t0;
+
+        const float after16 = computeACMR(mesh.indices.data(), mesh.indices.size(), verts, 16);
+        const float after32 = computeACMR(mesh.indices.data(), mesh.indices.size(), verts, 32);
+        printf("%-20s %8zu %8zu %10.3f / %-9.3f %10.3f / %-9.3f %10.2f\n", name, mesh.indices.size() / 3, verts,
+               before16, after16, before32, after32, ms.count());
+
+        // drawn from positions alone (as the swarm draws the chicken), shared corners can merge
+        weldPositions(mesh);
+        const std::size_t welded = mesh.vertices.size() / 3;
+        const float weld16 = computeACMR(mesh.indices.data(), mesh.indices.size(), welded, 16);
+        optimizeMesh(mesh);
+        printf("%-20s %8s %8zu %10.3f / %-9.3f\n", "  positions only", "", welded, weld16,
+               computeACMR(mesh.indices.data(), mesh.indices.size(), welded, 16));
+
+        // the chain tutorial17 draws the swarm with: triangles and error (fraction of the bounding radius)
+        std::vector<MeshLod> lods;
+        t0 = std::chrono::steady_clock::now();
+        buildLodChain(mesh.vertices.data(), welded, mesh.indices, lods);
+        ms = std::chrono::steady_clock::now() - t0;
+        printf("%-20s", "  lods");
+        for (const MeshLod &l : lods)
+            printf(" %u (%.4f)", l.indexCount / 3, l.error);
+        printf("  %.2f ms\n", ms.count());
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+// bench_objzip.cpp  -- loadOBJFromZip streaming an archived OBJ against extracting it to disk and loading that
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "common/ziparchive.hpp"
+
+#ifndef OBJ_DIR
+#define OBJ_DIR "OBJ files/"
+#endif
+
+static const int kRuns = 20;
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// What the manual route costs: inflate the entry whole into memory, write it out, parse the file
+static bool extractAndLoad(const char *zipPath, const char *tempPath, ObjMesh &mesh)
+{
+    ZipArchive archive;
+    if (!archive.open(zipPath))
+        return false;
+    const int index = archive.findExtension(".obj");
+    if (index < 0)
+        return false;
+    const ZipEntry &entry = archive.entries()[index];
+    std::vector<char> text(entry.size);
+    ZipEntryReader reader(archive, entry);
+    for (std::size_t at = 0; at < text.size();)
+    {
+        const std::size_t n = reader.read(text.data() + at, text.size() - at);
+        if (n == 0)
+            return false;
+        at += n;
+    }
+    FILE *f = fopen(tempPath, "wb");
+    if (!f)
+        return false;
+    const bool written = fwrite(text.data(), 1, text.size(), f) == text.size();
+    fclose(f);
+    return written && loadOBJ(tempPath, mesh, 1);
+}
+
+int main(void)
+{
+    const char *archives[] = {"16_Geografia_Paper_globe_OBJ.zip"};
+    const std::string tempPath = "bench_objzip.tmp.obj";
+    printf("mean ms over %d runs\n", kRuns);
+    printf("%-36s %10s %10s %10s %10s %12s\n", "archive", "packed KB", "text KB", "extract", "stream", "triangles");
+    for (const char *name : archives)
+    {
+        const std::string path = std::string(OBJ_DIR) + name;
+        ZipArchive archive;
+        if (!archive.open(path.c_str()) || archive.findExtension(".obj") < 0)
+            return 1;
+        const ZipEntry &entry = archive.entries()[archive.findExtension(".obj")];
+
+        double extractMs = 0.0, streamMs = 0.0;
+        std::size_t triangles = 0;
+        for (int r = 0; r < kRuns; ++r)
+        {
+            ObjMesh a, b;
+            Clock::time_point t0 = Clock::now();
+            if (!extractAndLoad(path.c_str(), tempPath.c_str(), a))
+                return 1;
+            extractMs += msSince(t0);
+            t0 = Clock::now();
+            if (!loadOBJFromZip(path.c_str(), NULL, b))
+                return 1;
+            streamMs += msSince(t0);
+            if (a.indices != b.indices || a.vertices != b.vertices)
+            {
+                printf("%s: streamed mesh differs from the extracted one\n", name);
+                return 1;
+            }
+            triangles = b.indices.size() / 3;
+        }
+        remove(tempPath.c_str());
+        printf("%-36s %10.0f %10.0f %10.3f %10.3f %12zu\n", name, entry.compressedSize / 1024.0, entry.size / 1024.0,
+               extractMs / kRuns, streamMs / kRuns, triangles);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// bench_trajectory.cpp  -- trajectory recording cost and size against the simulation it records
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#include <zlib.h>
+
+#include "tutorial17_rotations/Scenario.hpp"
+#include "tutorial17_rotations/SpatialHash.hpp"
+#include "tutorial17_rotations/SwarmState.hpp"
+#include "tutorial17_rotations/TrajectoryFile.hpp"
+#include "tutorial17_rotations/TrajectoryRecorder.hpp"
+
+static const float kDt = 0.01f;
+static const int kStepsPerFrame = 10; // TrajectoryOptions::interval 0.1 s
+static const int kFrames = 64;        // one chunk
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Drones scattered over a 400 m square, done waiting after a second: the bench starts them mid-climb
+static Scenario field(std::size_t n)
+{
+    Scenario s = defaultScenario();
+    Formation &f = s.groups[0].formation;
+    f.kind = FormationRandom;
+    f.count = n;
+    f.boxMin = glm::vec3(-200.0f, -200.0f, 0.0f);
+    f.boxMax = glm::vec3(200.0f, 200.0f, 0.0f);
+    s.groups[0].params.waitSeconds = 1.0f;
+    return s;
+}
+
+int main()
+{
+    const TrajectoryOptions options;
+    printf("%d frames at %g s intervals, zlib level %d\n", kFrames, options.interval, options.compressionLevel);
+    // on one core the writer competes with the simulation: "writer %" is its share of the run
+    printf("%10s %10s %10s %10s %10s %10s %8s %14s\n", "drones", "step ms", "copy ms", "encode ms", "writer %",
+           "B/drone", "ratio", "10 min MB");
+
+    const std::size_t sizes[] = {1000, 10000, 100000};
+    for (std::size_t n : sizes)
+    {
+        SwarmState state;
+        populateSwarm(field(n), state);
+        SpatialHash broadphase;
+        std::vector<ContactPair> contacts;
+        std::size_t step = 0;
+        auto advance = [&]() {
+            stepSwarm(state, 0, n, kDt, static_cast<float>(step) * kDt);
+            ++step;
+            broadphase.findPairs(state.px.data(), state.py.data(), state.pz.data(), n, 0.2f, contacts);
+            resolveContacts(state, contacts);
+        };
+        // past the wait and into the climb, where every drone moves
+        while (step < 200)
+            advance();
+
+        TrajectoryFrame frame;
+        frame.resize(n);
+        TrajectoryCodec codec;
+        codec.reset(n, options.positionQuantum, options.velocityQuantum);
+        std::vector<std::uint8_t> raw;
+        double stepMs = 0.0, copyMs = 0.0, encodeMs = 0.0;
+        for (int f = 0; f < kFrames; ++f)
+        {
+            Clock::time_point t0 = Clock::now();
+            for (int s = 0; s < kStepsPerFrame; ++s)
+                advance();
+            stepMs += msSince(t0);
+
+            // what the simulation thread pays: TrajectoryRecorder::record's copy
+            t0 = Clock::now();
+            frame.px = state.px;
+            frame.py = state.py;
+            frame.pz = state.pz;
+            frame.vx = state.vx;
+            frame.vy = state.vy;
+            frame.vz = state.vz;
+            for (std::size_t i = 0; i < n; ++i)
+                frame.phase[i] = flightPhase(state, i, static_cast<float>(step) * kDt);
+            copyMs += msSince(t0);
+
+            t0 = Clock::now();
+            codec.encode(frame, raw);
+            encodeMs += msSince(t0);
+        }
+
+        // what the writer thread pays on top: one zlib stream per chunk
+        Clock::time_point t0 = Clock::now();
+        uLongf size = compressBound(static_cast<uLong>(raw.size()));
+        std::vector<std::uint8_t> compressed(size);
+        compress2(compressed.data(), &size, raw.data(), static_cast<uLong>(raw.size()), options.compressionLevel);
+        encodeMs += msSince(t0);
+
+        const double chunkBytes = static_cast<double>(size) + kFrames * sizeof(double);
+        const double rawBytes = static_cast<double>(kFrames) * n * (6 * sizeof(float) + 1);
+        const double framesPer10Min = 600.0 / options.interval;
+        printf("%10zu %10.3f %10.3f %10.3f %10.2f %10.2f %8.1f %14.1f\n", n, stepMs / (kFrames * kStepsPerFrame),
+               copyMs / kFrames, encodeMs / kFrames, 100.0 * encodeMs / (stepMs + copyMs + encodeMs),
+               chunkBytes / (kFrames * n), rawBytes / chunkBytes, chunkBytes / kFrames * framesPer10Min / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// bench_vboindexer.cpp  -- indexVBO_hash / indexVBO_TBN_hash against the map and linear-search indexers
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "common/objloader.hpp"
+#include "common/tangentspace.hpp"
+#include "common/vboindexer.hpp"
+
+#ifndef OBJ_DIR
+#define OBJ_DIR "OBJ files/"
+#endif
+
+// the linear searches are O(corners * unique vertices); skip them past this many corners
+static const std::size_t kMaxQuadratic = 100000;
+
+struct Soup
+{
+    std::vector<glm::vec3> vertices, normals, tangents, bitangents;
+    std::vector<glm::vec2> uvs;
+};
+
+static bool loadSoup(const char *name, Soup &s)
+{
+    std::string path = std::string(OBJ_DIR) + name;
+    std::vector<float> v, t, n;
+    if (!loadOBJ(path.c_str(), v, t, n))
+        return false;
+    for (std::size_t i = 0; i < v.size() / 3; ++i)
+    {
+        s.vertices.push_back(glm::vec3(v[i * 3], v[i * 3 + 1], v[i * 3 + 2]));
+        s.uvs.push_back(glm::vec2(t[i * 2], t[i * 2 + 1]));
+        s.normals.push_back(glm::vec3(n[i * 3], n[i * 3 + 1], n[i * 3 + 2]));
+    }
+    computeTangentBasis(s.vertices, s.uvs, s.normals, s.tangents, s.bitangents);
+    return true;
+}
+
+template <class F> static double bestOfMs(int reps, F &&f)
+{
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - t0;
+        if (ms.count() < best)
+            best = ms.count();
+    }
+    return best;
+}
+
+int main(void)
+{
+    const char *assets[] = {"Pingu_obj.obj", "Torus.obj",          "chicken_01.obj", "cono_hi.obj",
+                            "duck-float.obj", "mpm_vol.08_p16.OBJ"};
+
+    printf("%-20s %8s %8s %10s %10s %10s %10s %10s %10s\n", "asset", "corners", "unique", "slow ms", "map ms",
+           "hash ms", "hash16 ms", "TBN ms", "TBNhash ms");
+    for (const char *name : assets)
+    {
+        Soup s;
+        if (!loadSoup(name, s))
+            continue;
+        const std::size_t n = s.vertices.size();
+        const bool quadratic = n <= kMaxQuadratic;
+
+        std::vector<unsigned short> idx16, mapIdx;
+        std::vector<unsigned int> idx32;
+        std::vector<glm::vec3> ov, on, ot, ob;
+        std::vector<glm::vec2> ou;
+        auto reset = [&]() {
+            idx16.clear();
+            idx32.clear();
+            ov.clear();
+            on.clear();
+            ot.clear();
+            ob.clear();
+            ou.clear();
+        };
+
+        double slowMs = -1.0, tbnMs = -1.0;
+        if (quadratic)
+            slowMs = bestOfMs(1, [&]() {
+                reset();
+                indexVBO_slow(s.vertices, s.uvs, s.normals, idx16, ov, ou, on);
+            });
+        double mapMs = bestOfMs(5, [&]() {
+            reset();
+            indexVBO(s.vertices, s.uvs, s.normals, idx16, ov, ou, on);
+        });
+        mapIdx = idx16;
+        const std::size_t unique = ov.size();
+        bool fits16 = true;
+        double hash16Ms = bestOfMs(5, [&]() {
+            reset();
+            fits16 = indexVBO_hash(s.vertices, s.uvs, s.normals, idx16, ov, ou, on);
+        });
+        double hashMs = bestOfMs(5, [&]() {
+            reset();
+            indexVBO_hash(s.vertices, s.uvs, s.normals, idx32, ov, ou, on);
+        });
+        // both keep the first occurrence of each vertex, so the index buffers must agree exactly
+        bool same = ov.size() == unique && idx32.size() == mapIdx.size();
+        for (std::size_t i = 0; same && i < idx32.size(); ++i)
+            same = idx32[i] == mapIdx[i];
+
+        if (quadratic)
+            tbnMs = bestOfMs(1, [&]() {
+                reset();
+                indexVBO_TBN(s.vertices, s.uvs, s.normals, s.tangents, s.bitangents, idx16, ov, ou, on, ot, ob);
+            });
+        double tbnHashMs = bestOfMs(5, [&]() {
+            reset();
+            indexVBO_TBN_hash(s.vertices, s.uvs, s.normals, s.tangents, s.bitangents, idx32, ov, ou, on, ot, ob);
+        });
+
+        char slow[16] = "-", tbn[16] = "-";
+        if (quadratic)
+        {
+            snprintf(slow, sizeof(slow), "%.2f", slowMs);
+            snprintf(tbn, sizeof(tbn), "%.2f", tbnMs);
+        }
+        printf("%-20s %8zu %8zu %10s %10.3f %10.3f %10.3f %10s %10.3f%s%s\n", name, n, unique, slow, mapMs, hashMs,
+               hash16Ms, tbn, tbnHashMs, fits16 ? "" : "  (>65535, 16-bit refused)", same ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+// assetmanager.cpp  -- model import through Assimp on a pool of worker threads, handed to the GL thread
+// ready to upload
+
+#include "assetmanager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/config.h>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include "meshoptimizer.hpp"
+#include "ziparchive.hpp"
+
+namespace
+{
+
+const unsigned kMaxDefaultWorkers = 4;
+
+// Every mesh of the scene appended to one ObjMesh. PreTransformVertices has already baked the node
+// transforms in and SortByPType has dropped points and lines, but a polygon Triangulate could not handle
+// is skipped rather than trusted.
+void flattenScene(const aiScene &scene, ObjMesh &mesh)
+{
+    std::size_t vertexCount = 0, indexCount = 0;
+    for (unsigned m = 0; m < scene.mNumMeshes; ++m)
+    {
+        vertexCount += scene.mMeshes[m]->mNumVertices;
+        indexCount += scene.mMeshes[m]->mNumFaces * 3;
+    }
+    mesh.vertices.reserve(vertexCount * 3);
+    mesh.uvs.reserve(vertexCount * 2);
+    mesh.normals.reserve(vertexCount * 3);
+    mesh.indices.reserve(indexCount);
+
+    for (unsigned m = 0; m < scene.mNumMeshes; ++m)
+    {
+        const aiMesh &in = *scene.mMeshes[m];
+        const unsigned base = static_cast<unsigned>(mesh.vertices.size() / 3);
+        const bool uvs = in.HasTextureCoords(0), normals = in.HasNormals();
+        for (unsigned v = 0; v < in.mNumVertices; ++v)
+        {
+            mesh.vertices.insert(mesh.vertices.end(), {in.mVertices[v].x, in.mVertices[v].y, in.mVertices[v].z});
+            if (uvs)
+                mesh.uvs.insert(mesh.uvs.end(), {in.mTextureCoords[0][v].x, in.mTextureCoords[0][v].y});
+            else
+                mesh.uvs.insert(mesh.uvs.end(), {0.0f, 0.0f});
+            if (normals)
+                mesh.normals.insert(mesh.normals.end(), {in.mNormals[v].x, in.mNormals[v].y, in.mNormals[v].z});
+            else
+                mesh.normals.insert(mesh.normals.end(), {0.0f, 0.0f, 0.0f});
+        }
+        mesh.hasUVs = mesh.hasUVs || uvs;
+        mesh.hasNormals = mesh.hasNormals || normals;
+
+        ObjGroup group;
+        group.object = in.mName.C_Str();
+        aiString material;
+        if (in.mMaterialIndex < scene.mNumMaterials &&
+            scene.mMaterials[in.mMaterialIndex]->Get(AI_MATKEY_NAME, material) == AI_SUCCESS)
+            group.material = material.C_Str();
+        group.firstIndex = mesh.indices.size();
+        for (unsigned f = 0; f < in.mNumFaces; ++f)
+        {
+            const aiFace &face = in.mFaces[f];
+            if (face.mNumIndices != 3)
+                continue;
+            mesh.indices.insert(mesh.indices.end(),
+                                {base + face.mIndices[0], base + face.mIndices[1], base + face.mIndices[2]});
+        }
+        group.indexCount = mesh.indices.size() - group.firstIndex;
+        if (group.indexCount)
+            mesh.groups.push_back(group);
+    }
+}
+
+// `ext` in lower case
+bool hasExtension(const std::string &path, const char *ext)
+{
+    const std::size_t n = strlen(ext);
+    if (path.size() < n)
+        return false;
+    for (std::size_t i = 0; i < n; ++i)
+        if (tolower(static_cast<unsigned char>(path[path.size() - n + i])) != ext[i])
+            return false;
+    return true;
+}
+
+// The LOD table and bounds of a model that came through the mesh cache, where the file already has them
+void readMeshFile(ImportedModel &model)
+{
+    const MeshFile &file = *model.file;
+    model.lods.assign(file.lods(), file.lods() + file.lodCount());
+    for (int c = 0; c < 3; ++c)
+    {
+        model.boundsMin[c] = file.header().boundsMin[c];
+        model.boundsMax[c] = file.header().boundsMax[c];
+    }
+}
+
+void importModel(Assimp::Importer &importer, unsigned flags, ImportedModel &model)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // OBJ goes to loadOBJ through the mesh cache: several times faster than Assimp, and a current
+    // "<path>.mesh" (BulletScene's obstacle loading writes the same one) is mapped without parsing at all.
+    // Assimp 3.0's OBJ reader also gets relative face indices (f -1/-1/-1, as 3ds Max writes them) wrong.
+    if (hasExtension(model.path, ".obj"))
+    {
+        std::uint32_t options = 0;
+        if (flags & AssetWeldPositions)
+            options |= MeshCacheWeldPositions;
+        if (flags & AssetBuildLods)
+            options |= MeshCacheBuildLods;
+        model.file.reset(new MeshFile());
+        if (!loadOBJCached(model.path.c_str(), *model.file, options, &model.cached))
+        {
+            model.file.reset();
+            model.error = "cannot open or parse";
+            return;
+        }
+        if (model.file->indexCount() == 0)
+        {
+            model.error = "no triangles";
+            return;
+        }
+        readMeshFile(model);
+    }
+    else
+    {
+        // A zip archive is taken to hold an OBJ, which is parsed as it inflates; loadOBJ's output still
+        // needs the cache pass. Other formats go to Assimp.
+        const bool zip = hasExtension(model.path, ".zip");
+        if (zip)
+        {
+            if (!loadOBJFromZip(model.path.c_str(), NULL, model.mesh))
+            {
+                model.error = "cannot open or parse";
+                return;
+            }
+        }
+        else
+        {
+            // Welding throws the vertex order away again, so with it the cache pass is meshoptimizer's, below
+            unsigned steps = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices |
+                             aiProcess_PreTransformVertices | aiProcess_SortByPType;
+            if (!(flags & AssetWeldPositions))
+                steps |= aiProcess_ImproveCacheLocality;
+            const aiScene *scene = importer.ReadFile(model.path, steps);
+            if (!scene)
+            {
+                model.error = importer.GetErrorString();
+                return;
+            }
+            flattenScene(*scene, model.mesh);
+            importer.FreeScene();
+        }
+        if (model.mesh.indices.empty())
+        {
+            model.error = "no triangles";
+            return;
+        }
+
+        if (flags & AssetWeldPositions)
+            weldPositions(model.mesh);
+        if (zip || (flags & AssetWeldPositions))
+            optimizeMesh(model.mesh);
+        const std::size_t vertexCount = model.mesh.vertices.size() / 3;
+        if (flags & AssetBuildLods)
+            buildLodChain(model.mesh.vertices.data(), vertexCount, model.mesh.indices, model.lods);
+
+        for (int c = 0; c < 3; ++c)
+        {
+            model.boundsMin[c] = model.boundsMax[c] = model.mesh.vertices[c];
+            for (std::size_t i = 1; i < vertexCount; ++i)
+            {
+                model.boundsMin[c] = std::min(model.boundsMin[c], model.mesh.vertices[i * 3 + c]);
+                model.boundsMax[c] = std::max(model.boundsMax[c], model.mesh.vertices[i * 3 + c]);
+            }
+        }
+    }
+    model.ok = true;
+    model.importMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+AssetManager::AssetManager(unsigned workers)
+{
+    if (workers == 0)
+    {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workers = std::max(1u, std::min(kMaxDefaultWorkers, hardware > 1 ? hardware - 1 : 1u));
+    }
+    for (unsigned i = 0; i < workers; ++i)
+        threads.emplace_back(&AssetManager::work, this);
+}
+
+AssetManager::~AssetManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread &t : threads)
+        t.join();
+}
+
+std::uint32_t AssetManager::request(const std::string &path, unsigned flags)
+{
+    std::uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        jobs.push_back(Job{id, path, flags});
+        ++outstanding;
+    }
+    wake.notify_one();
+    return id;
+}
+
+bool AssetManager::poll(ImportedModel &out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (done.empty())
+        return false;
+    out = std::move(done.front());
+    done.pop_front();
+    --outstanding;
+    return true;
+}
+
+std::size_t AssetManager::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return outstanding;
+}
+
+void AssetManager::work()
+{
+    // Importers are not thread-safe, but separate ones are
+    Assimp::Importer importer;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        ImportedModel model;
+        model.id = job.id;
+        model.path = job.path;
+        importModel(importer, job.flags, model);
+        if (!model.ok)
+            fprintf(stderr, "AssetManager: cannot import %s: %s\n", job.path.c_str(), model.error.c_str());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done.push_back(std::move(model));
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+// assetmanager.hpp  -- model import through Assimp on a pool of worker threads, handed to the GL thread ready
+// to upload
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "meshcache.hpp"
+#include "meshsimplify.hpp"
+#include "objloader.hpp"
+
+enum
+{
+    AssetWeldPositions = 1 << 0, // weldPositions and optimizeMesh after import: for meshes drawn from positions
+    AssetBuildLods = 1 << 1      // append a buildLodChain to the indices
+};
+
+// One finished request. An OBJ arrives as the MeshFile loadOBJCached mapped (or built) for it; any other
+// format as mesh, the whole scene as one indexed triangle list with every node transform applied, each
+// Assimp mesh a group named after its material. The accessors below read whichever of the two is set.
+struct ImportedModel
+{
+    std::uint32_t id = 0; // from request()
+    std::string path;
+    bool ok = false;
+    bool cached = false; // an OBJ whose mesh file was current, so nothing was parsed
+    std::string error;   // Assimp's message when !ok
+    std::unique_ptr<MeshFile> file;
+    ObjMesh mesh;
+    std::vector<MeshLod> lods; // AssetBuildLods only
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+    double importMs = 0.0; // reading and post-processing, on the worker
+
+    const float *positions() const
+    {
+        return file ? file->positions() : mesh.vertices.data();
+    }
+    std::size_t vertexCount() const
+    {
+        return file ? file->vertexCount() : mesh.vertices.size() / 3;
+    }
+    const void *indices() const
+    {
+        return file ? file->indices() : mesh.indices.data();
+    }
+    std::size_t indexCount() const
+    {
+        return file ? file->indexCount() : mesh.indices.size();
+    }
+    std::size_t indexSize() const // 2 or 4
+    {
+        return file ? file->indexSize() : sizeof(unsigned int);
+    }
+};
+
+// Imports any format Assimp reads on `workers` threads, each with its own Assimp::Importer. OBJ goes
+// through loadOBJCached instead, so it shares "<path>.mesh" with every other user of the cache and is only
+// parsed when that is missing or stale; a zip archive goes to loadOBJFromZip for the OBJ inside.
+// Everything up to the vertex and index arrays (parsing, triangulation, joining identical vertices,
+// cache-locality ordering, and welding and LODs when asked for) happens on the worker; the GL thread only
+// polls for finished models and uploads them, so a window can open at once and fill in as models arrive.
+//
+// Results come back in the order they finish, not the order they were requested.
+class AssetManager
+{
+  public:
+    // 0: one worker per hardware thread beyond the first, at most 4
+    explicit AssetManager(unsigned workers = 0);
+    // Drops requests no worker has started and waits for the ones in progress
+    ~AssetManager();
+
+    AssetManager(const AssetManager &) = delete;
+    AssetManager &operator=(const AssetManager &) = delete;
+
+    // Queue an import of `path` with AssetWeldPositions / AssetBuildLods options. Returns the id the
+    // result will carry.
+    std::uint32_t request(const std::string &path, unsigned flags = 0);
+
+    // Take one finished model without blocking; false if none is ready
+    bool poll(ImportedModel &out);
+
+    // Requests not yet taken by poll
+    std::size_t pending();
+
+  private:
+    struct Job
+    {
+        std::uint32_t id;
+        std::string path;
+        unsigned flags;
+    };
+
+    void work();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::deque<ImportedModel> done;
+    std::size_t outstanding = 0;
+    std::uint32_t nextId = 1;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+};
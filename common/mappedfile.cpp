@@ -0,0 +1,121 @@
+// mappedfile.cpp  -- read-only memory mapping of a whole file
+
+#include "mappedfile.hpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char *path)
+{
+    close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    if (fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        opened = true;
+        return true;
+    }
+
+    // the mapping object keeps the file referenced, so the file handle can go right away
+    HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (map == NULL)
+        return false;
+    const void *view = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL)
+    {
+        CloseHandle(map);
+        return false;
+    }
+
+    mapping = map;
+    bytes = static_cast<const char *>(view);
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes != NULL)
+        UnmapViewOfFile(bytes);
+    if (mapping != NULL)
+        CloseHandle(static_cast<HANDLE>(mapping));
+    mapping = NULL;
+    bytes = NULL;
+    length = 0;
+    opened = false;
+}
+
+#else
+
+bool MappedFile::open(const char *path)
+{
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        opened = true;
+        return true;
+    }
+
+    // the mapping holds its own reference to the file, so the descriptor can go right away
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    // the whole file is about to be read: fault it in with one call instead of one fault per page
+    flags |= MAP_POPULATE;
+#endif
+    void *view = mmap(NULL, static_cast<std::size_t>(st.st_size), PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    // parsers walk the file front to back once: ask for aggressive read-ahead
+    madvise(view, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    bytes = static_cast<const char *>(view);
+    length = static_cast<std::size_t>(st.st_size);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes != NULL)
+        munmap(const_cast<char *>(bytes), length);
+    bytes = NULL;
+    length = 0;
+    opened = false;
+}
+
+#endif
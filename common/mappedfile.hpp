@@ -0,0 +1,47 @@
+#pragma once
+// mappedfile.hpp  -- read-only memory mapping of a whole file
+
+#include <cstddef>
+
+// The file's bytes, mapped read-only for the lifetime of the object. Nothing is copied: the OS pages
+// data in as it is touched, so parsers can scan the mapping directly. Empty files open successfully
+// with data() == NULL and size() == 0.
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const char *path)
+    {
+        open(path);
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const char *path);
+    void close();
+
+    bool isOpen() const
+    {
+        return opened;
+    }
+    const char *data() const
+    {
+        return bytes;
+    }
+    std::size_t size() const
+    {
+        return length;
+    }
+
+  private:
+    const char *bytes = NULL;
+    std::size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void *mapping = NULL; // HANDLE of the file mapping object
+#endif
+};
@@ -0,0 +1,292 @@
+// meshcache.cpp  -- binary mesh files, memory-mapped for zero-copy upload, and an OBJ cache built on them
+
+#include "meshcache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+
+#include "meshoptimizer.hpp"
+
+namespace
+{
+
+const char kMagic[8] = {'U', 'A', 'V', 'M', 'E', 'S', 'H', '\0'};
+
+inline std::size_t align16(std::size_t n)
+{
+    return (n + 15) & ~std::size_t(15);
+}
+
+inline bool streamInside(const MeshStream &s, std::size_t length)
+{
+    return s.offset % 4 == 0 && s.offset <= length && s.size <= length - s.offset;
+}
+
+template <class Index> bool indicesInRange(const void *indices, std::size_t count, std::size_t vertexCount)
+{
+    const Index *p = static_cast<const Index *>(indices);
+    Index highest = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        highest = std::max(highest, p[i]);
+    return count == 0 || highest < vertexCount;
+}
+
+bool sourceStat(const char *path, std::uint64_t &size, std::int64_t &time)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+    size = static_cast<std::uint64_t>(st.st_size);
+    time = static_cast<std::int64_t>(st.st_mtime);
+    return true;
+}
+
+} // namespace
+
+bool MeshFile::open(const char *path)
+{
+    close();
+    if (!file.open(path))
+        return false;
+    bytes = file.data();
+    length = file.size();
+    return validate();
+}
+
+bool MeshFile::adopt(std::vector<char> &image)
+{
+    close();
+    memory.swap(image);
+    bytes = memory.data();
+    length = memory.size();
+    return validate();
+}
+
+void MeshFile::close()
+{
+    file.close();
+    memory.clear();
+    bytes = NULL;
+    length = 0;
+}
+
+bool MeshFile::validate()
+{
+    if (length < sizeof(MeshFileHeader))
+    {
+        close();
+        return false;
+    }
+    const MeshFileHeader &h = header();
+    const std::size_t v = h.vertexCount, n = h.indexCount;
+    bool ok = memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kMeshFileVersion &&
+              (h.indexSize == 2 || h.indexSize == 4) && n % 3 == 0 && streamInside(h.positions, length) &&
+              streamInside(h.uvs, length) && streamInside(h.normals, length) && streamInside(h.indices, length) &&
+              h.positions.size == v * 3 * sizeof(float) &&
+              h.uvs.size == ((h.flags & MeshHasUVs) ? v * 2 * sizeof(float) : 0) &&
+              h.normals.size == ((h.flags & MeshHasNormals) ? v * 4 * sizeof(std::int16_t) : 0) &&
+              h.indices.size == n * h.indexSize && streamInside(h.lods, length) &&
+              h.lods.size % sizeof(MeshLod) == 0;
+    // an index past the vertex streams would make the GPU read outside the buffer, and so would a level
+    // that reaches past the indices
+    if (ok)
+        ok = h.indexSize == 2 ? indicesInRange<std::uint16_t>(indices(), n, v)
+                              : indicesInRange<std::uint32_t>(indices(), n, v);
+    for (std::size_t i = 0; ok && i < lodCount(); ++i)
+    {
+        const MeshLod &l = lods()[i];
+        ok = l.firstIndex % 3 == 0 && l.indexCount % 3 == 0 && l.firstIndex <= n && l.indexCount <= n - l.firstIndex;
+    }
+    if (!ok)
+        close();
+    return ok;
+}
+
+void buildMeshImage(const ObjMesh &mesh, const std::vector<MeshLod> &lods, std::uint32_t flags,
+                    std::uint64_t sourceHash, std::uint64_t sourceSize, std::int64_t sourceTime,
+                    std::vector<char> &image)
+{
+    const std::size_t v = mesh.vertices.size() / 3, n = mesh.indices.size();
+
+    MeshFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kMeshFileVersion;
+    h.flags = (flags & MeshBuildOptions) | (mesh.hasUVs ? MeshHasUVs : 0) | (mesh.hasNormals ? MeshHasNormals : 0);
+    h.sourceHash = sourceHash;
+    h.sourceSize = sourceSize;
+    h.sourceTime = sourceTime;
+    h.vertexCount = static_cast<std::uint32_t>(v);
+    h.indexCount = static_cast<std::uint32_t>(n);
+    h.indexSize = v <= 65536 ? 2 : 4;
+
+    for (int c = 0; c < 3; ++c)
+    {
+        h.boundsMin[c] = v ? mesh.vertices[c] : 0.0f;
+        h.boundsMax[c] = h.boundsMin[c];
+    }
+    for (std::size_t i = 0; i < v; ++i)
+        for (int c = 0; c < 3; ++c)
+        {
+            h.boundsMin[c] = std::min(h.boundsMin[c], mesh.vertices[i * 3 + c]);
+            h.boundsMax[c] = std::max(h.boundsMax[c], mesh.vertices[i * 3 + c]);
+        }
+
+    std::size_t end = align16(sizeof(h));
+    auto place = [&end](MeshStream &s, std::size_t size) {
+        s.offset = size ? end : 0;
+        s.size = size;
+        end = align16(end + size);
+    };
+    place(h.positions, v * 3 * sizeof(float));
+    place(h.uvs, mesh.hasUVs ? v * 2 * sizeof(float) : 0);
+    place(h.normals, mesh.hasNormals ? v * 4 * sizeof(std::int16_t) : 0);
+    place(h.indices, n * h.indexSize);
+    place(h.lods, lods.size() * sizeof(MeshLod));
+
+    image.assign(end, 0);
+    char *out = image.data();
+    memcpy(out, &h, sizeof(h));
+    memcpy(out + h.positions.offset, mesh.vertices.data(), h.positions.size);
+    if (h.uvs.size)
+        memcpy(out + h.uvs.offset, mesh.uvs.data(), h.uvs.size);
+    if (h.normals.size)
+    {
+        std::int16_t *normals = reinterpret_cast<std::int16_t *>(out + h.normals.offset);
+        for (std::size_t i = 0; i < v; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const float f = std::max(-1.0f, std::min(1.0f, mesh.normals[i * 3 + c]));
+                normals[i * 4 + c] = static_cast<std::int16_t>(std::lround(f * 32767.0f));
+            }
+            normals[i * 4 + 3] = 0;
+        }
+    }
+    if (h.indexSize == 2)
+    {
+        std::uint16_t *indices = reinterpret_cast<std::uint16_t *>(out + h.indices.offset);
+        for (std::size_t i = 0; i < n; ++i)
+            indices[i] = static_cast<std::uint16_t>(mesh.indices[i]);
+    }
+    else if (n)
+    {
+        memcpy(out + h.indices.offset, mesh.indices.data(), h.indices.size);
+    }
+    if (h.lods.size)
+        memcpy(out + h.lods.offset, lods.data(), h.lods.size);
+}
+
+bool writeMeshFile(const char *path, const std::vector<char> &image)
+{
+    // write next to the target and rename over it, so a reader never maps a half-written file. The temporary
+    // is per thread: two threads building the same mesh (two asset workers, or one and the main thread)
+    // must not truncate each other's.
+    const std::string temp =
+        std::string(path) + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (!f)
+        return false;
+    const bool written = fwrite(image.data(), 1, image.size(), f) == image.size();
+    if (fclose(f) != 0 || !written)
+    {
+        remove(temp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path); // rename does not replace on Windows
+#endif
+    if (rename(temp.c_str(), path) != 0)
+    {
+        remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool hashOBJSource(const char *path, std::uint64_t &hash, std::uint64_t &size, std::int64_t &time)
+{
+    if (!sourceStat(path, size, time))
+        return false;
+    MappedFile source;
+    if (!source.open(path))
+        return false;
+
+    // word-at-a-time multiply/xor-shift; plenty to notice an edited file
+    const char *p = source.data();
+    const std::size_t n = source.size();
+    std::uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        std::uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    std::uint64_t last = 0;
+    if (n > i)
+        memcpy(&last, p + i, n - i);
+    h = (h ^ last) * 0xC4CEB9FE1A85EC53ull;
+    hash = h ^ (h >> 29);
+    return true;
+}
+
+bool loadOBJCached(const char *objPath, MeshFile &mesh, std::uint32_t options, bool *fromCache)
+{
+    options &= MeshBuildOptions;
+    const std::string cachePath = std::string(objPath) + ".mesh";
+    if (fromCache)
+        *fromCache = false;
+
+    // Same size and timestamp as recorded: current, without reading the source at all. Otherwise the
+    // content hash decides (a touched but unchanged file is still a hit).
+    std::uint64_t size = 0, hash = 0;
+    std::int64_t time = 0;
+    const bool haveSource = sourceStat(objPath, size, time);
+    if (mesh.open(cachePath.c_str()) && (mesh.header().flags & MeshBuildOptions) == options)
+    {
+        const MeshFileHeader &h = mesh.header();
+        if (!haveSource || (h.sourceSize == size && h.sourceTime == time))
+        {
+            // no source to compare against: the cache is all there is
+            if (fromCache)
+                *fromCache = true;
+            return true;
+        }
+        if (h.sourceSize == size && hashOBJSource(objPath, hash, size, time) && h.sourceHash == hash)
+        {
+            if (fromCache)
+                *fromCache = true;
+            return true;
+        }
+    }
+    mesh.close();
+
+    if (!hashOBJSource(objPath, hash, size, time))
+    {
+        fprintf(stderr, "Failed to open OBJ: %s\n", objPath);
+        return false;
+    }
+    ObjMesh obj;
+    if (!loadOBJ(objPath, obj))
+        return false;
+    if (options & MeshCacheWeldPositions)
+        weldPositions(obj);
+    optimizeMesh(obj);
+    std::vector<MeshLod> lods;
+    if (options & MeshCacheBuildLods)
+        buildLodChain(obj.vertices.data(), obj.vertices.size() / 3, obj.indices, lods);
+
+    std::vector<char> image;
+    buildMeshImage(obj, lods, options, hash, size, time, image);
+    if (writeMeshFile(cachePath.c_str(), image) && mesh.open(cachePath.c_str()))
+        return true;
+    return mesh.adopt(image);
+}
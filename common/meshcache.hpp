@@ -0,0 +1,132 @@
+#pragma once
+// meshcache.hpp  -- binary mesh files, memory-mapped for zero-copy upload, and an OBJ cache built on them
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mappedfile.hpp"
+#include "meshsimplify.hpp"
+#include "objloader.hpp"
+
+// File layout: MeshFileHeader, then each stream at its own 16-byte aligned offset. All values are
+// little-endian.
+//   positions  float x3 per vertex
+//   uvs        float x2 per vertex (absent unless MeshHasUVs)
+//   normals    int16 x4 per vertex, signed normalized, w = 0 (absent unless MeshHasNormals)
+//   indices    uint16 or uint32 (indexSize) per corner, three per triangle; every level of detail
+//   lods       MeshLod per level, finest first, each a range of the indices (absent unless built with
+//              MeshCacheBuildLods)
+struct MeshStream
+{
+    std::uint64_t offset; // bytes from the start of the file
+    std::uint64_t size;   // bytes, 0 if absent
+};
+
+struct MeshFileHeader
+{
+    char magic[8];          // "UAVMESH"
+    std::uint32_t version;  // kMeshFileVersion
+    std::uint32_t flags;    // MeshCache* options the mesh was built with, plus MeshHas* bits
+    std::uint64_t sourceHash; // hashOBJSource of the OBJ it was built from
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime; // modification time of the source, seconds
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    std::uint32_t indexSize; // 2 or 4
+    std::uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    MeshStream positions, uvs, normals, indices, lods;
+};
+
+const std::uint32_t kMeshFileVersion = 3;
+
+enum
+{
+    // build options (part of what makes a cached file current)
+    MeshCacheWeldPositions = 1 << 0, // weldPositions before optimizing: for meshes drawn from positions only
+    MeshCacheBuildLods = 1 << 1,     // append a buildLodChain to the indices
+
+    // content bits
+    MeshHasUVs = 1 << 16,
+    MeshHasNormals = 1 << 17,
+    MeshBuildOptions = 0xFFFF
+};
+
+// A mesh file mapped read-only. The stream pointers point into the mapping and stay valid until the
+// object is closed or destroyed, so they can go to glBufferData as they are. open() checks the header
+// and that every stream and index lies inside the file before handing anything out.
+class MeshFile
+{
+  public:
+    bool open(const char *path);
+    // Same, over an image in memory (taken over by the object)
+    bool adopt(std::vector<char> &image);
+    void close();
+
+    const MeshFileHeader &header() const
+    {
+        return *reinterpret_cast<const MeshFileHeader *>(bytes);
+    }
+    std::size_t vertexCount() const
+    {
+        return header().vertexCount;
+    }
+    std::size_t indexCount() const
+    {
+        return header().indexCount;
+    }
+    std::size_t indexSize() const
+    {
+        return header().indexSize;
+    }
+    const float *positions() const
+    {
+        return reinterpret_cast<const float *>(bytes + header().positions.offset);
+    }
+    const float *uvs() const // NULL if absent
+    {
+        return header().uvs.size ? reinterpret_cast<const float *>(bytes + header().uvs.offset) : NULL;
+    }
+    const std::int16_t *normals() const // NULL if absent
+    {
+        return header().normals.size ? reinterpret_cast<const std::int16_t *>(bytes + header().normals.offset) : NULL;
+    }
+    const void *indices() const
+    {
+        return bytes + header().indices.offset;
+    }
+    std::size_t lodCount() const // 0 if the file has no LOD table
+    {
+        return static_cast<std::size_t>(header().lods.size / sizeof(MeshLod));
+    }
+    const MeshLod *lods() const
+    {
+        return reinterpret_cast<const MeshLod *>(bytes + header().lods.offset);
+    }
+
+  private:
+    bool validate();
+
+    MappedFile file;
+    std::vector<char> memory;
+    const char *bytes = NULL;
+    std::size_t length = 0;
+};
+
+// Serialise an indexed mesh and its LOD table (may be empty). Indices are stored in 16 bits when the
+// vertex count allows.
+void buildMeshImage(const ObjMesh &mesh, const std::vector<MeshLod> &lods, std::uint32_t flags,
+                    std::uint64_t sourceHash, std::uint64_t sourceSize, std::int64_t sourceTime,
+                    std::vector<char> &image);
+bool writeMeshFile(const char *path, const std::vector<char> &image);
+
+// 64-bit hash of a file's bytes; false if it cannot be read
+bool hashOBJSource(const char *path, std::uint64_t &hash, std::uint64_t &size, std::int64_t &time);
+
+// OBJ through the cache: "<objPath>.mesh" is used if it was built from the same source bytes with the
+// same options; otherwise the OBJ is parsed, optimized (optimizeMesh, after weldPositions if asked for),
+// given LODs if asked for and written there for next time. If the cache cannot be written the mesh is
+// still returned, from memory. *fromCache, if given, tells which way it went.
+bool loadOBJCached(const char *objPath, MeshFile &mesh, std::uint32_t options = 0, bool *fromCache = NULL);
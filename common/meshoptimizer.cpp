@@ -0,0 +1,301 @@
+// meshoptimizer.cpp  -- post-transform vertex cache and vertex fetch ordering for indexed meshes
+
+#include "meshoptimizer.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+
+// Forsyth's tuning: an LRU cache model of 32 entries, with the three most recent vertices (the last
+// triangle) scored flat so the next triangle does not simply reuse one edge of it.
+const int kCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+const int kMaxValence = 64; // valence scores are tabulated up to here
+
+float cacheScore[kCacheSize];
+float valenceScore[kMaxValence];
+
+struct ScoreTables
+{
+    ScoreTables()
+    {
+        for (int i = 0; i < kCacheSize; ++i)
+        {
+            if (i < 3)
+                cacheScore[i] = kLastTriScore;
+            else
+            {
+                const float scaler = 1.0f / (kCacheSize - 3);
+                cacheScore[i] = std::pow(1.0f - (i - 3) * scaler, kCacheDecayPower);
+            }
+        }
+        for (int i = 0; i < kMaxValence; ++i)
+            valenceScore[i] = i == 0 ? 0.0f : kValenceBoostScale * std::pow(static_cast<float>(i), -kValenceBoostPower);
+    }
+} scoreTables;
+
+inline float vertexScore(int cachePosition, unsigned int remaining)
+{
+    if (remaining == 0)
+        return -1.0f; // nothing left to draw from this vertex
+    float score = cachePosition >= 0 ? cacheScore[cachePosition] : 0.0f;
+    return score + valenceScore[remaining < kMaxValence ? remaining : kMaxValence - 1];
+}
+
+} // namespace
+
+float computeACMR(const unsigned int *indices, std::size_t indexCount, std::size_t vertexCount, unsigned cacheSize)
+{
+    if (indexCount < 3)
+        return 0.0f;
+
+    // FIFO: a hit does not refresh the entry. stamp[v] is the miss count when v last entered the cache,
+    // so v is still cached while fewer than cacheSize misses have happened since.
+    std::vector<std::size_t> stamp(vertexCount, 0);
+    std::size_t misses = 0;
+    for (std::size_t i = 0; i < indexCount; ++i)
+    {
+        const unsigned int v = indices[i];
+        if (stamp[v] == 0 || misses - stamp[v] + 1 > cacheSize)
+            stamp[v] = ++misses;
+    }
+    return static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+}
+
+void optimizeVertexCache(unsigned int *indices, std::size_t indexCount, std::size_t vertexCount)
+{
+    const std::size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+
+    // triangles of each vertex, as offset lists into one array
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i)
+        ++remaining[indices[i]];
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+        adjacencyStart[v + 1] = adjacencyStart[v] + remaining[v];
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    {
+        std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (std::size_t t = 0; t < triangleCount; ++t)
+            for (int k = 0; k < 3; ++k)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+        score[v] = vertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    for (std::size_t t = 0; t < triangleCount; ++t)
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+    std::vector<unsigned int> output(triangleCount * 3);
+
+    // three extra slots hold the vertices pushed out by the newest triangle until their scores drop
+    unsigned int cache[kCacheSize + 3];
+    int cacheCount = 0;
+
+    // the first triangle is the best overall; after that only triangles next to cached vertices are
+    // rescored, and a linear cursor supplies a fresh start when the cache runs dry
+    std::size_t best = 0;
+    for (std::size_t t = 1; t < triangleCount; ++t)
+        if (triangleScore[t] > triangleScore[best])
+            best = t;
+    std::size_t cursor = 0;
+
+    for (std::size_t out = 0; out < triangleCount; ++out)
+    {
+        const unsigned int *tri = &indices[best * 3];
+        output[out * 3 + 0] = tri[0];
+        output[out * 3 + 1] = tri[1];
+        output[out * 3 + 2] = tri[2];
+        emitted[best] = 1;
+
+        // drop the triangle from its vertices' lists
+        for (int k = 0; k < 3; ++k)
+        {
+            const unsigned int v = tri[k];
+            unsigned int *list = &adjacency[adjacencyStart[v]];
+            const unsigned int count = remaining[v];
+            for (unsigned int i = 0; i < count; ++i)
+                if (list[i] == best)
+                {
+                    list[i] = list[count - 1];
+                    break;
+                }
+            --remaining[v];
+        }
+
+        // LRU update: the triangle's vertices move to the front
+        unsigned int newCache[kCacheSize + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; ++k)
+            newCache[newCount++] = tri[k];
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            const unsigned int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                newCache[newCount++] = v;
+        }
+        for (int i = kCacheSize; i < newCount; ++i)
+            cachePosition[newCache[i]] = -1;
+        if (newCount > kCacheSize)
+        {
+            // rescore the evicted ones (their triangles are not tracked as candidates)
+            for (int i = kCacheSize; i < newCount; ++i)
+            {
+                const unsigned int v = newCache[i];
+                const float s = vertexScore(-1, remaining[v]);
+                const float delta = s - score[v];
+                score[v] = s;
+                for (unsigned int a = 0; a < remaining[v]; ++a)
+                    triangleScore[adjacency[adjacencyStart[v] + a]] += delta;
+            }
+            newCount = kCacheSize;
+        }
+        cacheCount = newCount;
+        for (int i = 0; i < cacheCount; ++i)
+            cache[i] = newCache[i];
+
+        // rescore the cached vertices and pick the best triangle around them
+        float bestScore = -1e30f;
+        bool found = false;
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            const unsigned int v = cache[i];
+            cachePosition[v] = i;
+            const float s = vertexScore(i, remaining[v]);
+            const float delta = s - score[v];
+            score[v] = s;
+            for (unsigned int a = 0; a < remaining[v]; ++a)
+                triangleScore[adjacency[adjacencyStart[v] + a]] += delta;
+        }
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            const unsigned int v = cache[i];
+            for (unsigned int a = 0; a < remaining[v]; ++a)
+            {
+                const unsigned int t = adjacency[adjacencyStart[v] + a];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                    found = true;
+                }
+            }
+        }
+        if (!found)
+        {
+            while (cursor < triangleCount && emitted[cursor])
+                ++cursor;
+            best = cursor;
+        }
+    }
+
+    for (std::size_t i = 0; i < triangleCount * 3; ++i)
+        indices[i] = output[i];
+}
+
+std::size_t optimizeVertexFetch(unsigned int *indices, std::size_t indexCount, std::size_t vertexCount,
+                                std::vector<unsigned int> &remap)
+{
+    remap.assign(vertexCount, ~0u);
+    unsigned int next = 0;
+    for (std::size_t i = 0; i < indexCount; ++i)
+    {
+        unsigned int &r = remap[indices[i]];
+        if (r == ~0u)
+            r = next++;
+        indices[i] = r;
+    }
+    return next;
+}
+
+void remapVertices(std::vector<float> &stream, std::size_t width, const std::vector<unsigned int> &remap,
+                   std::size_t newCount)
+{
+    std::vector<float> reordered(newCount * width);
+    for (std::size_t v = 0; v < remap.size(); ++v)
+        if (remap[v] != ~0u)
+            for (std::size_t c = 0; c < width; ++c)
+                reordered[remap[v] * width + c] = stream[v * width + c];
+    stream.swap(reordered);
+}
+
+void weldPositions(ObjMesh &mesh)
+{
+    const std::size_t vertexCount = mesh.vertices.size() / 3;
+    std::size_t size = 16;
+    while (size < 2 * vertexCount)
+        size <<= 1;
+    // linear probing over first-occurrence vertex numbers + 1 (0 = empty)
+    std::vector<unsigned int> table(size, 0);
+    std::vector<unsigned int> remap(vertexCount);
+    unsigned int next = 0;
+    std::vector<unsigned int> firstOf; // welded vertex -> its first original
+    for (std::size_t v = 0; v < vertexCount; ++v)
+    {
+        std::uint32_t bits[3];
+        memcpy(bits, &mesh.vertices[v * 3], sizeof(bits));
+        std::uint32_t h = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        h ^= h >> 16;
+        for (std::size_t slot = h & (size - 1);; slot = (slot + 1) & (size - 1))
+        {
+            if (table[slot] == 0)
+            {
+                table[slot] = next + 1;
+                firstOf.push_back(static_cast<unsigned int>(v));
+                remap[v] = next++;
+                break;
+            }
+            const unsigned int w = table[slot] - 1;
+            if (memcmp(&mesh.vertices[firstOf[w] * 3], bits, sizeof(bits)) == 0)
+            {
+                remap[v] = w;
+                break;
+            }
+        }
+    }
+    for (unsigned int &i : mesh.indices)
+        i = remap[i];
+
+    // keep the first original of each welded vertex
+    std::vector<unsigned int> keep(vertexCount, ~0u);
+    for (unsigned int w = 0; w < next; ++w)
+        keep[firstOf[w]] = w;
+    remapVertices(mesh.vertices, 3, keep, next);
+    remapVertices(mesh.uvs, 2, keep, next);
+    remapVertices(mesh.normals, 3, keep, next);
+}
+
+void optimizeMesh(ObjMesh &mesh)
+{
+    const std::size_t vertexCount = mesh.vertices.size() / 3;
+    // Forsyth's scoring models a 32-entry LRU cache, and an order that is already good (a re-run, or a
+    // mesh welded after optimizing) can come out worse on the FIFO caches real GPUs have. Judge by
+    // computeACMR's 16-entry FIFO and keep the order it had unless the new one wins.
+    const std::vector<unsigned int> original = mesh.indices;
+    const float before = computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    if (mesh.groups.empty())
+        optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    for (const ObjGroup &g : mesh.groups)
+        optimizeVertexCache(mesh.indices.data() + g.firstIndex, g.indexCount, vertexCount);
+    if (computeACMR(mesh.indices.data(), mesh.indices.size(), vertexCount) >= before)
+        mesh.indices = original;
+
+    std::vector<unsigned int> remap;
+    const std::size_t used = optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), vertexCount, remap);
+    remapVertices(mesh.vertices, 3, remap, used);
+    remapVertices(mesh.uvs, 2, remap, used);
+    remapVertices(mesh.normals, 3, remap, used);
+}
@@ -0,0 +1,39 @@
+#pragma once
+// meshoptimizer.hpp  -- post-transform vertex cache and vertex fetch ordering for indexed meshes
+
+#include <cstddef>
+#include <vector>
+
+#include "objloader.hpp"
+
+// Average cache miss ratio: vertex shader runs per triangle when the index buffer is drawn through a
+// FIFO post-transform cache of cacheSize entries. 3 means no reuse at all; a well-ordered regular grid
+// approaches 0.5.
+float computeACMR(const unsigned int *indices, std::size_t indexCount, std::size_t vertexCount,
+                  unsigned cacheSize = 16);
+
+// Reorder triangles in place for the post-transform cache (Tom Forsyth's "Linear-speed vertex cache
+// optimisation"): repeatedly emit the triangle whose vertices score best, scoring recently used vertices
+// high and vertices with few remaining triangles higher still, so fans are finished before moving on.
+// Runs in time linear in the triangle count.
+void optimizeVertexCache(unsigned int *indices, std::size_t indexCount, std::size_t vertexCount);
+
+// Renumber vertices in the order the index buffer first uses them, so vertex fetches walk memory
+// forwards. Rewrites indices and fills remap[old] = new (~0u for unused vertices); returns the number
+// of vertices in use. Apply the remap to every vertex stream with remapVertices.
+std::size_t optimizeVertexFetch(unsigned int *indices, std::size_t indexCount, std::size_t vertexCount,
+                                std::vector<unsigned int> &remap);
+
+// Reorder a stream of `width` floats per vertex by a remap from optimizeVertexFetch
+void remapVertices(std::vector<float> &stream, std::size_t width, const std::vector<unsigned int> &remap,
+                   std::size_t newCount);
+
+// Merge vertices whose positions are bitwise equal, for meshes drawn from positions alone. Exporters
+// often give every face its own vertices (chicken_01.obj shares none), which makes any triangle order
+// miss the cache on every corner. A merged vertex keeps the uv and normal of its first occurrence.
+void weldPositions(ObjMesh &mesh);
+
+// Both passes on an ObjMesh: triangles are reordered within each group, so groups keep their index
+// ranges, then all three vertex streams are put in fetch order. The new triangle order is kept only if
+// it lowers computeACMR at the default 16-entry FIFO; otherwise the mesh keeps its own.
+void optimizeMesh(ObjMesh &mesh);
@@ -0,0 +1,348 @@
+// meshsimplify.cpp  -- quadric edge-collapse simplification and LOD chains that share one vertex buffer
+
+#include "meshsimplify.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "meshoptimizer.hpp"
+
+namespace
+{
+
+// Border edges get a plane perpendicular to their triangle, weighted this many times the squared edge
+// length, so open edges keep their outline instead of shrinking inwards
+const double kBorderWeight = 10.0;
+// A collapse is refused if it turns any remaining triangle by more than about 75 degrees, which catches
+// flips and the slivers just before them
+const float kMinNormalCos = 0.25f;
+const int kMaxPasses = 100;
+
+// Sum of squared distances to a set of planes, weighted by triangle area: p'Ap + 2b'p + c, A symmetric.
+// Doubles because the terms of a nearly flat patch cancel almost exactly.
+struct Quadric
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+};
+
+void addPlane(Quadric &q, double nx, double ny, double nz, double d, double w)
+{
+    q.a00 += w * nx * nx;
+    q.a01 += w * nx * ny;
+    q.a02 += w * nx * nz;
+    q.a11 += w * ny * ny;
+    q.a12 += w * ny * nz;
+    q.a22 += w * nz * nz;
+    q.b0 += w * nx * d;
+    q.b1 += w * ny * d;
+    q.b2 += w * nz * d;
+    q.c += w * d * d;
+    q.weight += w;
+}
+
+void addQuadric(Quadric &q, const Quadric &r)
+{
+    q.a00 += r.a00;
+    q.a01 += r.a01;
+    q.a02 += r.a02;
+    q.a11 += r.a11;
+    q.a12 += r.a12;
+    q.a22 += r.a22;
+    q.b0 += r.b0;
+    q.b1 += r.b1;
+    q.b2 += r.b2;
+    q.c += r.c;
+    q.weight += r.weight;
+}
+
+// Mean squared distance of p to the planes of q
+double quadricError(const Quadric &q, const float *p)
+{
+    const double x = p[0], y = p[1], z = p[2];
+    const double e = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+                     2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) + 2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) +
+                     q.c;
+    return q.weight > 0.0 ? std::fabs(e) / q.weight : 0.0;
+}
+
+inline void triangleNormal(const float *a, const float *b, const float *c, float *n)
+{
+    const float ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+    const float vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+    n[0] = uy * vz - uz * vy;
+    n[1] = uz * vx - ux * vz;
+    n[2] = ux * vy - uy * vx;
+}
+
+inline float dot(const float *a, const float *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+enum VertexKind : unsigned char
+{
+    Interior = 0,
+    Border = 1, // on an edge used by one triangle: moves only along such edges
+    Locked = 2  // on an edge shared by three or more triangles: never moves
+};
+
+struct Edge
+{
+    unsigned int a, b; // a < b
+    bool border;
+};
+
+struct Collapse
+{
+    double cost;
+    unsigned int from, to;
+    bool operator<(const Collapse &o) const
+    {
+        return cost < o.cost;
+    }
+};
+
+// Unique edges of the triangles, sorted by (a, b), and the kind of every vertex they touch
+void classifyEdges(const std::vector<unsigned int> &indices, std::vector<std::uint64_t> &keys,
+                   std::vector<Edge> &edges, std::vector<unsigned char> &kind)
+{
+    keys.clear();
+    for (std::size_t t = 0; t < indices.size(); t += 3)
+        for (int e = 0; e < 3; ++e)
+        {
+            const unsigned int a = indices[t + e], b = indices[t + (e + 1) % 3];
+            keys.push_back(a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a);
+        }
+    std::sort(keys.begin(), keys.end());
+
+    edges.clear();
+    std::fill(kind.begin(), kind.end(), Interior);
+    for (std::size_t i = 0; i < keys.size();)
+    {
+        std::size_t j = i + 1;
+        while (j < keys.size() && keys[j] == keys[i])
+            ++j;
+        const Edge e = {static_cast<unsigned int>(keys[i] >> 32), static_cast<unsigned int>(keys[i]), j - i == 1};
+        const unsigned char k = j - i == 1 ? Border : j - i == 2 ? Interior : Locked;
+        kind[e.a] = std::max(kind[e.a], k);
+        kind[e.b] = std::max(kind[e.b], k);
+        edges.push_back(e);
+        i = j;
+    }
+}
+
+bool isBorderEdge(const std::vector<Edge> &edges, unsigned int a, unsigned int b)
+{
+    const Edge key = {std::min(a, b), std::max(a, b), false};
+    auto it = std::lower_bound(edges.begin(), edges.end(), key, [](const Edge &x, const Edge &y) {
+        return x.a != y.a ? x.a < y.a : x.b < y.b;
+    });
+    return it != edges.end() && it->a == key.a && it->b == key.b && it->border;
+}
+
+} // namespace
+
+std::size_t simplifyMesh(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                         const float *positions, std::size_t vertexCount, std::size_t targetIndexCount,
+                         float targetError, float *resultError)
+{
+    std::vector<unsigned int> result(indices, indices + (indexCount - indexCount % 3));
+    double worst = 0.0;
+
+    // work in a unit box so targetError and the flip threshold do not depend on the model's scale
+    float lo[3] = {0.0f, 0.0f, 0.0f}, hi[3] = {0.0f, 0.0f, 0.0f};
+    for (std::size_t i = 0; i < vertexCount; ++i)
+        for (int c = 0; c < 3; ++c)
+        {
+            lo[c] = i ? std::min(lo[c], positions[i * 3 + c]) : positions[c];
+            hi[c] = i ? std::max(hi[c], positions[i * 3 + c]) : positions[c];
+        }
+    const float extent = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+    const float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+    std::vector<float> p(vertexCount * 3);
+    for (std::size_t i = 0; i < vertexCount; ++i)
+        for (int c = 0; c < 3; ++c)
+            p[i * 3 + c] = (positions[i * 3 + c] - lo[c]) * scale;
+
+    std::vector<std::uint64_t> keys;
+    std::vector<Edge> edges;
+    std::vector<unsigned char> kind(vertexCount);
+    classifyEdges(result, keys, edges, kind);
+
+    // quadrics of the original surface: every triangle's plane, weighted by area, plus the border planes
+    std::vector<Quadric> quadrics(vertexCount, Quadric());
+    for (std::size_t t = 0; t < result.size(); t += 3)
+    {
+        const unsigned int *v = &result[t];
+        float n[3];
+        triangleNormal(&p[v[0] * 3], &p[v[1] * 3], &p[v[2] * 3], n);
+        const float length = std::sqrt(dot(n, n));
+        if (length == 0.0f)
+            continue;
+        n[0] /= length, n[1] /= length, n[2] /= length;
+        const double d = -dot(n, &p[v[0] * 3]);
+        for (int c = 0; c < 3; ++c)
+            addPlane(quadrics[v[c]], n[0], n[1], n[2], d, 0.5 * length);
+
+        for (int e = 0; e < 3; ++e)
+        {
+            const unsigned int a = v[e], b = v[(e + 1) % 3];
+            if (!isBorderEdge(edges, a, b))
+                continue;
+            const float *pa = &p[a * 3], *pb = &p[b * 3];
+            const float ex = pb[0] - pa[0], ey = pb[1] - pa[1], ez = pb[2] - pa[2];
+            float m[3] = {ey * n[2] - ez * n[1], ez * n[0] - ex * n[2], ex * n[1] - ey * n[0]};
+            const float mlength = std::sqrt(dot(m, m));
+            if (mlength == 0.0f)
+                continue;
+            m[0] /= mlength, m[1] /= mlength, m[2] /= mlength;
+            const double md = -dot(m, pa);
+            const double w = kBorderWeight * (ex * ex + ey * ey + ez * ez);
+            addPlane(quadrics[a], m[0], m[1], m[2], md, w);
+            addPlane(quadrics[b], m[0], m[1], m[2], md, w);
+        }
+    }
+
+    const double limit = double(targetError) * double(targetError);
+    const std::size_t targetTriangles = targetIndexCount / 3;
+    std::vector<unsigned int> triangleStart(vertexCount + 1), vertexTriangles, remap(vertexCount);
+    std::vector<unsigned char> touched(vertexCount);
+    std::vector<Collapse> collapses;
+
+    for (int pass = 0; pass < kMaxPasses && result.size() / 3 > targetTriangles; ++pass)
+    {
+        if (pass > 0)
+            classifyEdges(result, keys, edges, kind);
+
+        // triangles around each vertex, as offset lists into one array
+        std::fill(triangleStart.begin(), triangleStart.end(), 0);
+        for (unsigned int v : result)
+            ++triangleStart[v + 1];
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            triangleStart[v + 1] += triangleStart[v];
+        vertexTriangles.resize(result.size());
+        for (std::size_t i = 0; i < result.size(); ++i)
+            vertexTriangles[triangleStart[result[i]]++] = static_cast<unsigned int>(i / 3);
+        for (std::size_t v = vertexCount; v > 0; --v)
+            triangleStart[v] = triangleStart[v - 1];
+        triangleStart[0] = 0;
+
+        // the cheaper allowed direction of every edge
+        collapses.clear();
+        for (const Edge &e : edges)
+        {
+            Collapse best = {-1.0, 0, 0};
+            for (int dir = 0; dir < 2; ++dir)
+            {
+                const unsigned int from = dir ? e.b : e.a, to = dir ? e.a : e.b;
+                if (kind[from] == Locked || (kind[from] == Border && !e.border))
+                    continue;
+                Quadric q = quadrics[from];
+                addQuadric(q, quadrics[to]);
+                const double cost = quadricError(q, &p[to * 3]);
+                if (best.cost < 0.0 || cost < best.cost)
+                    best = Collapse{cost, from, to};
+            }
+            if (best.cost >= 0.0 && best.cost <= limit)
+                collapses.push_back(best);
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        // Greedy over independent edges: a vertex takes part in at most one collapse per pass, so every
+        // cost above is still exact when its turn comes. Triangles are rewritten once, after the pass.
+        for (std::size_t v = 0; v < vertexCount; ++v)
+            remap[v] = static_cast<unsigned int>(v);
+        std::fill(touched.begin(), touched.end(), 0);
+        std::size_t triangles = result.size() / 3, applied = 0;
+        for (const Collapse &c : collapses)
+        {
+            if (triangles <= targetTriangles)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            bool flips = false;
+            std::size_t removed = 0;
+            for (unsigned int k = triangleStart[c.from]; k < triangleStart[c.from + 1] && !flips; ++k)
+            {
+                const unsigned int *t = &result[vertexTriangles[k] * 3];
+                const int corner = t[0] == c.from ? 0 : t[1] == c.from ? 1 : 2;
+                const unsigned int x = remap[t[(corner + 1) % 3]], y = remap[t[(corner + 2) % 3]];
+                if (x == c.to || y == c.to || x == y)
+                {
+                    ++removed; // degenerates and goes away
+                    continue;
+                }
+                float before[3], after[3];
+                triangleNormal(&p[c.from * 3], &p[x * 3], &p[y * 3], before);
+                triangleNormal(&p[c.to * 3], &p[x * 3], &p[y * 3], after);
+                flips = dot(before, after) < kMinNormalCos * std::sqrt(dot(before, before) * dot(after, after));
+            }
+            if (flips)
+                continue;
+
+            remap[c.from] = c.to;
+            addQuadric(quadrics[c.to], quadrics[c.from]);
+            touched[c.from] = touched[c.to] = 1;
+            worst = std::max(worst, c.cost);
+            triangles -= std::min(triangles, removed);
+            ++applied;
+        }
+        if (applied == 0)
+            break;
+
+        std::size_t write = 0;
+        for (std::size_t t = 0; t < result.size(); t += 3)
+        {
+            const unsigned int a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    std::copy(result.begin(), result.end(), destination);
+    if (resultError)
+        *resultError = static_cast<float>(std::sqrt(worst)) * extent;
+    return result.size();
+}
+
+void buildLodChain(const float *positions, std::size_t vertexCount, std::vector<unsigned int> &indices,
+                   std::vector<MeshLod> &lods, unsigned maxLevels, float maxError)
+{
+    const std::size_t baseCount = indices.size() - indices.size() % 3;
+    lods.assign(1, MeshLod{0, static_cast<std::uint32_t>(baseCount), 0.0f});
+
+    float lo[3] = {0.0f, 0.0f, 0.0f}, hi[3] = {0.0f, 0.0f, 0.0f};
+    for (std::size_t i = 0; i < vertexCount; ++i)
+        for (int c = 0; c < 3; ++c)
+        {
+            lo[c] = i ? std::min(lo[c], positions[i * 3 + c]) : positions[c];
+            hi[c] = i ? std::max(hi[c], positions[i * 3 + c]) : positions[c];
+        }
+    const float diagonal[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+    const float radius = 0.5f * std::sqrt(dot(diagonal, diagonal));
+
+    std::vector<unsigned int> level(baseCount);
+    std::size_t previous = baseCount;
+    for (unsigned l = 1; l < maxLevels; ++l)
+    {
+        float error = 0.0f;
+        const std::size_t count = simplifyMesh(level.data(), indices.data(), baseCount, positions, vertexCount,
+                                               previous / 6 * 3, maxError, &error);
+        if (count == 0 || count > previous / 5 * 4)
+            break;
+        optimizeVertexCache(level.data(), count, vertexCount);
+
+        lods.push_back(MeshLod{static_cast<std::uint32_t>(indices.size()), static_cast<std::uint32_t>(count),
+                               radius > 0.0f ? error / radius : 0.0f});
+        indices.insert(indices.end(), level.begin(), level.begin() + count);
+        previous = count;
+    }
+}
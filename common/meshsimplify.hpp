@@ -0,0 +1,34 @@
+#pragma once
+// meshsimplify.hpp  -- quadric edge-collapse simplification and LOD chains that share one vertex buffer
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One level of detail: a range of a shared index buffer. Fixed-size fields so the record can be stored
+// in a mesh file as it is.
+struct MeshLod
+{
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    float error; // worst surface deviation, as a fraction of the mesh's bounding radius (half the box diagonal)
+};
+
+// Garland and Heckbert's quadric error metric with half-edge collapses: a vertex only ever moves onto
+// one of its neighbours, so the result indexes the same vertices (xyz floats) as the input and can be
+// drawn from the same vertex buffer. Collapses run cheapest first, in passes over independent edges,
+// until the triangle count is at most targetIndexCount / 3 or the next collapse would move the surface
+// by more than targetError (a fraction of the largest bounding box extent). Border vertices only slide
+// along the border, and collapses that would flip a triangle are skipped.
+// Writes the indices to `destination` (room for indexCount) and returns how many were written;
+// *resultError, if given, receives the deviation reached in mesh units.
+std::size_t simplifyMesh(unsigned int *destination, const unsigned int *indices, std::size_t indexCount,
+                         const float *positions, std::size_t vertexCount, std::size_t targetIndexCount,
+                         float targetError, float *resultError = NULL);
+
+// Level 0 is `indices` as it is; each further level aims at half the triangles of the one before and is
+// simplified from the full mesh. Levels are appended to `indices` with their triangles ordered for the
+// vertex cache; a level that cannot get below 80% of the previous one within maxError ends the chain.
+// Fills lods with between 1 and maxLevels entries.
+void buildLodChain(const float *positions, std::size_t vertexCount, std::vector<unsigned int> &indices,
+                   std::vector<MeshLod> &lods, unsigned maxLevels = 5, float maxError = 0.05f);
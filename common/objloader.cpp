@@ -1 +1,756 @@
+#include "objloader.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "mappedfile.hpp"
+
+// Every scanner below works on text that ends in '\n' and stops at the first byte it does not want,
+// so the newline is a sentinel: no inner loop needs a bounds check, and none of them runs past the end
+// of the current line.
+
+namespace
+{
+
+inline bool isBlank(char c)
+{
+    // what operator>> skips inside a line
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isTokenEnd(char c)
+{
+    return isBlank(c) || c == '\n';
+}
+
+inline bool isDigit(char c)
+{
+    return static_cast<unsigned>(c - '0') < 10u;
+}
+
+inline const char *skipBlanks(const char *p)
+{
+    while (isBlank(*p))
+        ++p;
+    return p;
+}
+
+inline const char *nextLine(const char *p, const char *end)
+{
+    return static_cast<const char *>(memchr(p, '\n', static_cast<std::size_t>(end - p))) + 1;
+}
+
+// Exact up to 1e22: every power of ten below 2^53 * 2^22 is a double. The negative powers are not
+// exact, but each is within half an ulp.
+const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+const double kPow10Neg[] = {1e0,   1e-1,  1e-2,  1e-3,  1e-4,  1e-5,  1e-6,  1e-7,  1e-8,  1e-9,  1e-10, 1e-11,
+                            1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18, 1e-19, 1e-20, 1e-21, 1e-22};
+
+// Slow path: hand the token to strtof, which is what operator>>(float&) does underneath
+float parseFloatSlow(const char *begin, const char *end)
+{
+    char buf[64];
+    const std::size_t n = static_cast<std::size_t>(end - begin);
+    if (n < sizeof(buf))
+    {
+        memcpy(buf, begin, n);
+        buf[n] = '\0';
+        return strtof(buf, NULL);
+    }
+    return strtof(std::string(begin, end).c_str(), NULL);
+}
+
+// [+-]digits[.digits][(e|E)[+-]digits], correctly rounded to float like strtof. Up to 19 digits go
+// into an integer mantissa, which is scaled by a power of ten in double arithmetic. That lands within
+// a couple of double ulps of the true value, far closer than float resolution, so the final float
+// conversion is exact unless the value sits right next to a halfway point between two floats; those
+// (and longer mantissas or larger exponents) take the strtof path. Returns the end of the number, or p
+// if there is none (out is then 0).
+const char *parseFloat(const char *p, float &out)
+{
+    const char *start = p;
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+        negative = *p++ == '-';
+
+    std::uint64_t mantissa = 0;
+    const char *digits = p;
+    while (isDigit(*p))
+        mantissa = mantissa * 10 + static_cast<unsigned>(*p++ - '0');
+    int count = static_cast<int>(p - digits);
+    int exponent = 0;
+    if (*p == '.')
+    {
+        const char *fraction = ++p;
+        while (isDigit(*p))
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p++ - '0');
+        exponent = -static_cast<int>(p - fraction);
+        count -= exponent;
+    }
+    if (count == 0)
+    {
+        out = 0.0f;
+        return start;
+    }
+    if (*p == 'e' || *p == 'E')
+    {
+        const char *e = p + 1;
+        bool negativeExp = false;
+        if (*e == '-' || *e == '+')
+            negativeExp = *e++ == '-';
+        if (!isDigit(*e))
+        {
+            // "1e" or "1e+": let strtof decide what it means
+            out = parseFloatSlow(start, e);
+            return e;
+        }
+        int value = 0;
+        for (; isDigit(*e); ++e)
+            if (value < 100000)
+                value = value * 10 + (*e - '0');
+        exponent += negativeExp ? -value : value;
+        p = e;
+    }
+
+    // more than 19 digits may have wrapped the mantissa
+    if (count > 19 || exponent < -22 || exponent > 22)
+    {
+        out = parseFloatSlow(start, p);
+        return p;
+    }
+    if (mantissa == 0)
+    {
+        out = negative ? -0.0f : 0.0f;
+        return p;
+    }
+
+    double value = static_cast<double>(mantissa);
+    value *= exponent < 0 ? kPow10Neg[-exponent] : kPow10[exponent];
+
+    // Float keeps the top 24 of the double's 53 significand bits; the low 29 bits decide the rounding.
+    // 0x10000000 there is an exact halfway point, so stay clear of it by a margin that covers the
+    // error of the roundings above.
+    std::uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const std::uint32_t low = static_cast<std::uint32_t>(bits & 0x1FFFFFFFu);
+    if (low - (0x10000000u - 64u) < 128u || value < 1.17549435e-38 || value > 3.40282346e38)
+    {
+        out = parseFloatSlow(start, p);
+        return p;
+    }
+
+    const float f = static_cast<float>(value);
+    out = negative ? -f : f;
+    return p;
+}
+
+// Read `count` blank-separated floats from the rest of a line; missing values read as 0
+inline const char *parseFloats(const char *p, float *out, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        p = skipBlanks(p);
+        const char *next = parseFloat(p, out[i]);
+        if (next == p)
+        {
+            for (; i < count; ++i)
+                out[i] = 0.0f;
+            return p;
+        }
+        p = next;
+    }
+    return p;
+}
+
+// [+-]digits like sscanf's %d; false (and p unchanged) if there is no number
+inline bool parseInt(const char *&p, int &out)
+{
+    const char *q = p;
+    bool negative = false;
+    if (*q == '-' || *q == '+')
+        negative = *q++ == '-';
+    if (!isDigit(*q))
+        return false;
+    // saturate instead of overflowing; such an index is out of range either way
+    int value = 0;
+    for (; isDigit(*q); ++q)
+        value = value < 100000000 ? value * 10 + (*q - '0') : 2147483647;
+    out = negative ? -value : value;
+    p = q;
+    return true;
+}
+
+// One face corner, "v", "v/t", "v//n" or "v/t/n". Components that are absent come back as 0, which
+// fixIndex turns into -1.
+inline const char *parseCorner(const char *p, int &v, int &t, int &n)
+{
+    v = t = n = 0;
+    if (parseInt(p, v) && *p == '/')
+    {
+        ++p;
+        parseInt(p, t);
+        if (*p == '/')
+        {
+            ++p;
+            parseInt(p, n);
+        }
+    }
+    // rest of the token, whatever it is
+    while (!isTokenEnd(*p))
+        ++p;
+    return p;
+}
+
+enum LineKind
+{
+    Other,
+    Position,
+    TexCoord,
+    Normal,
+    Face,
+    Object,
+    Group,
+    UseMaterial,
+    MaterialLibrary,
+    LineKinds
+};
+
+// Classify a line by its leading keyword; *body is set just past the keyword
+inline LineKind classify(const char *p, const char **body)
+{
+    p = skipBlanks(p);
+    const char *k = p;
+    while (!isTokenEnd(*p))
+        ++p;
+    *body = p;
+    switch (p - k)
+    {
+    case 1:
+        if (k[0] == 'v')
+            return Position;
+        if (k[0] == 'f')
+            return Face;
+        if (k[0] == 'o')
+            return Object;
+        if (k[0] == 'g')
+            return Group;
+        return Other;
+    case 2:
+        if (k[0] != 'v')
+            return Other;
+        if (k[1] == 't')
+            return TexCoord;
+        if (k[1] == 'n')
+            return Normal;
+        return Other;
+    case 6:
+        if (memcmp(k, "usemtl", 6) == 0)
+            return UseMaterial;
+        if (memcmp(k, "mtllib", 6) == 0)
+            return MaterialLibrary;
+        return Other;
+    default:
+        return Other;
+    }
+}
+
+// Corners on a face line, i.e. blank-separated tokens in [p, eol). p is just past the "f" keyword, so
+// every corner starts where a non-blank follows a blank; written branch-free so it vectorises.
+inline int countCorners(const char *p, const char *eol)
+{
+    int corners = 0;
+    for (; p + 1 < eol; ++p)
+        corners += isBlank(p[0]) & !isBlank(p[1]);
+    return corners;
+}
+
+// Rest of the line without surrounding blanks ("g", "o" and "usemtl" names may contain spaces)
+inline std::string lineText(const char *p, const char **next)
+{
+    p = skipBlanks(p);
+    const char *e = p;
+    while (*e != '\n')
+        ++e;
+    *next = e;
+    while (e > p && isBlank(e[-1]))
+        --e;
+    return std::string(p, e);
+}
+
+// "mtllib" takes several blank-separated file names, but exporters also write single names that contain
+// blanks ("mtllib Pingu obj.mtl"). Split only if every piece looks like a material library.
+void splitMaterialLibraries(const std::string &text, std::vector<std::string> &out)
+{
+    std::vector<std::string> names;
+    bool allMtl = true;
+    for (std::size_t i = 0; i < text.size();)
+    {
+        while (i < text.size() && isBlank(text[i]))
+            ++i;
+        std::size_t j = i;
+        while (j < text.size() && !isBlank(text[j]))
+            ++j;
+        if (j > i)
+        {
+            names.push_back(text.substr(i, j - i));
+            const std::string &n = names.back();
+            allMtl = allMtl && n.size() > 4 && n[n.size() - 4] == '.' && tolower(n[n.size() - 3]) == 'm' &&
+                     tolower(n[n.size() - 2]) == 't' && tolower(n[n.size() - 1]) == 'l';
+        }
+        i = j;
+    }
+    if (allMtl)
+        out.insert(out.end(), names.begin(), names.end());
+    else if (!text.empty())
+        out.push_back(text);
+}
+
+struct Idx
+{
+    int v, t, n;
+};
+
+// An o, g or usemtl line, tagged with the triangle it precedes
+struct GroupEvent
+{
+    std::size_t triangle;
+    LineKind kind;
+    std::string name;
+};
+
+// Parse output, sized once from the counts of all chunks. Faces are fan-triangulated as they are read:
+// three corners per triangle, with v = -1 marking a corner that did not name a vertex.
+struct ObjData
+{
+    std::vector<float> temp_v, temp_vt, temp_vn;
+    std::vector<Idx> faces;
+    std::vector<std::string> materialLibraries;
+};
+
+// A run of whole lines, the last one ending in '\n'. Lines are counted per chunk first; the prefix sums
+// of those counts tell each chunk where its output starts, so chunks parse independently and straight
+// into their own slice of ObjData. The cursor is the running element count across the whole file,
+// which is also what relative face indices count back from.
+struct Chunk
+{
+    const char *begin, *end;
+    std::size_t counts[LineKinds]; // counts[Face] is in triangles
+    std::size_t v, vt, vn, f;      // write cursor: floats in temp_v/vt/vn, corners in faces
+    std::vector<GroupEvent> events;
+    std::vector<std::string> materialLibraries;
+};
+
+void countLines(Chunk &c)
+{
+    // local tallies: stores through c would have to be redone after every byte read, since a char
+    // pointer may alias them
+    std::size_t counts[LineKinds] = {};
+    for (const char *line = c.begin; line < c.end;)
+    {
+        const char *body;
+        const LineKind kind = classify(line, &body);
+        const char *next = nextLine(body, c.end);
+        if (kind == Face)
+        {
+            const int corners = countCorners(body, next - 1);
+            if (corners >= 3)
+                counts[Face] += static_cast<std::size_t>(corners - 2);
+        }
+        else
+        {
+            ++counts[kind];
+        }
+        line = next;
+    }
+    std::copy(counts, counts + LineKinds, c.counts);
+}
+
+void parseLines(Chunk &c, ObjData &d)
+{
+    for (const char *line = c.begin; line < c.end;)
+    {
+        const char *p;
+        const LineKind kind = classify(line, &p);
+        switch (kind)
+        {
+        case Position:
+            p = parseFloats(p, &d.temp_v[c.v], 3);
+            c.v += 3;
+            break;
+        case TexCoord:
+            p = parseFloats(p, &d.temp_vt[c.vt], 2);
+            c.vt += 2;
+            break;
+        case Normal:
+            p = parseFloats(p, &d.temp_vn[c.vn], 3);
+            c.vn += 3;
+            break;
+        case Face:
+        {
+            // fan from the first corner: (0, 1, 2), (0, 2, 3), ...; relative indices resolve against
+            // what has been read so far
+            Idx first = {-1, -1, -1}, previous = {-1, -1, -1};
+            int corners = 0;
+            for (p = skipBlanks(p); *p != '\n'; p = skipBlanks(p))
+            {
+                int vi, ti, ni;
+                p = parseCorner(p, vi, ti, ni);
+                const Idx corner = {fixIndex(vi, static_cast<int>(c.v / 3)), fixIndex(ti, static_cast<int>(c.vt / 2)),
+                                    fixIndex(ni, static_cast<int>(c.vn / 3))};
+                if (corners == 0)
+                    first = corner;
+                else if (corners >= 2)
+                {
+                    d.faces[c.f++] = first;
+                    d.faces[c.f++] = previous;
+                    d.faces[c.f++] = corner;
+                }
+                previous = corner;
+                ++corners;
+            }
+            break;
+        }
+        case Object:
+        case Group:
+        case UseMaterial:
+            c.events.push_back(GroupEvent{c.f / 3, kind, lineText(p, &p)});
+            break;
+        case MaterialLibrary:
+            splitMaterialLibraries(lineText(p, &p), c.materialLibraries);
+            break;
+        default:
+            break;
+        }
+        line = nextLine(p, c.end);
+    }
+}
+
+// Calls fn(i) for every i < count, spread over up to `threads` threads (the caller's included)
+template <class F> void parallelFor(std::size_t count, unsigned threads, F &&fn)
+{
+    if (threads > count)
+        threads = static_cast<unsigned>(count);
+    if (threads <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+    std::atomic<std::size_t> next(0);
+    auto work = [&]() {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+            fn(i);
+    };
+    std::vector<std::thread> helpers;
+    helpers.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t)
+        helpers.emplace_back(work);
+    work();
+    for (std::thread &h : helpers)
+        h.join();
+}
+
+// Below this much text per chunk, starting a thread costs more than it saves
+const std::size_t kMinChunkBytes = std::size_t(1) << 20;
+
+// Map, split, count and parse `path` into d; events come back in file order
+bool parseOBJ(const char *path, unsigned threads, ObjData &d, std::vector<GroupEvent> &events)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        std::cerr << "Failed to open OBJ: " << path << "\n";
+        return false;
+    }
+
+    // The mapping ends wherever the file does. Scan it up to and including its last '\n', and parse an
+    // unterminated last line from a copy that has one.
+    const char *const begin = file.data();
+    const char *body = begin + file.size();
+    while (body > begin && body[-1] != '\n')
+        --body;
+    const std::string tail = std::string(body, begin + file.size()) + '\n';
+
+    // Split at line boundaries into one chunk per thread, plus the tail
+    const std::size_t bodySize = static_cast<std::size_t>(body - begin);
+    const std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(threads, bodySize / kMinChunkBytes));
+    std::vector<Chunk> chunks(chunkCount + 1);
+    const char *from = begin;
+    for (std::size_t i = 0; i < chunkCount; ++i)
+    {
+        const char *to = body;
+        if (i + 1 < chunkCount)
+        {
+            to = std::max(from, begin + bodySize / chunkCount * (i + 1));
+            to = to < body ? nextLine(to, body) : body;
+        }
+        chunks[i].begin = from;
+        chunks[i].end = to;
+        from = to;
+    }
+    chunks[chunkCount].begin = tail.data();
+    chunks[chunkCount].end = tail.data() + tail.size();
+
+    // Counting pass: size every array once
+    parallelFor(chunks.size(), threads, [&](std::size_t i) {
+        Chunk &c = chunks[i];
+        std::fill(c.counts, c.counts + LineKinds, std::size_t(0));
+        countLines(c);
+    });
+    std::size_t v = 0, vt = 0, vn = 0, f = 0;
+    for (Chunk &c : chunks)
+    {
+        c.v = v;
+        c.vt = vt;
+        c.vn = vn;
+        c.f = f;
+        v += c.counts[Position] * 3;
+        vt += c.counts[TexCoord] * 2;
+        vn += c.counts[Normal] * 3;
+        f += c.counts[Face] * 3;
+    }
+
+    d.temp_v.resize(v);
+    d.temp_vt.resize(vt);
+    d.temp_vn.resize(vn);
+    d.faces.resize(f);
+    parallelFor(chunks.size(), threads, [&](std::size_t i) { parseLines(chunks[i], d); });
+
+    for (Chunk &c : chunks)
+    {
+        events.insert(events.end(), c.events.begin(), c.events.end());
+        d.materialLibraries.insert(d.materialLibraries.end(), c.materialLibraries.begin(),
+                                   c.materialLibraries.end());
+    }
+    return true;
+}
+
+// Read buffer of parseOBJStream, doubled for any line longer than it
+const std::size_t kStreamBufferBytes = std::size_t(64) << 10;
+
+// Same output as parseOBJ from text that arrives through read(), without ever holding all of it: every
+// run of whole lines in the buffer is counted, appended to d and parsed on the spot, and only a trailing
+// partial line is kept for the next read
+void parseOBJStream(const OBJReadFn &read, ObjData &d, std::vector<GroupEvent> &events)
+{
+    std::vector<char> buffer(kStreamBufferBytes);
+    std::size_t filled = 0;
+    Chunk c = Chunk();
+    for (bool end = false; !end;)
+    {
+        if (filled == buffer.size())
+            buffer.resize(buffer.size() * 2);
+        const std::size_t n = read(buffer.data() + filled, buffer.size() - filled);
+        filled += n;
+        if (n == 0)
+        {
+            end = true;
+            // an unterminated last line still needs its sentinel
+            if (filled > 0 && buffer[filled - 1] != '\n')
+            {
+                if (filled == buffer.size())
+                    buffer.push_back('\n');
+                else
+                    buffer[filled] = '\n';
+                ++filled;
+            }
+        }
+
+        const char *lines = buffer.data() + filled;
+        while (lines > buffer.data() && lines[-1] != '\n')
+            --lines;
+        if (lines == buffer.data())
+            continue;
+        c.begin = buffer.data();
+        c.end = lines;
+        countLines(c);
+        d.temp_v.resize(c.v + c.counts[Position] * 3);
+        d.temp_vt.resize(c.vt + c.counts[TexCoord] * 2);
+        d.temp_vn.resize(c.vn + c.counts[Normal] * 3);
+        d.faces.resize(c.f + c.counts[Face] * 3);
+        parseLines(c, d);
+
+        filled = static_cast<std::size_t>(buffer.data() + filled - lines);
+        memmove(buffer.data(), lines, filled);
+    }
+    events.swap(c.events);
+    d.materialLibraries.swap(c.materialLibraries);
+}
+
+// Index of an attribute if it exists in the file, else -1
+inline int checkIndex(int index, std::size_t floats, int width)
+{
+    return index >= 0 && static_cast<std::size_t>(index) < floats / width ? index : -1;
+}
+
+inline void copyAttribute(float *dst, const std::vector<float> &src, int index, int width)
+{
+    if (index >= 0)
+        memcpy(dst, &src[static_cast<std::size_t>(index) * width], sizeof(float) * width);
+    else
+        memset(dst, 0, sizeof(float) * width);
+}
+
+// One output vertex per distinct (v, vt, vn) corner of the parsed faces, grouped by the o / g / usemtl
+// events
+void buildMesh(ObjData &d, std::vector<GroupEvent> &events, ObjMesh &mesh)
+{
+    mesh.materialLibraries.swap(d.materialLibraries);
+
+    // One output vertex per distinct (v, vt, vn) corner. Corners of the same position are chained
+    // from head[v], so finding a match only compares the few corners that share it.
+    const std::size_t positions = d.temp_v.size() / 3;
+    std::vector<int> head(positions, -1);
+    std::vector<int> next, cornerT, cornerN;
+    const std::size_t triangles = d.faces.size() / 3;
+    mesh.indices.reserve(d.faces.size());
+    mesh.vertices.reserve(d.temp_v.size());
+    mesh.uvs.reserve(positions * 2);
+    mesh.normals.reserve(d.temp_v.size());
+
+    std::string object, group, material;
+    bool changed = true;
+    std::size_t e = 0;
+    for (std::size_t t = 0; t < triangles; ++t)
+    {
+        for (; e < events.size() && events[e].triangle <= t; ++e)
+        {
+            std::string &name = events[e].kind == Object ? object : events[e].kind == Group ? group : material;
+            if (name != events[e].name)
+            {
+                name.swap(events[e].name);
+                changed = true;
+            }
+        }
+
+        const Idx *tri = &d.faces[t * 3];
+        int v[3], vt[3], vn[3];
+        bool valid = true;
+        for (int k = 0; k < 3; ++k)
+        {
+            v[k] = checkIndex(tri[k].v, d.temp_v.size(), 3);
+            vt[k] = checkIndex(tri[k].t, d.temp_vt.size(), 2);
+            vn[k] = checkIndex(tri[k].n, d.temp_vn.size(), 3);
+            valid = valid && v[k] >= 0;
+        }
+        if (!valid)
+            continue; // a corner without a position: nothing to draw
+
+        if (changed)
+        {
+            mesh.groups.push_back(ObjGroup{object, group, material, mesh.indices.size(), 0});
+            changed = false;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            int u = head[v[k]];
+            while (u >= 0 && (cornerT[u] != vt[k] || cornerN[u] != vn[k]))
+                u = next[u];
+            if (u < 0)
+            {
+                u = static_cast<int>(next.size());
+                next.push_back(head[v[k]]);
+                head[v[k]] = u;
+                cornerT.push_back(vt[k]);
+                cornerN.push_back(vn[k]);
+                mesh.vertices.resize(mesh.vertices.size() + 3);
+                mesh.uvs.resize(mesh.uvs.size() + 2);
+                mesh.normals.resize(mesh.normals.size() + 3);
+                copyAttribute(&mesh.vertices[mesh.vertices.size() - 3], d.temp_v, v[k], 3);
+                copyAttribute(&mesh.uvs[mesh.uvs.size() - 2], d.temp_vt, vt[k], 2);
+                copyAttribute(&mesh.normals[mesh.normals.size() - 3], d.temp_vn, vn[k], 3);
+                mesh.hasUVs = mesh.hasUVs || vt[k] >= 0;
+                mesh.hasNormals = mesh.hasNormals || vn[k] >= 0;
+            }
+            mesh.indices.push_back(static_cast<unsigned int>(u));
+        }
+        mesh.groups.back().indexCount += 3;
+    }
+}
+
+} // namespace
+
+bool loadOBJ(const char *path, ObjMesh &mesh, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    mesh = ObjMesh();
+
+    ObjData d;
+    std::vector<GroupEvent> events;
+    if (!parseOBJ(path, threads, d, events))
+        return false;
+    buildMesh(d, events, mesh);
+    return true;
+}
+
+void loadOBJStream(const OBJReadFn &read, ObjMesh &mesh)
+{
+    mesh = ObjMesh();
+
+    ObjData d;
+    std::vector<GroupEvent> events;
+    parseOBJStream(read, d, events);
+    buildMesh(d, events, mesh);
+}
+
+bool loadOBJ(const char *path, std::vector<float> &out_vertices, std::vector<float> &out_uvs,
+             std::vector<float> &out_normals, unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    ObjData d;
+    std::vector<GroupEvent> events;
+    if (!parseOBJ(path, threads, d, events))
+        return false;
+
+    // Triangles with a corner that names no vertex are dropped; everything else is unrolled in as many
+    // slices as there are threads
+    std::vector<std::size_t> keep;
+    keep.reserve(d.faces.size() / 3);
+    for (std::size_t t = 0; t < d.faces.size() / 3; ++t)
+    {
+        const Idx *tri = &d.faces[t * 3];
+        if (checkIndex(tri[0].v, d.temp_v.size(), 3) >= 0 && checkIndex(tri[1].v, d.temp_v.size(), 3) >= 0 &&
+            checkIndex(tri[2].v, d.temp_v.size(), 3) >= 0)
+            keep.push_back(t);
+    }
+
+    const std::size_t corners = keep.size() * 3;
+    const std::size_t vBase = out_vertices.size(), tBase = out_uvs.size(), nBase = out_normals.size();
+    out_vertices.resize(vBase + corners * 3);
+    out_uvs.resize(tBase + corners * 2);
+    out_normals.resize(nBase + corners * 3);
+    const std::size_t slices = std::max<std::size_t>(1, std::min<std::size_t>(threads, corners / 65536));
+    parallelFor(slices, threads, [&](std::size_t slice) {
+        const std::size_t first = keep.size() * slice / slices, last = keep.size() * (slice + 1) / slices;
+        float *ov = out_vertices.data() + vBase + first * 9;
+        float *ot = out_uvs.data() + tBase + first * 6;
+        float *on = out_normals.data() + nBase + first * 9;
+        for (std::size_t k = first; k < last; ++k)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                const Idx &c = d.faces[keep[k] * 3 + i];
+                copyAttribute(ov, d.temp_v, c.v, 3);
+                copyAttribute(ot, d.temp_vt, checkIndex(c.t, d.temp_vt.size(), 2), 2);
+                copyAttribute(on, d.temp_vn, checkIndex(c.n, d.temp_vn.size(), 3), 3);
+                ov += 3;
+                ot += 2;
+                on += 3;
+            }
+        }
+    });
+
+    return true;
+}
@@ -1,8 +1,7 @@
 #pragma once
 
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -19,89 +18,57 @@ static inline int fixIndex(int idx, int count)
     return -1; // shouldn't happen
 }
 
-bool loadOBJ(const char *path, std::vector<float> &out_vertices, std::vector<float> &out_uvs,
-             std::vector<float> &out_normals)
+// A run of triangles that share the same object, group and material: indices
+// [firstIndex, firstIndex + indexCount) of ObjMesh::indices. Names are the last "o", "g" and "usemtl"
+// seen before the run, empty if there was none.
+struct ObjGroup
 {
-    std::ifstream file(path);
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open OBJ: " << path << "\n";
-        return false;
-    }
-
-    // temporary storage
-    std::vector<float> temp_v;
-    std::vector<float> temp_vt;
-    std::vector<float> temp_vn;
-
-    struct Idx
-    {
-        int v, t, n;
-    };
-    std::vector<Idx> faces;
-
-    std::string line;
-    while (std::getline(file, line))
-    {
-        std::stringstream ss(line);
-        std::string type;
-        ss >> type;
-
-        if (type == "v")
-        {
-            float x, y, z;
-            ss >> x >> y >> z;
-            temp_v.insert(temp_v.end(), {x, y, z});
-        }
-        else if (type == "vt")
-        {
-            float u, v;
-            ss >> u >> v;
-            temp_vt.insert(temp_vt.end(), {u, v});
-        }
-        else if (type == "vn")
-        {
-            float x, y, z;
-            ss >> x >> y >> z;
-            temp_vn.insert(temp_vn.end(), {x, y, z});
-        }
-        else if (type == "f")
-        {
-            for (int i = 0; i < 3; i++)
-            {
-                std::string tok;
-                ss >> tok;
-
-                int vi, ti, ni;
-                sscanf(tok.c_str(), "%d/%d/%d", &vi, &ti, &ni);
-
-                Idx idx;
-                idx.v = fixIndex(vi, temp_v.size() / 3);
-                idx.t = fixIndex(ti, temp_vt.size() / 2);
-                idx.n = fixIndex(ni, temp_vn.size() / 3);
-
-                faces.push_back(idx);
-            }
-        }
-    }
-
-    // Build final unrolled arrays
-    for (auto &f : faces)
-    {
-        // vertices
-        out_vertices.push_back(temp_v[f.v * 3 + 0]);
-        out_vertices.push_back(temp_v[f.v * 3 + 1]);
-        out_vertices.push_back(temp_v[f.v * 3 + 2]);
-
-        // UVs
-        out_uvs.push_back(temp_vt[f.t * 2 + 0]);
-        out_uvs.push_back(temp_vt[f.t * 2 + 1]);
-
-        // normals
-        out_normals.push_back(temp_vn[f.n * 3 + 0]);
-        out_normals.push_back(temp_vn[f.n * 3 + 1]);
-        out_normals.push_back(temp_vn[f.n * 3 + 2]);
-    }
-
-    return true;
-}
+    std::string object;
+    std::string group;
+    std::string material;
+    std::size_t firstIndex;
+    std::size_t indexCount;
+};
+
+// Indexed triangle mesh: one vertex per distinct v/vt/vn combination the faces use, three floats per
+// vertex in vertices and normals and two in uvs. Attributes a corner does not reference are zero;
+// hasUVs / hasNormals say whether any corner referenced one.
+struct ObjMesh
+{
+    std::vector<float> vertices;
+    std::vector<float> uvs;
+    std::vector<float> normals;
+    std::vector<unsigned int> indices; // three per triangle
+    std::vector<ObjGroup> groups;      // in file order, covering all of indices
+    std::vector<std::string> materialLibraries; // "mtllib" file names as written, relative to the OBJ
+    bool hasUVs = false;
+    bool hasNormals = false;
+};
+
+// Faces may have any number of corners and use any of the v, v/t, v//n and v/t/n forms. Polygons are
+// fan-triangulated from their first corner. Triangles with a corner whose position index is missing or
+// out of range are dropped; texture coordinate and normal indices that are out of range count as absent.
+//
+// The file is memory-mapped and scanned in place with hand-written number parsing: no streams, no
+// locale, no allocation per line. A first pass counts the v/vt/vn lines and face corners so every array
+// is sized once.
+//
+// Files of a few MB and up are split at line boundaries and parsed by up to `threads` threads (0: one
+// per hardware thread, 1: parse on the calling thread only). The output does not depend on the thread
+// count; relative indices resolve across chunk boundaries exactly as in a serial parse.
+bool loadOBJ(const char *path, ObjMesh &mesh, unsigned threads = 0);
+
+// Source of OBJ text for loadOBJStream: fills up to `size` bytes of `buffer` and returns how many
+// it wrote, 0 at the end of the text
+typedef std::function<std::size_t(char *buffer, std::size_t size)> OBJReadFn;
+
+// Same parse over text that arrives a piece at a time (an inflating archive entry, a socket), on the
+// calling thread. Each run of whole lines is parsed as soon as it is read and then dropped, so the text
+// is never held whole; only the parsed attributes and faces are. A source that fails should stop
+// returning data and report the failure itself.
+void loadOBJStream(const OBJReadFn &read, ObjMesh &mesh);
+
+// Same parse, unrolled into a triangle list: three floats per corner in out_vertices and out_normals, two
+// in out_uvs, appended to whatever the vectors already hold.
+bool loadOBJ(const char *path, std::vector<float> &out_vertices, std::vector<float> &out_uvs,
+             std::vector<float> &out_normals, unsigned threads = 0);
@@ -1,4 +1,3 @@
-#include <vector>
 #include <cstring>
 
 #include <GL/glew.h>
@@ -13,19 +12,45 @@ using namespace glm;
 #include "text2D.hpp"
 
 unsigned int Text2DTextureID;
-unsigned int Text2DVertexBufferID;
-unsigned int Text2DUVBufferID;
+unsigned int Text2DVertexArrayID;
+unsigned int Text2DBufferID;
 unsigned int Text2DShaderID;
 unsigned int Text2DUniformID;
 
+// One streaming vertex buffer for every call: 6 vertices of position + UV per character. Each call writes
+// into the part no earlier call of this buffer generation used, unsynchronized, and the buffer is orphaned
+// once full, so printing neither allocates nor waits for the GPU to finish with earlier text.
+const unsigned int Text2DBufferCharacters = 4096;
+const unsigned int Text2DVerticesPerCharacter = 6;
+unsigned int Text2DBufferUsed; // vertices written since the last orphaning
+
+struct Text2DVertex {
+	glm::vec2 position;
+	glm::vec2 uv;
+};
+
 void initText2D(const char * texturePath){
 
 	// Initialize texture
 	Text2DTextureID = loadDDS(texturePath);
 
-	// Initialize VBO
-	glGenBuffers(1, &Text2DVertexBufferID);
-	glGenBuffers(1, &Text2DUVBufferID);
+	// Initialize VBO, and the VAO describing its interleaved layout
+	glGenVertexArrays(1, &Text2DVertexArrayID);
+	glBindVertexArray(Text2DVertexArrayID);
+	glGenBuffers(1, &Text2DBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DBufferID);
+	glBufferData(GL_ARRAY_BUFFER, Text2DBufferCharacters * Text2DVerticesPerCharacter * sizeof(Text2DVertex), NULL, GL_STREAM_DRAW);
+	Text2DBufferUsed = 0;
+
+	// 1rst attribute buffer : vertices
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)0 );
+
+	// 2nd attribute buffer : UVs
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)sizeof(glm::vec2) );
+
+	glBindVertexArray(0);
 
 	// Initialize Shader
 	Text2DShaderID = LoadShaders( "TextVertexShader.vertexshader", "TextVertexShader.fragmentshader" );
@@ -38,26 +63,33 @@ void initText2D(const char * texturePath){
 void printText2D(const char * text, int x, int y, int size){
 
 	unsigned int length = strlen(text);
+	if ( length > Text2DBufferCharacters )
+		length = Text2DBufferCharacters;
+	if ( length == 0 )
+		return;
+	const unsigned int count = length * Text2DVerticesPerCharacter;
+
+	// Orphan the buffer when this text does not fit behind what was already drawn from it
+	glBindBuffer(GL_ARRAY_BUFFER, Text2DBufferID);
+	if ( Text2DBufferUsed + count > Text2DBufferCharacters * Text2DVerticesPerCharacter ){
+		glBufferData(GL_ARRAY_BUFFER, Text2DBufferCharacters * Text2DVerticesPerCharacter * sizeof(Text2DVertex), NULL, GL_STREAM_DRAW);
+		Text2DBufferUsed = 0;
+	}
+	const unsigned int first = Text2DBufferUsed;
+	Text2DVertex * vertices = (Text2DVertex *)glMapBufferRange(GL_ARRAY_BUFFER, first * sizeof(Text2DVertex), count * sizeof(Text2DVertex),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if ( vertices == NULL )
+		return;
 
 	// Fill buffers
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> UVs;
 	for ( unsigned int i=0 ; i<length ; i++ ){
-		
+
 		glm::vec2 vertex_up_left    = glm::vec2( x+i*size     , y+size );
 		glm::vec2 vertex_up_right   = glm::vec2( x+i*size+size, y+size );
 		glm::vec2 vertex_down_right = glm::vec2( x+i*size+size, y      );
 		glm::vec2 vertex_down_left  = glm::vec2( x+i*size     , y      );
 
-		vertices.push_back(vertex_up_left   );
-		vertices.push_back(vertex_down_left );
-		vertices.push_back(vertex_up_right  );
-
-		vertices.push_back(vertex_down_right);
-		vertices.push_back(vertex_up_right);
-		vertices.push_back(vertex_down_left);
-
-		char character = text[i];
+		unsigned char character = text[i];
 		float uv_x = (character%16)/16.0f;
 		float uv_y = (character/16)/16.0f;
 
@@ -65,18 +97,18 @@ void printText2D(const char * text, int x, int y, int size){
 		glm::vec2 uv_up_right   = glm::vec2( uv_x+1.0f/16.0f, uv_y );
 		glm::vec2 uv_down_right = glm::vec2( uv_x+1.0f/16.0f, (uv_y + 1.0f/16.0f) );
 		glm::vec2 uv_down_left  = glm::vec2( uv_x           , (uv_y + 1.0f/16.0f) );
-		UVs.push_back(uv_up_left   );
-		UVs.push_back(uv_down_left );
-		UVs.push_back(uv_up_right  );
 
-		UVs.push_back(uv_down_right);
-		UVs.push_back(uv_up_right);
-		UVs.push_back(uv_down_left);
+		Text2DVertex * quad = vertices + i * Text2DVerticesPerCharacter;
+		quad[0].position = vertex_up_left   ; quad[0].uv = uv_up_left   ;
+		quad[1].position = vertex_down_left ; quad[1].uv = uv_down_left ;
+		quad[2].position = vertex_up_right  ; quad[2].uv = uv_up_right  ;
+
+		quad[3].position = vertex_down_right; quad[3].uv = uv_down_right;
+		quad[4].position = vertex_up_right  ; quad[4].uv = uv_up_right  ;
+		quad[5].position = vertex_down_left ; quad[5].uv = uv_down_left ;
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	Text2DBufferUsed += count;
 
 	// Bind shader
 	glUseProgram(Text2DShaderID);
@@ -87,34 +119,25 @@ void printText2D(const char * text, int x, int y, int size){
 	// Set our "myTextureSampler" sampler to use Texture Unit 0
 	glUniform1i(Text2DUniformID, 0);
 
-	// 1rst attribute buffer : vertices
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-
-	// 2nd attribute buffer : UVs
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
+	glBindVertexArray(Text2DVertexArrayID);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Draw call
-	glDrawArrays(GL_TRIANGLES, 0, vertices.size() );
+	glDrawArrays(GL_TRIANGLES, first, count );
 
 	glDisable(GL_BLEND);
 
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
+	glBindVertexArray(0);
 
 }
 
 void cleanupText2D(){
 
 	// Delete buffers
-	glDeleteBuffers(1, &Text2DVertexBufferID);
-	glDeleteBuffers(1, &Text2DUVBufferID);
+	glDeleteBuffers(1, &Text2DBufferID);
+	glDeleteVertexArrays(1, &Text2DVertexArrayID);
 
 	// Delete texture
 	glDeleteTextures(1, &Text2DTextureID);
@@ -1,11 +1,16 @@
+#include <algorithm>
+#include <cstdint>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #include <GL/glew.h>
 
 #include <GLFW/glfw3.h>
 
+#include "mappedfile.hpp"
+
 GLuint loadBMP_custom(const char *imagepath)
 {
 
@@ -136,52 +141,164 @@ GLuint loadBMP_custom(const char *imagepath)
 #define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
 #define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
 #define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
+#define FOURCC_DX10 0x30315844 // "DX10": a second header follows, with a DXGI format
 
-GLuint loadDDS(const char *imagepath)
+namespace
 {
 
-    unsigned char header[124];
+// Largest edge accepted: beyond every GL's GL_MAX_TEXTURE_SIZE, and small enough that no size below
+// overflows
+const std::uint32_t kMaxTextureSize = 16384;
 
-    FILE *fp;
+struct ImageLevel
+{
+    const char *data; // into the mapping
+    std::size_t size;
+    GLsizei width, height;
+};
+
+// Both containers store little-endian fields at arbitrary offsets
+std::uint32_t read32(const char *p)
+{
+    std::uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+std::uint32_t fullChainLength(std::uint32_t width, std::uint32_t height)
+{
+    std::uint32_t levels = 1;
+    for (std::uint32_t edge = width > height ? width : height; edge > 1; edge /= 2)
+        ++levels;
+    return levels;
+}
 
-    /* try to open the file */
-    fp = fopen(imagepath, "rb");
-    if (fp == NULL)
+// Bytes of one level, 0 for a format this loader does not know
+std::size_t levelSize(GLenum internalFormat, std::uint32_t width, std::uint32_t height)
+{
+    const std::size_t blocks = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4);
+    switch (internalFormat)
     {
-        printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
-        getchar();
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        return blocks * 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return blocks * 16;
+    case GL_RGBA8:
+        return static_cast<std::size_t>(width) * height * 4;
+    case GL_RGB8:
+        // rows padded to GL_UNPACK_ALIGNMENT's default of 4, as KTX stores them
+        return static_cast<std::size_t>((width * 3 + 3) & ~3u) * height;
+    default:
         return 0;
     }
+}
 
-    /* verify the type of file */
-    char filecode[4];
-    fread(filecode, 1, 4, fp);
-    if (strncmp(filecode, "DDS ", 4) != 0)
+// One texture with all of `levels`, each uploaded straight from where it lies. Storage is allocated
+// once with glTexStorage2D where the GL has it (4.2 or ARB_texture_storage), level by level otherwise;
+// GL_TEXTURE_MAX_LEVEL is set either way, so a file with a short mip chain still gives a complete texture.
+// `format` and `type` are 0 for compressed data.
+GLuint createTexture(const char *path, GLenum internalFormat, GLenum format, GLenum type,
+                     const std::vector<ImageLevel> &levels)
+{
+    const bool compressed = format == 0;
+    if (compressed && !GLEW_EXT_texture_compression_s3tc)
     {
-        fclose(fp);
+        fprintf(stderr, "%s: this GL cannot sample S3TC (DXT) textures\n", path);
         return 0;
     }
 
-    /* get the surface desc */
-    fread(&header, 124, 1, fp);
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    const GLsizei count = static_cast<GLsizei>(levels.size());
+    const bool immutable = GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+    if (immutable)
+        glTexStorage2D(GL_TEXTURE_2D, count, internalFormat, levels[0].width, levels[0].height);
+    for (GLsizei level = 0; level < count; ++level)
+    {
+        const ImageLevel &l = levels[level];
+        if (compressed && immutable)
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, l.width, l.height, internalFormat,
+                                      static_cast<GLsizei>(l.size), l.data);
+        else if (compressed)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, l.width, l.height, 0,
+                                   static_cast<GLsizei>(l.size), l.data);
+        else if (immutable)
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, l.width, l.height, format, type, l.data);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, l.width, l.height, 0, format, type, l.data);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, count - 1);
+    return textureID;
+}
+
+// `count` levels from `data` on, the first `width` x `height` and each next one half the size. With
+// sizePrefix (KTX) every level is preceded by its imageSize, which must match, and padded to four bytes.
+// Fails, with a message, as soon as a level does not fit in [data, end).
+bool collectLevels(const char *path, GLenum internalFormat, std::uint32_t width, std::uint32_t height,
+                   std::uint32_t count, const char *data, const char *end, bool sizePrefix,
+                   std::vector<ImageLevel> &levels)
+{
+    for (std::uint32_t level = 0; level < count; ++level)
+    {
+        const std::size_t size = levelSize(internalFormat, width, height);
+        if (sizePrefix)
+        {
+            // imageSize, then the level padded to four bytes
+            if (end - data < 4 || read32(data) != size)
+            {
+                fprintf(stderr, "%s: level %u is not the %zu bytes its size calls for\n", path, level, size);
+                return false;
+            }
+            data += 4;
+        }
+        if (static_cast<std::size_t>(end - data) < size)
+        {
+            fprintf(stderr, "%s: truncated at level %u (%zu bytes short)\n", path, level,
+                    size - static_cast<std::size_t>(end - data));
+            return false;
+        }
+        levels.push_back(ImageLevel{data, size, static_cast<GLsizei>(width), static_cast<GLsizei>(height)});
+        data += size;
+        if (sizePrefix)
+            data += std::min<std::size_t>(static_cast<std::size_t>(end - data), (4 - size % 4) % 4);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return true;
+}
+
+} // namespace
+
+GLuint loadDDS(const char *imagepath)
+{
+    // Mapped rather than read: every level goes to the GL straight from the page cache
+    MappedFile file;
+    if (!file.open(imagepath))
+    {
+        fprintf(stderr, "%s could not be opened. Are you in the right directory ?\n", imagepath);
+        return 0;
+    }
 
-    unsigned int height = *(unsigned int *)&(header[8]);
-    unsigned int width = *(unsigned int *)&(header[12]);
-    unsigned int linearSize = *(unsigned int *)&(header[16]);
-    unsigned int mipMapCount = *(unsigned int *)&(header[24]);
-    unsigned int fourCC = *(unsigned int *)&(header[80]);
+    /* verify the type of file, and that the whole surface desc is there */
+    const char *const bytes = file.data();
+    const char *const end = bytes + file.size();
+    if (file.size() < 4 + 124 || strncmp(bytes, "DDS ", 4) != 0 || read32(bytes + 4) != 124)
+    {
+        fprintf(stderr, "%s is not a DDS file\n", imagepath);
+        return 0;
+    }
+    const char *header = bytes + 4;
 
-    unsigned char *buffer;
-    unsigned int bufsize;
-    /* how big is it going to be including all mipmaps? */
-    bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize;
-    buffer = (unsigned char *)malloc(bufsize * sizeof(unsigned char));
-    fread(buffer, 1, bufsize, fp);
-    /* close the file pointer */
-    fclose(fp);
+    const std::uint32_t flags = read32(header + 4);
+    const std::uint32_t height = read32(header + 8);
+    const std::uint32_t width = read32(header + 12);
+    const std::uint32_t mipMapCount = read32(header + 24);
+    const std::uint32_t fourCC = read32(header + 80);
 
-    unsigned int components = (fourCC == FOURCC_DXT1) ? 3 : 4;
-    unsigned int format;
+    GLenum format;
     switch (fourCC)
     {
     case FOURCC_DXT1:
@@ -194,39 +311,86 @@ GLuint loadDDS(const char *imagepath)
         format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
         break;
     default:
-        free(buffer);
+        fprintf(stderr, "%s: only DXT1, DXT3 and DXT5 DDS files are supported%s\n", imagepath,
+                fourCC == FOURCC_DX10 ? " (not DX10 headers)" : "");
+        return 0;
+    }
+    if (width == 0 || height == 0 || width > kMaxTextureSize || height > kMaxTextureSize)
+    {
+        fprintf(stderr, "%s: bad size %u x %u\n", imagepath, width, height);
         return 0;
     }
 
-    // Create one OpenGL texture
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-
-    // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // DDSD_MIPMAPCOUNT (0x20000) says whether the count means anything; it cannot exceed the full chain
+    std::uint32_t levelCount = (flags & 0x20000) && mipMapCount > 0 ? mipMapCount : 1;
+    levelCount = std::min(levelCount, fullChainLength(width, height));
 
-    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
-    unsigned int offset = 0;
+    std::vector<ImageLevel> levels;
+    if (!collectLevels(imagepath, format, width, height, levelCount, header + 124, end, false, levels))
+        return 0;
+    return createTexture(imagepath, format, 0, 0, levels);
+}
 
-    /* load the mipmaps */
-    for (unsigned int level = 0; level < mipMapCount && (width || height); ++level)
+GLuint loadKTX(const char *imagepath)
+{
+    MappedFile file;
+    if (!file.open(imagepath))
     {
-        unsigned int size = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
-        glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, size, buffer + offset);
-
-        offset += size;
-        width /= 2;
-        height /= 2;
+        fprintf(stderr, "%s could not be opened. Are you in the right directory ?\n", imagepath);
+        return 0;
+    }
 
-        // Deal with Non-Power-Of-Two textures. This code is not included in the webpage to reduce clutter.
-        if (width < 1)
-            width = 1;
-        if (height < 1)
-            height = 1;
+    static const char identifier[12] = {'\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n'};
+    const std::size_t headerSize = sizeof(identifier) + 13 * 4;
+    const char *const bytes = file.data();
+    const char *const end = bytes + file.size();
+    if (file.size() < headerSize || memcmp(bytes, identifier, sizeof(identifier)) != 0)
+    {
+        fprintf(stderr, "%s is not a KTX 1.1 file\n", imagepath);
+        return 0;
     }
 
-    free(buffer);
+    // thirteen uint32: endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat,
+    // pixelWidth, pixelHeight, pixelDepth, numberOfArrayElements, numberOfFaces, numberOfMipmapLevels,
+    // bytesOfKeyValueData
+    std::uint32_t h[13];
+    for (int i = 0; i < 13; ++i)
+        h[i] = read32(bytes + sizeof(identifier) + i * 4);
+    if (h[0] != 0x04030201)
+    {
+        fprintf(stderr, "%s: big-endian KTX files are not supported\n", imagepath);
+        return 0;
+    }
+    const GLenum type = h[1], format = h[3], internalFormat = h[4];
+    const std::uint32_t width = h[6], height = h[7];
+    const bool compressed = type == 0 && format == 0;
+    const bool known = compressed ? levelSize(internalFormat, 4, 4) != 0
+                                  : type == GL_UNSIGNED_BYTE && ((format == GL_RGBA && internalFormat == GL_RGBA8) ||
+                                                                 (format == GL_RGB && internalFormat == GL_RGB8));
+    if (!known)
+    {
+        fprintf(stderr, "%s: unsupported format 0x%x (only DXT1/3/5, RGBA8 and RGB8)\n", imagepath, internalFormat);
+        return 0;
+    }
+    if (width == 0 || height == 0 || width > kMaxTextureSize || height > kMaxTextureSize || h[8] != 0 ||
+        h[9] != 0 || h[10] != 1)
+    {
+        fprintf(stderr, "%s: only single 2D textures are supported (%u x %u x %u, %u layers, %u faces)\n",
+                imagepath, width, height, h[8], h[9], h[10]);
+        return 0;
+    }
+    if (h[12] > file.size() - headerSize)
+    {
+        fprintf(stderr, "%s: key/value data runs past the end\n", imagepath);
+        return 0;
+    }
 
-    return textureID;
+    // 0 levels asks the loader to generate them; there is nothing to generate from for compressed data,
+    // so that is just the one
+    const std::uint32_t levelCount = std::min(std::max(h[11], 1u), fullChainLength(width, height));
+    std::vector<ImageLevel> levels;
+    if (!collectLevels(imagepath, internalFormat, width, height, levelCount, bytes + headerSize + h[12], end, true,
+                       levels))
+        return 0;
+    return createTexture(imagepath, internalFormat, compressed ? 0 : format, compressed ? 0 : type, levels);
 }
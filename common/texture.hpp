@@ -9,8 +9,15 @@ GLuint loadBMP_custom(const char * imagepath);
 //// Load a .TGA file using GLFW's own loader
 //GLuint loadTGA_glfw(const char * imagepath);
 
-// Load a .DDS file using GLFW's own loader
+// Load a DXT1, DXT3 or DXT5 .DDS file. The file is memory-mapped and every header field, level count
+// and level size checked against its real length; the texture's storage is allocated once and each mip
+// level uploaded straight from the mapping, with no copy on the heap. Rows stay in the file's top-down
+// order. No pixel unpack buffer may be bound. Returns 0, with a message on stderr, if anything is off.
 GLuint loadDDS(const char * imagepath);
 
+// Same for a KTX 1.1 file holding one 2D texture: DXT1, DXT3 or DXT5, or uncompressed GL_RGBA8 / GL_RGB8
+// with GL_UNSIGNED_BYTE components.
+GLuint loadKTX(const char * imagepath);
+
 
 #endif
\ No newline at end of file
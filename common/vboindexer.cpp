@@ -175,3 +175,179 @@ void indexVBO_TBN(
 		}
 	}
 }
+
+
+
+// Open-addressing hash indexer
+//
+// Same exact (bitwise) matching as indexVBO, but through a linear-probing table of output indices
+// instead of a std::map: one hash and usually one compare per vertex, and no allocation per vertex.
+// The table stores index+1 so that 0 can mean "empty", and is sized to a power of two at least twice
+// the number of input vertices, so it never fills up.
+
+struct VertexHashTable{
+	std::vector<unsigned int> slots;
+	unsigned int mask;
+
+	VertexHashTable(size_t count){
+		size_t size = 16;
+		while ( size < 2*count )
+			size <<= 1;
+		slots.assign(size, 0);
+		mask = (unsigned int)(size - 1);
+	}
+};
+
+// Hash of the raw bits of position, uv and normal (8 floats)
+static inline unsigned int hashVertex(const glm::vec3 & position, const glm::vec2 & uv, const glm::vec3 & normal){
+	unsigned int words[8];
+	memcpy(&words[0], &position, sizeof(glm::vec3));
+	memcpy(&words[3], &uv,       sizeof(glm::vec2));
+	memcpy(&words[5], &normal,   sizeof(glm::vec3));
+	unsigned int h = 2166136261u;
+	for ( int i=0; i<8; i++ ){
+		h = (h ^ words[i]) * 0x9E3779B1u;
+		h ^= h >> 15;
+	}
+	return h;
+}
+
+// Finds the vertex in out_XXXX, or appends it. Returns its index and whether it was new.
+static inline unsigned int findOrAddVertex(
+	VertexHashTable & table,
+	const glm::vec3 & in_vertex,
+	const glm::vec2 & in_uv,
+	const glm::vec3 & in_normal,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	bool & added
+){
+	for ( unsigned int slot = hashVertex(in_vertex, in_uv, in_normal) & table.mask; ; slot = (slot + 1) & table.mask ){
+		unsigned int entry = table.slots[slot];
+		if ( entry == 0 ){
+			unsigned int index = (unsigned int)out_vertices.size();
+			out_vertices.push_back( in_vertex );
+			out_uvs     .push_back( in_uv );
+			out_normals .push_back( in_normal );
+			table.slots[slot] = index + 1;
+			added = true;
+			return index;
+		}
+		unsigned int index = entry - 1;
+		if ( memcmp(&out_vertices[index], &in_vertex, sizeof(glm::vec3)) == 0 &&
+		     memcmp(&out_uvs     [index], &in_uv,     sizeof(glm::vec2)) == 0 &&
+		     memcmp(&out_normals [index], &in_normal, sizeof(glm::vec3)) == 0 ){
+			added = false;
+			return index;
+		}
+	}
+}
+
+template <class Index>
+static bool indexVBO_hash_impl(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> * in_tangents,
+	std::vector<glm::vec3> * in_bitangents,
+
+	std::vector<Index> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> * out_tangents,
+	std::vector<glm::vec3> * out_bitangents
+){
+	// Vertices already in out_XXXX are not in the table, so they are never matched: like the other
+	// indexers, this only appends.
+	const size_t maxIndex = (size_t)(Index)~(Index)0;
+
+	VertexHashTable table(in_vertices.size());
+	out_indices.reserve(out_indices.size() + in_vertices.size());
+
+	for ( size_t i=0; i<in_vertices.size(); i++ ){
+		bool added;
+		unsigned int index = findOrAddVertex(table, in_vertices[i], in_uvs[i], in_normals[i], out_vertices, out_uvs, out_normals, added);
+		if ( index > maxIndex ){
+			// Does not fit the index type: undo the vertex we just added and give up
+			out_vertices.pop_back();
+			out_uvs     .pop_back();
+			out_normals .pop_back();
+			return false;
+		}
+		out_indices.push_back( (Index)index );
+
+		if ( in_tangents ){
+			if ( added ){
+				out_tangents  ->push_back( (*in_tangents)[i] );
+				out_bitangents->push_back( (*in_bitangents)[i] );
+			}else{
+				// Average the tangents and the bitangents
+				(*out_tangents)  [index] += (*in_tangents)[i];
+				(*out_bitangents)[index] += (*in_bitangents)[i];
+			}
+		}
+	}
+	return true;
+}
+
+bool indexVBO_hash(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	return indexVBO_hash_impl(in_vertices, in_uvs, in_normals, NULL, NULL, out_indices, out_vertices, out_uvs, out_normals, NULL, NULL);
+}
+
+bool indexVBO_hash(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals
+){
+	return indexVBO_hash_impl(in_vertices, in_uvs, in_normals, NULL, NULL, out_indices, out_vertices, out_uvs, out_normals, NULL, NULL);
+}
+
+bool indexVBO_TBN_hash(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> & in_tangents,
+	std::vector<glm::vec3> & in_bitangents,
+
+	std::vector<unsigned short> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents
+){
+	return indexVBO_hash_impl(in_vertices, in_uvs, in_normals, &in_tangents, &in_bitangents, out_indices, out_vertices, out_uvs, out_normals, &out_tangents, &out_bitangents);
+}
+
+bool indexVBO_TBN_hash(
+	std::vector<glm::vec3> & in_vertices,
+	std::vector<glm::vec2> & in_uvs,
+	std::vector<glm::vec3> & in_normals,
+	std::vector<glm::vec3> & in_tangents,
+	std::vector<glm::vec3> & in_bitangents,
+
+	std::vector<unsigned int> & out_indices,
+	std::vector<glm::vec3> & out_vertices,
+	std::vector<glm::vec2> & out_uvs,
+	std::vector<glm::vec3> & out_normals,
+	std::vector<glm::vec3> & out_tangents,
+	std::vector<glm::vec3> & out_bitangents
+){
+	return indexVBO_hash_impl(in_vertices, in_uvs, in_normals, &in_tangents, &in_bitangents, out_indices, out_vertices, out_uvs, out_normals, &out_tangents, &out_bitangents);
+}
@@ -0,0 +1,277 @@
+// ziparchive.cpp  -- zip archives read in place: entries listed from the central directory and inflated as
+// a stream
+
+#include "ziparchive.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <stdio.h>
+
+namespace
+{
+
+const std::uint32_t kEndOfDirectory = 0x06054b50;
+const std::uint32_t kDirectoryEntry = 0x02014b50;
+const std::uint32_t kLocalHeader = 0x04034b50;
+const std::size_t kEndOfDirectorySize = 22;
+const std::size_t kDirectoryEntrySize = 46;
+const std::size_t kLocalHeaderSize = 30;
+
+const std::uint16_t kStored = 0;
+const std::uint16_t kDeflated = 8;
+const std::uint16_t kEncrypted = 1 << 0;
+
+// all zip fields are little-endian and unaligned
+std::uint16_t read16(const char *p)
+{
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+    return static_cast<std::uint16_t>(b[0] | b[1] << 8);
+}
+
+std::uint32_t read32(const char *p)
+{
+    const unsigned char *b = reinterpret_cast<const unsigned char *>(p);
+    return static_cast<std::uint32_t>(b[0]) | static_cast<std::uint32_t>(b[1]) << 8 |
+           static_cast<std::uint32_t>(b[2]) << 16 | static_cast<std::uint32_t>(b[3]) << 24;
+}
+
+bool sameText(const std::string &a, const char *b)
+{
+    const std::size_t n = strlen(b);
+    if (a.size() != n)
+        return false;
+    for (std::size_t i = 0; i < n; ++i)
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i])))
+            return false;
+    return true;
+}
+
+} // namespace
+
+bool ZipArchive::open(const char *path)
+{
+    close();
+    if (!file.open(path))
+    {
+        fprintf(stderr, "ZipArchive: cannot open %s\n", path);
+        return false;
+    }
+    const char *const bytes = file.data();
+    const std::size_t size = file.size();
+
+    // The end-of-directory record is the last thing in the file, followed only by a comment of up to 64 KB
+    std::size_t end = size;
+    const std::size_t stop = size > kEndOfDirectorySize + 0xFFFF ? size - kEndOfDirectorySize - 0xFFFF : 0;
+    for (std::size_t at = size >= kEndOfDirectorySize ? size - kEndOfDirectorySize + 1 : 0; at-- > stop;)
+    {
+        if (read32(bytes + at) == kEndOfDirectory && at + kEndOfDirectorySize + read16(bytes + at + 20) <= size)
+        {
+            end = at;
+            break;
+        }
+    }
+    if (end == size)
+    {
+        fprintf(stderr, "ZipArchive: %s is not a zip archive\n", path);
+        close();
+        return false;
+    }
+
+    const std::size_t count = read16(bytes + end + 10);
+    const std::uint32_t directorySize = read32(bytes + end + 12);
+    const std::uint32_t directoryOffset = read32(bytes + end + 16);
+    if (read16(bytes + end + 4) != 0 || read16(bytes + end + 6) != 0 || read16(bytes + end + 8) != count ||
+        directoryOffset == 0xFFFFFFFF || directoryOffset > end || directorySize > end - directoryOffset)
+    {
+        fprintf(stderr, "ZipArchive: %s: unsupported (multi-disk or zip64) or damaged directory\n", path);
+        close();
+        return false;
+    }
+
+    list.reserve(count);
+    const char *p = bytes + directoryOffset;
+    const char *const directoryEnd = p + directorySize;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (static_cast<std::size_t>(directoryEnd - p) < kDirectoryEntrySize || read32(p) != kDirectoryEntry)
+        {
+            fprintf(stderr, "ZipArchive: %s: damaged directory entry %zu\n", path, i);
+            close();
+            return false;
+        }
+        const std::size_t nameLength = read16(p + 28);
+        const std::size_t entryLength = kDirectoryEntrySize + nameLength + read16(p + 30) + read16(p + 32);
+        if (static_cast<std::size_t>(directoryEnd - p) < entryLength)
+        {
+            fprintf(stderr, "ZipArchive: %s: damaged directory entry %zu\n", path, i);
+            close();
+            return false;
+        }
+
+        ZipEntry e;
+        e.name.assign(p + kDirectoryEntrySize, nameLength);
+        e.method = read16(p + 10);
+        e.crc = read32(p + 16);
+        e.compressedSize = read32(p + 20);
+        e.size = read32(p + 24);
+        const std::uint32_t local = read32(p + 42);
+        if ((read16(p + 8) & kEncrypted) || (e.method != kStored && e.method != kDeflated) ||
+            e.compressedSize == 0xFFFFFFFF || e.size == 0xFFFFFFFF || local == 0xFFFFFFFF)
+        {
+            fprintf(stderr, "ZipArchive: %s: %s is encrypted, zip64 or uses compression method %u\n", path,
+                    e.name.c_str(), e.method);
+            close();
+            return false;
+        }
+
+        // The local header repeats the name, with an extra field of its own length; the sizes in the
+        // directory are the ones to trust (a local header may defer them to a trailing descriptor)
+        if (local > directoryOffset || directoryOffset - local < kLocalHeaderSize ||
+            read32(bytes + local) != kLocalHeader)
+        {
+            fprintf(stderr, "ZipArchive: %s: damaged local header for %s\n", path, e.name.c_str());
+            close();
+            return false;
+        }
+        e.dataOffset = local + kLocalHeaderSize + read16(bytes + local + 26) + read16(bytes + local + 28);
+        if (e.dataOffset > directoryOffset || directoryOffset - e.dataOffset < e.compressedSize ||
+            (e.method == kStored && e.compressedSize != e.size))
+        {
+            fprintf(stderr, "ZipArchive: %s: data of %s runs past the end\n", path, e.name.c_str());
+            close();
+            return false;
+        }
+        list.push_back(e);
+        p += entryLength;
+    }
+    return true;
+}
+
+void ZipArchive::close()
+{
+    file.close();
+    list.clear();
+}
+
+int ZipArchive::find(const char *name) const
+{
+    for (std::size_t i = 0; i < list.size(); ++i)
+        if (sameText(list[i].name, name))
+            return static_cast<int>(i);
+    return -1;
+}
+
+int ZipArchive::findExtension(const char *extension) const
+{
+    const std::size_t n = strlen(extension);
+    for (std::size_t i = 0; i < list.size(); ++i)
+        if (list[i].name.size() >= n && sameText(list[i].name.substr(list[i].name.size() - n), extension))
+            return static_cast<int>(i);
+    return -1;
+}
+
+ZipEntryReader::ZipEntryReader(const ZipArchive &archive, const ZipEntry &entry)
+    : entry(entry), compressed(archive.data(entry))
+{
+    memset(&z, 0, sizeof(z));
+    if (entry.method == kDeflated)
+    {
+        // raw deflate data: no zlib header or trailer
+        inflating = inflateInit2(&z, -MAX_WBITS) == Z_OK;
+        failed = !inflating;
+        z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed));
+        z.avail_in = entry.compressedSize;
+    }
+}
+
+ZipEntryReader::~ZipEntryReader()
+{
+    if (inflating)
+        inflateEnd(&z);
+}
+
+std::size_t ZipEntryReader::read(char *buffer, std::size_t size)
+{
+    if (finished || failed || size == 0)
+        return 0;
+
+    std::size_t n = 0;
+    if (entry.method == kStored)
+    {
+        n = std::min<std::size_t>(size, entry.size - produced);
+        memcpy(buffer, compressed + produced, n);
+    }
+    else
+    {
+        z.next_out = reinterpret_cast<Bytef *>(buffer);
+        z.avail_out = static_cast<uInt>(std::min<std::size_t>(size, 0x40000000));
+        const uInt room = z.avail_out;
+        const int status = inflate(&z, Z_NO_FLUSH);
+        n = room - z.avail_out;
+        if (status != Z_OK && status != Z_STREAM_END)
+        {
+            fprintf(stderr, "ZipEntryReader: %s does not inflate (%s)\n", entry.name.c_str(),
+                    z.msg ? z.msg : "truncated");
+            failed = true;
+            return 0;
+        }
+        // everything is available up front, so a call that makes no progress short of the end never will
+        if (n == 0 && status != Z_STREAM_END)
+        {
+            fprintf(stderr, "ZipEntryReader: %s is truncated\n", entry.name.c_str());
+            failed = true;
+            return 0;
+        }
+        if (status == Z_STREAM_END && produced + n != entry.size)
+        {
+            fprintf(stderr, "ZipEntryReader: %s inflates to %zu bytes, not %u\n", entry.name.c_str(),
+                    static_cast<std::size_t>(produced) + n, entry.size);
+            failed = true;
+            return 0;
+        }
+    }
+    if (n > entry.size - produced)
+    {
+        fprintf(stderr, "ZipEntryReader: %s inflates past its size of %u bytes\n", entry.name.c_str(), entry.size);
+        failed = true;
+        return 0;
+    }
+
+    crc = static_cast<std::uint32_t>(crc32(crc, reinterpret_cast<const Bytef *>(buffer), static_cast<uInt>(n)));
+    produced += static_cast<std::uint32_t>(n);
+    if (produced == entry.size)
+    {
+        finished = true;
+        if (crc != entry.crc)
+        {
+            fprintf(stderr, "ZipEntryReader: %s fails its CRC check\n", entry.name.c_str());
+            failed = true;
+            return 0;
+        }
+    }
+    return n;
+}
+
+bool loadOBJFromZip(const char *zipPath, const char *entry, ObjMesh &mesh)
+{
+    mesh = ObjMesh();
+    ZipArchive archive;
+    if (!archive.open(zipPath))
+        return false;
+    const int index = entry && *entry ? archive.find(entry) : archive.findExtension(".obj");
+    if (index < 0)
+    {
+        fprintf(stderr, "loadOBJFromZip: %s has no %s\n", zipPath, entry && *entry ? entry : "OBJ entry");
+        return false;
+    }
+
+    ZipEntryReader reader(archive, archive.entries()[index]);
+    loadOBJStream([&](char *buffer, std::size_t size) { return reader.read(buffer, size); }, mesh);
+    if (!reader.ok())
+    {
+        mesh = ObjMesh();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+// ziparchive.hpp  -- zip archives read in place: entries listed from the central directory and inflated as
+// a stream
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "mappedfile.hpp"
+#include "objloader.hpp"
+
+struct ZipEntry
+{
+    std::string name;     // as stored, '/' separated
+    std::uint16_t method; // 0 stored, 8 deflated
+    std::uint32_t crc;
+    std::uint32_t compressedSize;
+    std::uint32_t size;
+    std::size_t dataOffset; // of the compressed bytes, from the start of the archive
+};
+
+// A zip file mapped read-only. open() reads the central directory and checks that every entry's local
+// header and data lie inside the file, so readers can take the bytes straight from the mapping. Zip64,
+// encrypted entries and methods other than stored and deflated are refused at open.
+class ZipArchive
+{
+  public:
+    bool open(const char *path);
+    void close();
+
+    const std::vector<ZipEntry> &entries() const
+    {
+        return list;
+    }
+    // Index of the entry called `name`, compared without regard to case; -1 if there is none
+    int find(const char *name) const;
+    // Index of the first entry whose name ends in `extension` (".obj"), without regard to case; -1 if none
+    int findExtension(const char *extension) const;
+
+    const char *data(const ZipEntry &entry) const
+    {
+        return file.data() + entry.dataOffset;
+    }
+
+  private:
+    MappedFile file;
+    std::vector<ZipEntry> list;
+};
+
+// One entry's uncompressed bytes, a read() at a time, inflated from the mapping into the caller's buffer
+// with no copy of the whole entry anywhere. The archive must outlive the reader.
+class ZipEntryReader
+{
+  public:
+    ZipEntryReader(const ZipArchive &archive, const ZipEntry &entry);
+    ~ZipEntryReader();
+
+    ZipEntryReader(const ZipEntryReader &) = delete;
+    ZipEntryReader &operator=(const ZipEntryReader &) = delete;
+
+    // Up to `size` bytes; 0 at the end of the entry and after an error
+    std::size_t read(char *buffer, std::size_t size);
+
+    // False once the data turned out corrupt, or at the end if its length or CRC-32 did not match the
+    // directory
+    bool ok() const
+    {
+        return !failed;
+    }
+
+  private:
+    const ZipEntry &entry;
+    const char *compressed;
+    z_stream z;
+    bool inflating = false;
+    bool finished = false;
+    bool failed = false;
+    std::uint32_t produced = 0;
+    std::uint32_t crc = 0;
+};
+
+// loadOBJStream over an entry of a zip archive: `entry` names it, or with NULL or "" the first entry
+// ending in .obj. Nothing is extracted to disk and the uncompressed text is never held whole. False (with
+// a message on stderr) if the archive cannot be read, has no such entry or the entry is corrupt.
+bool loadOBJFromZip(const char *zipPath, const char *entry, ObjMesh &mesh);
@@ -0,0 +1,322 @@
+// BulletScene.cpp  -- drones against static scene geometry, on Bullet's collision world
+
+#include "BulletScene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+
+#include "btBulletCollisionCommon.h"
+
+#include "Scenario.hpp"
+#include "SwarmState.hpp"
+#include "common/meshcache.hpp"
+
+namespace
+{
+
+// Drone proxies and obstacles both carry their index; drones are the non-static objects
+struct IndexedObject : public btCollisionObject
+{
+    std::uint32_t index = 0;
+};
+
+// Routes drone-drone pairs around the narrowphase and everything else through Bullet's own near callback
+class SceneDispatcher : public btCollisionDispatcher
+{
+  public:
+    explicit SceneDispatcher(btCollisionConfiguration *configuration) : btCollisionDispatcher(configuration)
+    {
+        setNearCallback(nearCallback);
+    }
+
+    std::vector<ContactPair> *pairs = NULL;
+    float size = 0.0f;
+    std::size_t active = 0; // drones [0, active) take part in this tick
+
+  private:
+    static void nearCallback(btBroadphasePair &pair, btCollisionDispatcher &dispatcher, const btDispatcherInfo &info)
+    {
+        SceneDispatcher &self = static_cast<SceneDispatcher &>(dispatcher);
+        const IndexedObject *a = static_cast<const IndexedObject *>(pair.m_pProxy0->m_clientObject);
+        const IndexedObject *b = static_cast<const IndexedObject *>(pair.m_pProxy1->m_clientObject);
+        if (a->isStaticObject() || b->isStaticObject())
+        {
+            btCollisionDispatcher::defaultNearCallback(pair, dispatcher, info);
+            return;
+        }
+        if (a->index >= self.active || b->index >= self.active)
+            return; // a parked proxy whose pair the cache has not dropped yet
+
+        // the cache works on fattened AABBs: keep only the pairs SpatialHash would report
+        const btVector3 &pa = a->getWorldTransform().getOrigin();
+        const btVector3 &pb = b->getWorldTransform().getOrigin();
+        if (std::fabs(pb.x() - pa.x()) < self.size && std::fabs(pb.y() - pa.y()) < self.size &&
+            std::fabs(pb.z() - pa.z()) < self.size)
+            self.pairs->push_back({std::min(a->index, b->index), std::max(a->index, b->index)});
+    }
+};
+
+struct Obstacle
+{
+    std::vector<float> vertices; // transformed into world space
+    std::vector<int> indices;
+    std::unique_ptr<btTriangleIndexVertexArray> mesh;
+    std::unique_ptr<btBvhTriangleMeshShape> shape;
+    IndexedObject object;
+};
+
+const short kDroneGroup = btBroadphaseProxy::DefaultFilter;
+const short kObstacleGroup = btBroadphaseProxy::StaticFilter;
+
+double msBetween(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+} // namespace
+
+struct BulletScene::World
+{
+    btDefaultCollisionConfiguration configuration;
+    SceneDispatcher dispatcher{&configuration};
+    btDbvtBroadphase broadphase;
+    btCollisionWorld collisions{&dispatcher, &broadphase, &configuration};
+
+    // Drone proxies are never removed: a shrinking swarm parks the surplus (no AABB updates, no pairs) and
+    // a growing one takes them back first, because removing an object from the world is linear in the
+    // object count and in the pair cache
+    std::unique_ptr<btBoxShape> droneShape;
+    float droneSize = 0.0f;
+    std::vector<std::unique_ptr<IndexedObject>> drones;
+    std::size_t active = 0;
+
+    std::vector<std::unique_ptr<Obstacle>> obstacles;
+
+    World()
+    {
+        // static obstacles never move: only the drones' AABBs are recomputed each tick
+        collisions.setForceUpdateAllAabbs(false);
+        // Every drone moves every tick. Left to its defaults the Dbvt would search for the new pairs of each
+        // moved proxy on the spot, one tree query per drone; deferred, they come out of one tree-against-
+        // tree pass in computeOverlappingPairs. Stretching each leaf half a box along its motion lets most
+        // drones stay inside their leaf for a tick or two instead of being reinserted every tick; the
+        // extra pairs that lets into the cache are dropped by the exact test in the near callback.
+        broadphase.m_deferedcollide = true;
+        broadphase.setVelocityPrediction(1.0f);
+    }
+
+    ~World()
+    {
+        for (auto &d : drones)
+            collisions.removeCollisionObject(d.get());
+        for (auto &o : obstacles)
+            if (o->shape)
+                collisions.removeCollisionObject(&o->object);
+    }
+
+    void setDroneSize(float size)
+    {
+        if (droneShape && size == droneSize)
+            return;
+        const btScalar half = 0.5f * size;
+        std::unique_ptr<btBoxShape> shape(new btBoxShape(btVector3(half, half, half)));
+        // the margin lies inside the box and must not exceed it for the tiniest drones
+        shape->setMargin(std::min<btScalar>(shape->getMargin(), 0.5f * half));
+        for (auto &d : drones)
+            d->setCollisionShape(shape.get());
+        droneShape = std::move(shape);
+        droneSize = size;
+    }
+
+    // Drones [0, n) take part from now on, at (x, y, z)
+    void setActive(const float *x, const float *y, const float *z, std::size_t n)
+    {
+        for (std::size_t i = n; i < active; ++i)
+        {
+            IndexedObject &d = *drones[i];
+            d.forceActivationState(DISABLE_SIMULATION);
+            d.getBroadphaseHandle()->m_collisionFilterGroup = 0;
+            d.getBroadphaseHandle()->m_collisionFilterMask = 0;
+        }
+        for (std::size_t i = active; i < std::min(n, drones.size()); ++i)
+        {
+            IndexedObject &d = *drones[i];
+            d.forceActivationState(ACTIVE_TAG);
+            d.getBroadphaseHandle()->m_collisionFilterGroup = kDroneGroup;
+            d.getBroadphaseHandle()->m_collisionFilterMask = btBroadphaseProxy::AllFilter;
+        }
+        for (std::size_t i = 0; i < std::min(n, drones.size()); ++i)
+            drones[i]->getWorldTransform().setOrigin(btVector3(x[i], y[i], z[i]));
+        while (drones.size() < n)
+        {
+            // inserted where it is: a proxy inserted anywhere else would pair with everything there first
+            const std::size_t i = drones.size();
+            std::unique_ptr<IndexedObject> d(new IndexedObject());
+            d->index = static_cast<std::uint32_t>(i);
+            d->getWorldTransform().setOrigin(btVector3(x[i], y[i], z[i]));
+            d->setCollisionShape(droneShape.get());
+            d->setCollisionFlags(btCollisionObject::CF_KINEMATIC_OBJECT);
+            collisions.addCollisionObject(d.get(), kDroneGroup, btBroadphaseProxy::AllFilter);
+            drones.push_back(std::move(d));
+        }
+        active = n;
+    }
+};
+
+BulletScene::BulletScene() : world(new World())
+{
+}
+
+BulletScene::~BulletScene() = default;
+
+std::size_t BulletScene::addObstacle(const float *vertices, std::size_t vertexCount, const void *indices,
+                                     std::size_t indexCount, bool shortIndices, const glm::mat4 &transform)
+{
+    std::unique_ptr<Obstacle> o(new Obstacle());
+    o->object.index = static_cast<std::uint32_t>(world->obstacles.size());
+    o->vertices.resize(vertexCount * 3);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+    {
+        const glm::vec4 p = transform * glm::vec4(vertices[3 * v], vertices[3 * v + 1], vertices[3 * v + 2], 1.0f);
+        o->vertices[3 * v] = p.x;
+        o->vertices[3 * v + 1] = p.y;
+        o->vertices[3 * v + 2] = p.z;
+    }
+    const std::size_t triangles = indexCount / 3;
+    o->indices.resize(triangles * 3);
+    for (std::size_t i = 0; i < o->indices.size(); ++i)
+        o->indices[i] = shortIndices ? static_cast<const std::uint16_t *>(indices)[i]
+                                     : static_cast<int>(static_cast<const std::uint32_t *>(indices)[i]);
+
+    // a mesh without triangles keeps its index but collides with nothing
+    if (triangles > 0)
+    {
+        btIndexedMesh part;
+        part.m_numTriangles = static_cast<int>(triangles);
+        part.m_triangleIndexBase = reinterpret_cast<const unsigned char *>(o->indices.data());
+        part.m_triangleIndexStride = 3 * sizeof(int);
+        part.m_numVertices = static_cast<int>(vertexCount);
+        part.m_vertexBase = reinterpret_cast<const unsigned char *>(o->vertices.data());
+        part.m_vertexStride = 3 * sizeof(float);
+        part.m_vertexType = PHY_FLOAT;
+        o->mesh.reset(new btTriangleIndexVertexArray());
+        o->mesh->addIndexedMesh(part, PHY_INTEGER);
+        o->shape.reset(new btBvhTriangleMeshShape(o->mesh.get(), true));
+
+        o->object.setCollisionShape(o->shape.get());
+        o->object.setCollisionFlags(btCollisionObject::CF_STATIC_OBJECT);
+        // inactive, so updateAabbs skips it; drones are active, which is all a pair needs
+        o->object.forceActivationState(ISLAND_SLEEPING);
+        world->collisions.addCollisionObject(&o->object, kObstacleGroup,
+                                             btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+    }
+    world->obstacles.push_back(std::move(o));
+    return world->obstacles.size() - 1;
+}
+
+std::size_t BulletScene::obstacleCount() const
+{
+    return world->obstacles.size();
+}
+
+void BulletScene::collide(const float *x, const float *y, const float *z, std::size_t n, float size,
+                          std::vector<ContactPair> &pairs, std::vector<ObstacleContact> &hits)
+{
+    using clock = std::chrono::steady_clock;
+    World &w = *world;
+    pairs.clear();
+    hits.clear();
+
+    const clock::time_point t0 = clock::now();
+    w.setDroneSize(size);
+    w.setActive(x, y, z, n);
+    w.collisions.updateAabbs();
+    const clock::time_point t1 = clock::now();
+    w.collisions.computeOverlappingPairs();
+    const clock::time_point t2 = clock::now();
+
+    w.dispatcher.pairs = &pairs;
+    w.dispatcher.size = size;
+    w.dispatcher.active = n;
+    btOverlappingPairCache *cache = w.broadphase.getOverlappingPairCache();
+    w.dispatcher.dispatchAllCollisionPairs(cache, w.collisions.getDispatchInfo(), &w.dispatcher);
+
+    // one manifold per drone-obstacle pair: its deepest point is the contact
+    std::vector<std::uint32_t> hitObstacles;
+    for (int m = 0; m < w.dispatcher.getNumManifolds(); ++m)
+    {
+        const btPersistentManifold *manifold = w.dispatcher.getManifoldByIndexInternal(m);
+        const IndexedObject *b0 = static_cast<const IndexedObject *>(manifold->getBody0());
+        const IndexedObject *b1 = static_cast<const IndexedObject *>(manifold->getBody1());
+        const bool droneFirst = !b0->isStaticObject();
+        const IndexedObject *drone = droneFirst ? b0 : b1;
+        const IndexedObject *obstacle = droneFirst ? b1 : b0;
+        if (drone->isStaticObject() || !obstacle->isStaticObject() || drone->index >= n)
+            continue;
+        int deepest = -1;
+        for (int p = 0; p < manifold->getNumContacts(); ++p)
+            if (manifold->getContactPoint(p).getDistance() < 0.0f &&
+                (deepest < 0 || manifold->getContactPoint(p).getDistance() <
+                                    manifold->getContactPoint(deepest).getDistance()))
+                deepest = p;
+        if (deepest < 0)
+            continue;
+        // the normal points from body 1 towards body 0
+        const btManifoldPoint &point = manifold->getContactPoint(deepest);
+        const btVector3 normal = droneFirst ? point.m_normalWorldOnB : -point.m_normalWorldOnB;
+        hits.push_back({drone->index, obstacle->index, glm::vec3(normal.x(), normal.y(), normal.z()),
+                        -point.getDistance()});
+    }
+
+    std::sort(pairs.begin(), pairs.end(),
+              [](const ContactPair &p, const ContactPair &q) { return p.a != q.a ? p.a < q.a : p.b < q.b; });
+    std::sort(hits.begin(), hits.end(), [](const ObstacleContact &p, const ObstacleContact &q) {
+        return p.drone != q.drone ? p.drone < q.drone : p.obstacle < q.obstacle;
+    });
+    const clock::time_point t3 = clock::now();
+
+    last.updateMs = msBetween(t0, t1);
+    last.broadphaseMs = msBetween(t1, t2);
+    last.narrowphaseMs = msBetween(t2, t3);
+    last.proxies = n;
+    last.cachedPairs = static_cast<std::size_t>(cache->getNumOverlappingPairs());
+    last.dronePairs = pairs.size();
+    last.obstacleContacts = hits.size();
+}
+
+bool addScenarioObstacles(const Scenario &scenario, BulletScene &scene)
+{
+    for (const ScenarioObstacle &o : scenario.obstacles)
+    {
+        MeshFile mesh;
+        if (!loadOBJCached(o.mesh.c_str(), mesh, MeshCacheWeldPositions))
+        {
+            fprintf(stderr, "BulletScene: cannot load obstacle mesh %s\n", o.mesh.c_str());
+            return false;
+        }
+        scene.addObstacle(mesh.positions(), mesh.vertexCount(), mesh.indices(), mesh.indexCount(),
+                          mesh.indexSize() == 2, o.transform());
+    }
+    return true;
+}
+
+std::size_t resolveObstacleContacts(SwarmState &s, const std::vector<ObstacleContact> &hits)
+{
+    for (const ObstacleContact &h : hits)
+    {
+        const std::uint32_t i = h.drone;
+        s.px[i] += h.normal.x * h.depth;
+        s.py[i] += h.normal.y * h.depth;
+        s.pz[i] += h.normal.z * h.depth;
+        const float inward = s.vx[i] * h.normal.x + s.vy[i] * h.normal.y + s.vz[i] * h.normal.z;
+        if (inward < 0.0f)
+        {
+            s.vx[i] -= h.normal.x * inward;
+            s.vy[i] -= h.normal.y * inward;
+            s.vz[i] -= h.normal.z * inward;
+        }
+    }
+    return hits.size();
+}
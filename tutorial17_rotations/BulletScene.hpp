@@ -0,0 +1,87 @@
+#pragma once
+// BulletScene.hpp  -- drones against static scene geometry, on Bullet's collision world
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "SpatialHash.hpp"
+
+struct Scenario;
+struct SwarmState;
+
+// A drone inside an obstacle after a tick
+struct ObstacleContact
+{
+    std::uint32_t drone;
+    std::uint32_t obstacle; // addObstacle index
+    glm::vec3 normal;       // unit, pointing out of the obstacle
+    float depth;            // penetration along normal, > 0
+};
+
+// Where the time of the last collide() went, and what it found
+struct BulletSceneStats
+{
+    double updateMs = 0.0;      // moving the drone proxies (btCollisionWorld::updateAabbs)
+    double broadphaseMs = 0.0;  // btDbvtBroadphase pair update
+    double narrowphaseMs = 0.0; // walking the pair cache: drone pairs and box-triangle tests
+    std::size_t proxies = 0;
+    std::size_t cachedPairs = 0; // pairs in the broadphase cache, fattened AABBs included
+    std::size_t dronePairs = 0;
+    std::size_t obstacleContacts = 0;
+};
+
+// Collision backend on Bullet: every drone is a btBoxShape proxy in a btDbvtBroadphase and every
+// obstacle a btBvhTriangleMeshShape, all in one btCollisionWorld. collide() moves the proxies to this
+// tick's positions and runs the broadphase once for the whole swarm; drone pairs are taken from its
+// pair cache with the same cube test SpatialHash uses (no box-box narrowphase, the response only needs
+// the pair), while drone-obstacle pairs go through Bullet's box-triangle narrowphase and come back as
+// ObstacleContacts. Both lists are sorted, so for the same positions the output does not depend on the
+// history of the pair cache.
+//
+// Keeping a Dbvt leaf per moving drone costs about ten times a SpatialHash pass over the same swarm
+// (bench_bullet), which is why the hash stays the default and this scene is only worth it with obstacles.
+//
+// Bullet's headers stay out of this one: the world lives behind a pointer.
+class BulletScene
+{
+  public:
+    BulletScene();
+    ~BulletScene();
+
+    BulletScene(const BulletScene &) = delete;
+    BulletScene &operator=(const BulletScene &) = delete;
+
+    // A static triangle mesh (xyz positions, three indices per triangle, 16 or 32 bit), placed with
+    // `transform`. The scene keeps its own transformed copy, so the arrays may go away afterwards.
+    // Returns the obstacle's index.
+    std::size_t addObstacle(const float *vertices, std::size_t vertexCount, const void *indices,
+                            std::size_t indexCount, bool shortIndices, const glm::mat4 &transform);
+    std::size_t obstacleCount() const;
+
+    // One tick: n drones as cubes of edge `size` centred on (x, y, z). Proxies are added or removed to
+    // match n; pairs and hits are cleared first.
+    void collide(const float *x, const float *y, const float *z, std::size_t n, float size,
+                 std::vector<ContactPair> &pairs, std::vector<ObstacleContact> &hits);
+
+    const BulletSceneStats &stats() const
+    {
+        return last;
+    }
+
+  private:
+    struct World;
+    std::unique_ptr<World> world;
+    BulletSceneStats last;
+};
+
+// Every obstacle of the scenario: each mesh goes through loadOBJCached (welded positions) and is placed
+// with its position and scale. Reports the first mesh that fails to load and returns false.
+bool addScenarioObstacles(const Scenario &scenario, BulletScene &scene);
+
+// Move each drone out of the obstacle along the contact normal and drop the part of its velocity that
+// points into it. Returns the number of contacts applied.
+std::size_t resolveObstacleContacts(SwarmState &state, const std::vector<ObstacleContact> &hits);
@@ -0,0 +1,32 @@
+#pragma once
+// DroneParams.hpp  -- per-drone behaviour parameters and the one set of defaults ECE_UAV and scenarios share
+
+#include <glm/glm.hpp>
+
+// ECE_UAV's member initializers and DroneParams both read these, so a default changes in one place
+const float kDroneMass = 1.0f;      // kg
+const float kDroneMaxForce = 20.0f; // N (magnitude)
+const float kDroneGravity = 10.0f;  // N (downward)
+const float kDroneSize = 0.20f;     // bounding cube edge, m
+const glm::vec3 kDroneAscendTarget = glm::vec3(0.0f, 50.0f, 0.0f);
+const glm::vec3 kDroneSphereCenter = glm::vec3(0.0f, 50.0f, 0.0f);
+const float kDroneSphereRadius = 10.0f;
+const float kDroneWaitSeconds = 5.0f;
+const float kDroneMaxAscendSpeed = 2.0f; // m/s
+const float kDroneMinTangentialSpeed = 2.0f;
+const float kDroneMaxTangentialSpeed = 10.0f;
+
+// The per-drone behaviour parameters of ECE_UAV / SwarmState, with the same defaults
+struct DroneParams
+{
+    float mass = kDroneMass;
+    float maxForce = kDroneMaxForce;
+    float gravity = kDroneGravity;
+    glm::vec3 ascendTarget = kDroneAscendTarget;
+    glm::vec3 sphereCenter = kDroneSphereCenter;
+    float sphereRadius = kDroneSphereRadius;
+    float waitSeconds = kDroneWaitSeconds;
+    float maxAscendSpeed = kDroneMaxAscendSpeed;
+    float minTangentialSpeed = kDroneMinTangentialSpeed;
+    float maxTangentialSpeed = kDroneMaxTangentialSpeed;
+};
@@ -5,64 +5,82 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <mutex>
-#include <random>
-#include <thread>
+
+#include "DroneParams.hpp"
+#include "SwarmRng.hpp"
+#include "SwarmScheduler.hpp"
 
 struct ECE_UAV
 {
+    // Identity: construction index in this process (SwarmFrame::ids refers to it)
+    const std::uint32_t id = nextId();
+
     // Physical properties
-    float mass = 1.0f;      // kg
-    float maxForce = 20.0f; // N (magnitude)
-    float gravity = 10.0f;  // N (downward)
-    float size_m = 0.20f;   // bounding cube 0.20 m (20 cm)
+    float mass = kDroneMass;         // kg
+    float maxForce = kDroneMaxForce; // N (magnitude)
+    float gravity = kDroneGravity;   // N (downward)
+    float size_m = kDroneSize;       // bounding cube 0.20 m (20 cm)
 
     // Kinematic state (protected by mutex)
     glm::vec3 position = glm::vec3(0.0f);
     glm::vec3 velocity = glm::vec3(0.0f);
     glm::vec3 acceleration = glm::vec3(0.0f);
 
-    // Threading
-    std::thread worker;
+    // Scheduling (stepped by SwarmScheduler's worker pool, no per-UAV thread)
     std::atomic<bool> running{false};
     std::mutex mtx;
 
     // Behavioral configuration
-    glm::vec3 ascendTarget = glm::vec3(0.0f, 50.0f, 0.0f); // NOTE: uses z-up convention, will adapt below
-    glm::vec3 sphereCenter = glm::vec3(0.0f, 50.0f, 0.0f); // center of virtual sphere (x,y,z) with z-up
-    float sphereRadius = 10.0f;
-    float waitSeconds = 5.0f;     // sat on ground
-    float sphereDuration = 60.0f; // seconds to roam on sphere surface after reaching it
-    float maxAscendSpeed = 2.0f;  // m/s (while ascending)
-    float minTangentialSpeed = 2.0f;
-    float maxTangentialSpeed = 10.0f;
-
-    // internal random generator for tangential wander
-    std::mt19937 rng;
-    std::uniform_real_distribution<float> uniform01{0.0f, 1.0f};
-
-    // internal timers
+    glm::vec3 ascendTarget = kDroneAscendTarget; // NOTE: uses z-up convention, will adapt below
+    glm::vec3 sphereCenter = kDroneSphereCenter; // center of virtual sphere (x,y,z) with z-up
+    float sphereRadius = kDroneSphereRadius;
+    float waitSeconds = kDroneWaitSeconds;       // sat on ground
+    float sphereDuration = 60.0f;                // seconds to roam on sphere surface after reaching it
+    float maxAscendSpeed = kDroneMaxAscendSpeed; // m/s (while ascending)
+    float minTangentialSpeed = kDroneMinTangentialSpeed;
+    float maxTangentialSpeed = kDroneMaxTangentialSpeed;
+
+    // internal random generator for tangential wander (same generator as the SwarmState kernel)
+    SwarmRng rng;
+
+    // internal timers (startTick is used when the scheduler runs in fixed-step mode)
     std::chrono::steady_clock::time_point startTime;
+    unsigned long long startTick = 0;
+    // index into the scheduler's member list while registered; SwarmScheduler keeps it current
+    std::size_t memberSlot = 0;
+
+    // Constructor: initial pos and RNG seed. The default seed is the UAV's id (its construction index in
+    // this process), so creating the same swarm in the same order reproduces the same random streams.
+    ECE_UAV(const glm::vec3 &startPos = glm::vec3(0.0f)) : position(startPos), rng(id)
+    {
+    }
+    ECE_UAV(const glm::vec3 &startPos, std::uint32_t seed) : position(startPos), rng(seed)
+    {
+    }
 
-    // Constructor: initial pos
-    ECE_UAV(const glm::vec3 &startPos = glm::vec3(0.0f)) : position(startPos), rng(std::random_device{}())
+    static std::uint32_t nextId()
     {
+        static std::atomic<std::uint32_t> counter{0};
+        return counter.fetch_add(1);
     }
 
-    // Start the internal thread (calls external threadFunction per spec)
+    // Register with the shared SwarmScheduler so the worker pool steps this UAV every tick
+    // (in fixed-step mode time only advances through SwarmScheduler::runSteps() or start())
     void start();
 
-    // Request stop and join
+    // Request stop and join (after join() returns no worker touches this UAV any more)
     void stop()
     {
         running.store(false);
     }
     void join()
     {
-        if (worker.joinable())
-            worker.join();
+        SwarmScheduler::instance().remove(this);
     }
 
     // Thread-safe getters
@@ -91,7 +109,28 @@ struct ECE_UAV
         std::swap(velocity, other.velocity);
     }
 
-    // internal update function (called by the worker thread)
+    // Swap velocity taking one mutex at a time; never holds two locks, so it cannot deadlock.
+    // Only valid while nothing else writes either velocity (SwarmScheduler calls it between ticks).
+    void exchangeVelocity(ECE_UAV &other)
+    {
+        glm::vec3 mine = getVelocity();
+        setVelocity(other.getVelocity());
+        other.setVelocity(mine);
+    }
+
+    // Obstacle contact response: move out along the unit normal (pointing away from the obstacle) by the
+    // penetration depth and drop the velocity component heading into it. Same rule as
+    // resolveObstacleContacts for a SwarmState; only valid between ticks, like exchangeVelocity.
+    void leaveObstacle(const glm::vec3 &normal, float depth)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        position += normal * depth;
+        const float inward = glm::dot(velocity, normal);
+        if (inward < 0.0f)
+            velocity -= normal * inward;
+    }
+
+    // internal update function (called by a SwarmScheduler worker once per tick)
     void updatePhysics(float dt, float elapsedSinceStart);
 
   private:
@@ -106,44 +145,13 @@ struct ECE_UAV
     }
 };
 
-// External thread function required by spec
-inline void threadFunction(ECE_UAV *pUAV)
-{
-    // Worker will run with 10 ms updates
-    using clock = std::chrono::steady_clock;
-    const std::chrono::milliseconds dt_ms(10);
-    pUAV->running.store(true);
-    pUAV->startTime = clock::now();
-    auto last = clock::now();
-
-    while (pUAV->running.load())
-    {
-        auto now = clock::now();
-        std::chrono::duration<float> elapsed = now - pUAV->startTime;
-        float t_since_start = elapsed.count();
-
-        // compute dt as elapsed between ticks (in seconds)
-        std::chrono::duration<float> frame_dt = now - last;
-        float dt = frame_dt.count();
-        if (dt <= 0.0f)
-            dt = 0.01f; // fallback
-        last = now;
-
-        // call update
-        pUAV->updatePhysics(dt, t_since_start);
-
-        // sleep to hit ~10ms update rate
-        std::this_thread::sleep_for(dt_ms);
-    }
-}
-
-// start() implementation: spawn thread
+// start() implementation: hand the UAV to the worker pool
 inline void ECE_UAV::start()
 {
     if (running.load())
         return;
     running.store(true);
-    worker = std::thread(threadFunction, this);
+    SwarmScheduler::instance().add(this);
 }
 
 // updatePhysics: single time-step physics & control
@@ -250,7 +258,7 @@ inline void ECE_UAV::updatePhysics(float dt, float elapsedSinceStart)
         // pick a target tangential speed (we can vary slowly)
         // Use a simple deterministic pseudo-random target that changes slowly based on time
         float tphase = elapsedSinceStart;
-        float rand01 = uniform01(rng);
+        float rand01 = rng.next01();
         float v_target = std::min(
             std::max(minTangentialSpeed + (rand01 * (maxTangentialSpeed - minTangentialSpeed)), minTangentialSpeed),
             maxTangentialSpeed);
@@ -0,0 +1,154 @@
+// FrameOverlay.cpp  -- on-screen breakdown of where each rendered frame's time goes
+
+#include "FrameOverlay.hpp"
+
+#include <stdio.h>
+
+#include "common/text2D.hpp"
+
+namespace
+{
+
+const double kWindowSeconds = 0.5;
+const int kTextSize = 14;
+const int kLineHeight = 16;
+
+double msBetween(FrameOverlay::clock::time_point a, FrameOverlay::clock::time_point b)
+{
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+} // namespace
+
+void FrameOverlay::create(const char *fontPath)
+{
+    initText2D(fontPath);
+    timerQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (timerQueries)
+        glGenQueries(kQueryFrames * GpuPhaseCount, &queries[0][0]);
+    created = true;
+    frameStart = lastLap = windowStart = clock::now();
+}
+
+void FrameOverlay::destroy()
+{
+    if (!created)
+        return;
+    if (timerQueries)
+        glDeleteQueries(kQueryFrames * GpuPhaseCount, &queries[0][0]);
+    cleanupText2D();
+    created = false;
+}
+
+void FrameOverlay::beginFrame()
+{
+    frameStart = lastLap = clock::now();
+    if (!timerQueries)
+        return;
+
+    // the oldest slot in the ring is reused this frame: collect whatever of it has finished
+    queryFrame = (queryFrame + 1) % kQueryFrames;
+    for (int p = 0; p < GpuPhaseCount; ++p)
+    {
+        if (!issued[queryFrame][p])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[queryFrame][p], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(queries[queryFrame][p], GL_QUERY_RESULT, &ns);
+            gpuSum[p] += ns * 1e-6;
+            ++gpuSamples[p];
+        }
+        // an unfinished result is dropped rather than waited for; reissuing the query discards it
+        issued[queryFrame][p] = false;
+    }
+}
+
+void FrameOverlay::lap(FramePhase phase)
+{
+    const clock::time_point now = clock::now();
+    cpuSum[phase] += msBetween(lastLap, now);
+    lastLap = now;
+}
+
+void FrameOverlay::beginGpu(GpuPhase phase)
+{
+    if (!timerQueries || activeGpu >= 0)
+        return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[queryFrame][phase]);
+    activeGpu = phase;
+}
+
+void FrameOverlay::endGpu()
+{
+    if (activeGpu < 0)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    issued[queryFrame][activeGpu] = true;
+    activeGpu = -1;
+}
+
+void FrameOverlay::endFrame(const FrameCounts &counts)
+{
+    const clock::time_point now = clock::now();
+    frameSum += msBetween(frameStart, now);
+    ++frames;
+    if (std::chrono::duration<double>(now - windowStart).count() < kWindowSeconds)
+        return;
+
+    for (int p = 0; p < FramePhaseCount; ++p)
+    {
+        cpuMs[p] = cpuSum[p] / frames;
+        cpuSum[p] = 0.0;
+    }
+    for (int p = 0; p < GpuPhaseCount; ++p)
+    {
+        gpuMs[p] = gpuSamples[p] ? gpuSum[p] / gpuSamples[p] : 0.0;
+        gpuSum[p] = 0.0;
+        gpuSamples[p] = 0;
+    }
+    frameMs = frameSum / frames;
+    frameSum = 0.0;
+    frames = 0;
+    shown = counts;
+    windowStart = now;
+}
+
+void FrameOverlay::draw()
+{
+    if (!created)
+        return;
+    // text over everything: the scene's depth must not hide it
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    char line[96];
+    int y = 600 - kLineHeight - 4;
+    // the frame time is the whole loop, buffer swap included, so it shows vsync too
+    snprintf(line, sizeof(line), "frame %6.2f ms %5.0f fps", frameMs, frameMs > 0.0 ? 1000.0 / frameMs : 0.0);
+    printText2D(line, 4, y, kTextSize);
+    y -= kLineHeight;
+    snprintf(line, sizeof(line), "cpu snap %5.2f cull %5.2f mat %5.2f", cpuMs[FrameSnapshot], cpuMs[FrameCull],
+             cpuMs[FrameMatrices]);
+    printText2D(line, 4, y, kTextSize);
+    y -= kLineHeight;
+    snprintf(line, sizeof(line), "    upld %5.2f draw %5.2f oth %5.2f", cpuMs[FrameUpload], cpuMs[FrameDraw],
+             cpuMs[FrameOther]);
+    printText2D(line, 4, y, kTextSize);
+    y -= kLineHeight;
+    if (timerQueries)
+    {
+        snprintf(line, sizeof(line), "gpu fld  %5.2f swrm %5.2f txt %5.2f", gpuMs[GpuField], gpuMs[GpuSwarm],
+                 gpuMs[GpuOverlay]);
+        printText2D(line, 4, y, kTextSize);
+        y -= kLineHeight;
+    }
+    snprintf(line, sizeof(line), "drones %zu visible %zu", shown.drones, shown.visible);
+    printText2D(line, 4, y, kTextSize);
+    y -= kLineHeight;
+    snprintf(line, sizeof(line), "draws %zu tris %zu", shown.drawCalls, shown.triangles);
+    printText2D(line, 4, y, kTextSize);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
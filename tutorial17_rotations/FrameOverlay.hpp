@@ -0,0 +1,88 @@
+#pragma once
+// FrameOverlay.hpp  -- on-screen breakdown of where each rendered frame's time goes
+
+#include <chrono>
+#include <cstddef>
+
+#include <GL/glew.h>
+
+// CPU phases of a frame, timed back to back: each lap() charges the time since the previous lap
+enum FramePhase
+{
+    FrameSnapshot, // acquiring the swarm frame (or sampling the replay)
+    FrameCull,     // frustum culling
+    FrameMatrices, // LOD selection and instance matrices
+    FrameUpload,   // the instance buffer, and meshes and textures as they finish loading
+    FrameDraw,     // draw call submission
+    FrameOther,    // input, title and the overlay itself
+    FramePhaseCount
+};
+
+// GPU work timed with GL_TIME_ELAPSED queries; queries cannot nest, so these run one after the other
+enum GpuPhase
+{
+    GpuField,
+    GpuSwarm,
+    GpuOverlay,
+    GpuPhaseCount
+};
+
+// What the frame drew, for the overlay's counters
+struct FrameCounts
+{
+    std::size_t drones = 0;
+    std::size_t visible = 0;
+    std::size_t drawCalls = 0;
+    std::size_t triangles = 0;
+};
+
+// Collects the timings above every frame and prints their averages over the last half second with
+// text2D. GPU results are read a few frames late from a ring of queries, and only once available, so the
+// overlay never stalls the pipeline; without timer queries (GL < 3.3 and no ARB_timer_query) the GPU
+// line is left out. Timing runs whether or not the overlay is shown, at two clock reads per phase.
+class FrameOverlay
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // initText2D with the font, and the query ring; needs the GL context current
+    void create(const char *fontPath);
+    void destroy();
+
+    // Start a frame: the CPU laps restart, and GPU results of earlier frames are collected
+    void beginFrame();
+    void lap(FramePhase phase);
+    void beginGpu(GpuPhase phase);
+    void endGpu();
+    // Close the frame with what it drew
+    void endFrame(const FrameCounts &counts);
+
+    // Print the averages in the top-left corner (800 x 600 text2D coordinates)
+    void draw();
+
+  private:
+    static const int kQueryFrames = 4; // frames in flight before a query result is read back
+
+    bool created = false;
+    bool timerQueries = false;
+    GLuint queries[kQueryFrames][GpuPhaseCount] = {};
+    bool issued[kQueryFrames][GpuPhaseCount] = {};
+    int queryFrame = 0;
+    int activeGpu = -1;
+
+    clock::time_point frameStart, lastLap;
+    clock::time_point windowStart;
+
+    // Sums over the current averaging window
+    double cpuSum[FramePhaseCount] = {};
+    double gpuSum[GpuPhaseCount] = {};
+    std::size_t gpuSamples[GpuPhaseCount] = {};
+    double frameSum = 0.0;
+    std::size_t frames = 0;
+
+    // Averages shown, in milliseconds
+    double cpuMs[FramePhaseCount] = {};
+    double gpuMs[GpuPhaseCount] = {};
+    double frameMs = 0.0;
+    FrameCounts shown;
+};
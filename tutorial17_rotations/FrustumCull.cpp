@@ -0,0 +1,195 @@
+// FrustumCull.cpp  -- per-frame view frustum culling of the swarm's bounding cubes
+
+#include "FrustumCull.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CULL_HAVE_SSE2 1
+#endif
+
+// the SIMD path reads four positions as twelve consecutive floats
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+
+Frustum Frustum::fromMatrix(const glm::mat4 &m)
+{
+    // glm is column-major: row r of the matrix is (m[0][r], m[1][r], m[2][r], m[3][r])
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum f;
+    f.planes[0] = row3 + row0;
+    f.planes[1] = row3 - row0;
+    f.planes[2] = row3 + row1;
+    f.planes[3] = row3 - row1;
+    f.planes[4] = row3 + row2;
+    f.planes[5] = row3 - row2;
+    for (glm::vec4 &p : f.planes)
+    {
+        const float length = glm::length(glm::vec3(p));
+        if (length > 0.0f)
+            p /= length;
+    }
+    return f;
+}
+
+namespace
+{
+
+// A cube of half edge h is entirely behind plane (n, d) when n . p + d < -h (|nx| + |ny| + |nz|): the
+// corner furthest along n is still behind. Folding that radius into d leaves one dot product and a
+// sign test per plane.
+struct CubePlanes
+{
+    float a[6], b[6], c[6], d[6];
+
+    CubePlanes(const Frustum &f, float size)
+    {
+        for (int p = 0; p < 6; ++p)
+        {
+            const glm::vec4 &pl = f.planes[p];
+            a[p] = pl.x;
+            b[p] = pl.y;
+            c[p] = pl.z;
+            d[p] = pl.w + 0.5f * size * (std::fabs(pl.x) + std::fabs(pl.y) + std::fabs(pl.z));
+        }
+    }
+};
+
+inline bool cubeVisible(const CubePlanes &planes, const glm::vec3 &p)
+{
+    bool inside = true;
+    for (int k = 0; k < 6; ++k)
+        inside &= planes.a[k] * p.x + planes.b[k] * p.y + planes.c[k] * p.z + planes.d[k] >= 0.0f;
+    return inside;
+}
+
+std::size_t cullRange(const CubePlanes &planes, const glm::vec3 *positions, std::size_t begin, std::size_t end,
+                      std::uint32_t *out)
+{
+    std::size_t k = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        // unconditional store, conditional advance: no branch to mispredict at the frustum's edges
+        out[k] = static_cast<std::uint32_t>(i);
+        k += cubeVisible(planes, positions[i]);
+    }
+    return k;
+}
+
+#if defined(CULL_HAVE_SSE2)
+// Lanes set in a 4-bit mask, packed to the front, and how many there are
+struct LaneTable
+{
+    std::uint8_t lanes[16][4];
+    std::uint8_t count[16];
+
+    LaneTable()
+    {
+        for (int m = 0; m < 16; ++m)
+        {
+            count[m] = 0;
+            for (int l = 0; l < 4; ++l)
+            {
+                lanes[m][l] = 0;
+                if (m & (1 << l))
+                    lanes[m][count[m]++] = static_cast<std::uint8_t>(l);
+            }
+        }
+    }
+} laneTable;
+
+std::size_t cullSse2(const CubePlanes &planes, const glm::vec3 *positions, std::size_t n, std::uint32_t *out,
+                     std::size_t &done)
+{
+    __m128 a[6], b[6], c[6], d[6];
+    for (int p = 0; p < 6; ++p)
+    {
+        a[p] = _mm_set1_ps(planes.a[p]);
+        b[p] = _mm_set1_ps(planes.b[p]);
+        c[p] = _mm_set1_ps(planes.c[p]);
+        d[p] = _mm_set1_ps(planes.d[p]);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    std::size_t k = 0, i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3  ->  x0..x3, y0..y3, z0..z3
+        const float *f = reinterpret_cast<const float *>(positions + i);
+        const __m128 t0 = _mm_loadu_ps(f), t1 = _mm_loadu_ps(f + 4), t2 = _mm_loadu_ps(f + 8);
+        const __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(t0, t0, _MM_SHUFFLE(3, 0, 3, 0)),
+                                        _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(t0, t1, _MM_SHUFFLE(0, 0, 1, 1)),
+                                        _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 1, 2, 2)),
+                                        _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(3, 0, 3, 0)), _MM_SHUFFLE(1, 0, 2, 0));
+
+        // same operation order as cubeVisible, so both paths agree bit for bit
+        __m128 inside = _mm_cmpeq_ps(zero, zero);
+        for (int p = 0; p < 6; ++p)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[p], x), _mm_mul_ps(b[p], y)),
+                                                _mm_mul_ps(c[p], z)),
+                                     d[p]);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+        }
+
+        // compaction: write all four slots, keep as many as were visible
+        const int mask = _mm_movemask_ps(inside);
+        const std::uint8_t *lanes = laneTable.lanes[mask];
+        out[k + 0] = static_cast<std::uint32_t>(i + lanes[0]);
+        out[k + 1] = static_cast<std::uint32_t>(i + lanes[1]);
+        out[k + 2] = static_cast<std::uint32_t>(i + lanes[2]);
+        out[k + 3] = static_cast<std::uint32_t>(i + lanes[3]);
+        k += laneTable.count[mask];
+    }
+    done = i;
+    return k;
+}
+#endif
+
+CullStats finish(std::vector<std::uint32_t> &visible, std::size_t k, std::size_t n)
+{
+    visible.resize(k);
+    CullStats stats;
+    stats.visible = k;
+    stats.culled = n - k;
+    return stats;
+}
+
+} // namespace
+
+CullStats cullCubes(const Frustum &frustum, const glm::vec3 *positions, std::size_t n, float size,
+                    std::vector<std::uint32_t> &visible)
+{
+    const CubePlanes planes(frustum, size);
+    // room for the unconditional stores past the last kept index
+    visible.resize(n + 4);
+    std::size_t k = 0, i = 0;
+#if defined(CULL_HAVE_SSE2)
+    k = cullSse2(planes, positions, n, visible.data(), i);
+#endif
+    k += cullRange(planes, positions, i, n, visible.data() + k);
+    return finish(visible, k, n);
+}
+
+CullStats cullCubesScalar(const Frustum &frustum, const glm::vec3 *positions, std::size_t n, float size,
+                          std::vector<std::uint32_t> &visible)
+{
+    const CubePlanes planes(frustum, size);
+    visible.resize(n + 1);
+    return finish(visible, cullRange(planes, positions, 0, n, visible.data()), n);
+}
+
+const char *cullKernelName()
+{
+#if defined(CULL_HAVE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,37 @@
+#pragma once
+// FrustumCull.hpp  -- per-frame view frustum culling of the swarm's bounding cubes
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// The six clip planes of a view-projection matrix (Gribb and Hartmann), as (n, d) with n pointing into
+// the frustum and |n| = 1, so n . p + d is the signed distance of p from the plane
+struct Frustum
+{
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+
+    static Frustum fromMatrix(const glm::mat4 &viewProjection);
+};
+
+struct CullStats
+{
+    std::size_t visible = 0;
+    std::size_t culled = 0;
+};
+
+// Indices of the drones whose axis-aligned cube of edge `size` centred on positions[i] is at least
+// partly inside the frustum, in increasing order; visible is overwritten. A cube is dropped only when it
+// lies entirely behind one plane, so nothing on screen is ever lost (a few cubes just outside a corner
+// survive). Four drones per iteration with SSE2 where available; the scalar path handles the tail.
+CullStats cullCubes(const Frustum &frustum, const glm::vec3 *positions, std::size_t n, float size,
+                    std::vector<std::uint32_t> &visible);
+
+// Same test one drone at a time; the reference the SIMD path is checked against
+CullStats cullCubesScalar(const Frustum &frustum, const glm::vec3 *positions, std::size_t n, float size,
+                          std::vector<std::uint32_t> &visible);
+
+// "SSE2" or "scalar"
+const char *cullKernelName();
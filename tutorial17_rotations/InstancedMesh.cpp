@@ -0,0 +1,158 @@
+// InstancedMesh.cpp  -- one mesh drawn many times with per-instance model matrices, one call per level of detail
+
+#include "InstancedMesh.hpp"
+
+#include <algorithm>
+
+void InstancedMesh::create(const std::vector<float> &vertices, const std::vector<unsigned int> &indices)
+{
+    create(vertices.data(), vertices.size() / 3, indices.data(), indices.size(), GL_UNSIGNED_INT);
+}
+
+void InstancedMesh::create(const float *vertices, std::size_t vertexCount, const void *indices,
+                           std::size_t indexCount, GLenum indexType, const MeshLod *lods, std::size_t lodCount)
+{
+    this->indexType = indexType;
+    indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    if (lods && lodCount)
+        levels.assign(lods, lods + lodCount);
+    else
+        levels.assign(1, MeshLod{0, static_cast<std::uint32_t>(indexCount), 0.0f});
+    levelInstances.assign(levels.size(), 0);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glGenBuffers(1, &instanceBuffer);
+
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+
+    // the element array binding is part of the VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
+
+    // mat4 attribute = four vec4 columns, advanced once per instance
+    pointInstances(0);
+    for (GLuint c = 0; c < 4; ++c)
+    {
+        glEnableVertexAttribArray(instanceAttribute + c);
+        glVertexAttribDivisor(instanceAttribute + c, 1);
+    }
+
+    glBindVertexArray(0);
+}
+
+void InstancedMesh::pointInstances(std::size_t first) const
+{
+    // GL 3.3 has no base instance, so each level's batch re-points the attribute at its own matrices
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (GLuint c = 0; c < 4; ++c)
+        glVertexAttribPointer(instanceAttribute + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                              (void *)(first * sizeof(glm::mat4) + c * sizeof(glm::vec4)));
+}
+
+void InstancedMesh::destroy()
+{
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    glDeleteBuffers(1, &instanceBuffer);
+    vao = vertexBuffer = indexBuffer = instanceBuffer = 0;
+    instances = capacity = 0;
+    levels.clear();
+    levelInstances.clear();
+}
+
+glm::mat4 *InstancedMesh::mapInstances(std::size_t count)
+{
+    instances = count;
+    std::fill(levelInstances.begin(), levelInstances.end(), 0);
+    if (!levelInstances.empty())
+        levelInstances[0] = count;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    if (count > capacity)
+    {
+        // grow geometrically so a swarm that slowly gains drones does not reallocate every frame
+        capacity = count + count / 2;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+    }
+    if (count == 0)
+        return NULL;
+    void *p = glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4),
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!p)
+    {
+        // nothing gets drawn rather than garbage
+        instances = 0;
+        std::fill(levelInstances.begin(), levelInstances.end(), 0);
+    }
+    return static_cast<glm::mat4 *>(p);
+}
+
+void InstancedMesh::unmapInstances()
+{
+    if (instances == 0)
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+void InstancedMesh::setLodInstanceCounts(const std::size_t *counts)
+{
+    std::size_t total = 0;
+    for (std::size_t l = 0; l < levelInstances.size(); ++l)
+        total += counts[l];
+    // counts that do not add up to what was mapped would draw unwritten or missing matrices
+    if (total != instances)
+        return;
+    levelInstances.assign(counts, counts + levelInstances.size());
+}
+
+unsigned InstancedMesh::selectLod(float projectedRadius, float maxPixelError) const
+{
+    for (std::size_t l = levels.size(); l-- > 1;)
+        if (levels[l].error * projectedRadius <= maxPixelError)
+            return static_cast<unsigned>(l);
+    return 0;
+}
+
+std::size_t InstancedMesh::drawnTriangleCount() const
+{
+    std::size_t triangles = 0;
+    for (std::size_t l = 0; l < levels.size(); ++l)
+        triangles += levelInstances[l] * (levels[l].indexCount / 3);
+    return triangles;
+}
+
+std::size_t InstancedMesh::drawCallCount() const
+{
+    if (instances == 0)
+        return 0;
+    std::size_t calls = 0;
+    for (std::size_t l = 0; l < levels.size(); ++l)
+        calls += levelInstances[l] != 0;
+    return calls;
+}
+
+void InstancedMesh::draw() const
+{
+    if (instances == 0)
+        return;
+    glBindVertexArray(vao);
+    std::size_t first = 0;
+    for (std::size_t l = 0; l < levels.size(); ++l)
+    {
+        const std::size_t count = levelInstances[l];
+        if (count == 0)
+            continue;
+        pointInstances(first);
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(levels[l].indexCount), indexType,
+                                (void *)(levels[l].firstIndex * indexSize), static_cast<GLsizei>(count));
+        first += count;
+    }
+}
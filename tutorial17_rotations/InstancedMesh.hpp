@@ -0,0 +1,74 @@
+#pragma once
+// InstancedMesh.hpp  -- one mesh drawn many times with per-instance model matrices, one call per level of detail
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "common/meshsimplify.hpp"
+
+class InstancedMesh
+{
+  public:
+    // The per-instance mat4 occupies four consecutive attribute locations starting here
+    // (matches "layout(location = 3) in mat4 instanceModel" in StandardShading.vertexshader)
+    static const GLuint instanceAttribute = 3;
+
+    // Upload an indexed triangle mesh: xyz positions and three indices per triangle (ObjMesh's
+    // vertices and indices)
+    void create(const std::vector<float> &vertices, const std::vector<unsigned int> &indices);
+    // Same from raw arrays, e.g. straight out of a mapped MeshFile; indexType is GL_UNSIGNED_SHORT or
+    // GL_UNSIGNED_INT. lods, if given, are ranges of the indices (a buildLodChain); without them all the
+    // indices form the one level.
+    void create(const float *vertices, std::size_t vertexCount, const void *indices, std::size_t indexCount,
+                GLenum indexType, const MeshLod *lods = NULL, std::size_t lodCount = 0);
+    void destroy();
+
+    // Orphan the instance buffer and map room for `count` matrices; write them, then unmapInstances().
+    // Orphaning lets the driver hand out fresh storage while the previous frame is still being drawn.
+    glm::mat4 *mapInstances(std::size_t count);
+    void unmapInstances();
+
+    // Levels of detail: instances are written grouped by level, finest first, and the counts handed over
+    // here; counts[l] instances draw with level l. Without this call every mapped instance uses level 0.
+    void setLodInstanceCounts(const std::size_t *counts);
+    // Coarsest level whose error stays within maxPixelError pixels on an instance whose bounding radius
+    // projects to projectedRadius pixels
+    unsigned selectLod(float projectedRadius, float maxPixelError = 1.0f) const;
+
+    // One glDrawElementsInstanced per level that has instances
+    void draw() const;
+
+    std::size_t instanceCount() const
+    {
+        return instances;
+    }
+    std::size_t lodCount() const
+    {
+        return levels.size();
+    }
+    std::size_t triangleCount(std::size_t lod = 0) const
+    {
+        return levels[lod].indexCount / 3;
+    }
+    // Triangles the next draw() submits, over all instances and levels
+    std::size_t drawnTriangleCount() const;
+    // Draw calls the next draw() makes: one per level with instances
+    std::size_t drawCallCount() const;
+
+  private:
+    void pointInstances(std::size_t first) const;
+
+    GLuint vao = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    GLuint instanceBuffer = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::size_t indexSize = sizeof(GLuint);
+    std::vector<MeshLod> levels;
+    std::vector<std::size_t> levelInstances; // per level, consecutive in the instance buffer
+    std::size_t instances = 0;
+    std::size_t capacity = 0;
+};
@@ -0,0 +1,769 @@
+// Scenario.cpp  -- swarm layouts, behaviour parameters and run length read from a scenario file
+
+#include "Scenario.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ECE_UAV.hpp"
+#include "SwarmFormation.hpp"
+#include "SwarmRng.hpp"
+#include "SwarmState.hpp"
+
+namespace
+{
+
+// Just enough of a JSON document model for scenario files, which are small: formations are generated,
+// so even a million-drone scenario is a few lines of text
+struct JsonValue
+{
+    enum Kind
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    } kind = Null;
+    double number = 0.0;
+    bool boolean = false;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+    int line = 0;
+
+    const JsonValue *find(const char *key) const
+    {
+        for (const auto &m : members)
+            if (m.first == key)
+                return &m.second;
+        return NULL;
+    }
+};
+
+const char *kindName(JsonValue::Kind kind)
+{
+    static const char *const names[] = {"null", "a boolean", "a number", "a string", "an array", "an object"};
+    return names[kind];
+}
+
+class JsonParser
+{
+  public:
+    JsonParser(const char *path, const char *text) : path(path), p(text)
+    {
+    }
+
+    bool parse(JsonValue &root)
+    {
+        if (!value(root, 0))
+            return false;
+        skipSpace();
+        if (*p != '\0')
+            return fail("trailing characters after the document");
+        return true;
+    }
+
+  private:
+    static const int kMaxDepth = 64;
+
+    bool fail(const char *what)
+    {
+        fprintf(stderr, "%s:%d: %s\n", path, line, what);
+        return false;
+    }
+
+    void skipSpace()
+    {
+        for (;;)
+        {
+            while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+                line += *p++ == '\n';
+            // comments are not JSON, but scenario files are edited by hand
+            if (*p == '#' || (p[0] == '/' && p[1] == '/'))
+            {
+                while (*p != '\0' && *p != '\n')
+                    ++p;
+                continue;
+            }
+            return;
+        }
+    }
+
+    bool literal(const char *word)
+    {
+        const std::size_t n = strlen(word);
+        if (strncmp(p, word, n) != 0)
+            return false;
+        p += n;
+        return true;
+    }
+
+    bool string(std::string &out)
+    {
+        ++p; // opening quote
+        out.clear();
+        for (;;)
+        {
+            const char c = *p++;
+            if (c == '"')
+                return true;
+            if (c == '\0' || c == '\n')
+                return fail("unterminated string");
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            const char e = *p++;
+            switch (e)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                out += e;
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'u':
+                // names and keys are ASCII; anything else only has to survive as a placeholder
+                for (int k = 0; k < 4; ++k)
+                    if (!isxdigit(static_cast<unsigned char>(*p++)))
+                        return fail("bad \\u escape");
+                out += '?';
+                break;
+            default:
+                return fail("bad escape in string");
+            }
+        }
+    }
+
+    bool value(JsonValue &v, int depth)
+    {
+        if (depth > kMaxDepth)
+            return fail("nested too deeply");
+        skipSpace();
+        v.line = line;
+        const char c = *p;
+        if (c == '{')
+        {
+            v.kind = JsonValue::Object;
+            ++p;
+            skipSpace();
+            if (*p == '}')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                skipSpace();
+                if (*p != '"')
+                    return fail("expected a quoted key");
+                std::string key;
+                if (!string(key))
+                    return false;
+                skipSpace();
+                if (*p++ != ':')
+                    return fail("expected ':' after key");
+                v.members.emplace_back(std::move(key), JsonValue());
+                if (!value(v.members.back().second, depth + 1))
+                    return false;
+                skipSpace();
+                if (*p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (*p++ != '}')
+                    return fail("expected ',' or '}' in object");
+                return true;
+            }
+        }
+        if (c == '[')
+        {
+            v.kind = JsonValue::Array;
+            ++p;
+            skipSpace();
+            if (*p == ']')
+            {
+                ++p;
+                return true;
+            }
+            for (;;)
+            {
+                v.items.emplace_back();
+                if (!value(v.items.back(), depth + 1))
+                    return false;
+                skipSpace();
+                if (*p == ',')
+                {
+                    ++p;
+                    continue;
+                }
+                if (*p++ != ']')
+                    return fail("expected ',' or ']' in array");
+                return true;
+            }
+        }
+        if (c == '"')
+        {
+            v.kind = JsonValue::String;
+            return string(v.text);
+        }
+        if (literal("true") || literal("false"))
+        {
+            v.kind = JsonValue::Bool;
+            v.boolean = p[-1] == 'e' && p[-2] == 'u';
+            return true;
+        }
+        if (literal("null"))
+            return true;
+        if (c == '-' || (c >= '0' && c <= '9'))
+        {
+            char *end = NULL;
+            v.kind = JsonValue::Number;
+            v.number = strtod(p, &end);
+            if (end == p || !std::isfinite(v.number))
+                return fail("bad number");
+            p = end;
+            return true;
+        }
+        return fail("expected a value");
+    }
+
+    const char *path;
+    const char *p;
+    int line = 1;
+};
+
+// Typed access to a scenario document. The first error is reported and sticks: every later read
+// is a no-op, so the reading code can stay a flat list of fields.
+class ScenarioReader
+{
+  public:
+    explicit ScenarioReader(const char *path) : path(path)
+    {
+    }
+
+    bool ok() const
+    {
+        return good;
+    }
+
+    void fail(const JsonValue &at, const char *format, ...)
+    {
+        if (!good)
+            return;
+        good = false;
+        fprintf(stderr, "%s:%d: ", path, at.line);
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+        fputc('\n', stderr);
+    }
+
+    bool expect(const JsonValue &v, JsonValue::Kind kind, const char *what)
+    {
+        if (good && v.kind != kind)
+            fail(v, "%s must be %s, not %s", what, kindName(kind), kindName(v.kind));
+        return good;
+    }
+
+    // Every key of object must be one of `known` (NULL-terminated)
+    void onlyKeys(const JsonValue &object, const char *const *known, const char *what)
+    {
+        for (const auto &m : object.members)
+        {
+            bool found = false;
+            for (const char *const *k = known; *k && !found; ++k)
+                found = m.first == *k;
+            if (!found)
+                fail(m.second, "unknown key \"%s\" in %s", m.first.c_str(), what);
+        }
+    }
+
+    void read(const JsonValue &object, const char *key, float &out)
+    {
+        double d;
+        if (number(object, key, d))
+            out = static_cast<float>(d);
+    }
+    void read(const JsonValue &object, const char *key, double &out)
+    {
+        number(object, key, out);
+    }
+    void read(const JsonValue &object, const char *key, std::size_t &out)
+    {
+        double d;
+        if (number(object, key, d))
+        {
+            if (d < 0.0 || d != std::floor(d) || d > 1e12)
+                fail(*object.find(key), "\"%s\" must be a whole number >= 0", key);
+            else
+                out = static_cast<std::size_t>(d);
+        }
+    }
+    void read(const JsonValue &object, const char *key, std::uint32_t &out)
+    {
+        std::size_t n = out;
+        read(object, key, n);
+        if (good && n > 0xFFFFFFFFu)
+            fail(*object.find(key), "\"%s\" does not fit in 32 bits", key);
+        out = static_cast<std::uint32_t>(n);
+    }
+    void read(const JsonValue &object, const char *key, bool &out)
+    {
+        const JsonValue *v = object.find(key);
+        if (v && expect(*v, JsonValue::Bool, key))
+            out = v->boolean;
+    }
+    void read(const JsonValue &object, const char *key, std::string &out)
+    {
+        const JsonValue *v = object.find(key);
+        if (v && expect(*v, JsonValue::String, key))
+            out = v->text;
+    }
+    void read(const JsonValue &object, const char *key, glm::vec3 &out)
+    {
+        const JsonValue *v = object.find(key);
+        if (v)
+            vec3(*v, key, out);
+    }
+
+    void vec3(const JsonValue &v, const char *what, glm::vec3 &out)
+    {
+        if (!expect(v, JsonValue::Array, what))
+            return;
+        if (v.items.size() != 3)
+        {
+            fail(v, "%s must have 3 components", what);
+            return;
+        }
+        for (int c = 0; c < 3; ++c)
+            if (expect(v.items[c], JsonValue::Number, what))
+                out[c] = static_cast<float>(v.items[c].number);
+    }
+
+  private:
+    bool number(const JsonValue &object, const char *key, double &out)
+    {
+        const JsonValue *v = object.find(key);
+        if (!v || !expect(*v, JsonValue::Number, key))
+            return false;
+        out = v->number;
+        return true;
+    }
+
+    const char *path;
+    bool good = true;
+};
+
+void readParams(ScenarioReader &r, const JsonValue &b, DroneParams &params)
+{
+    static const char *const keys[] = {"mass",        "maxForce",       "gravity",
+                                       "ascendTarget", "sphereCenter",   "sphereRadius",
+                                       "waitSeconds",  "maxAscendSpeed", "minTangentialSpeed",
+                                       "maxTangentialSpeed", NULL};
+    if (!r.expect(b, JsonValue::Object, "behavior"))
+        return;
+    r.onlyKeys(b, keys, "behavior");
+    r.read(b, "mass", params.mass);
+    r.read(b, "maxForce", params.maxForce);
+    r.read(b, "gravity", params.gravity);
+    r.read(b, "ascendTarget", params.ascendTarget);
+    r.read(b, "sphereCenter", params.sphereCenter);
+    r.read(b, "sphereRadius", params.sphereRadius);
+    r.read(b, "waitSeconds", params.waitSeconds);
+    r.read(b, "maxAscendSpeed", params.maxAscendSpeed);
+    r.read(b, "minTangentialSpeed", params.minTangentialSpeed);
+    r.read(b, "maxTangentialSpeed", params.maxTangentialSpeed);
+    if (r.ok() && !(params.mass > 0.0f))
+        r.fail(b, "mass must be positive");
+}
+
+void readFormation(ScenarioReader &r, const JsonValue &f, Formation &formation)
+{
+    if (!r.expect(f, JsonValue::Object, "formation"))
+        return;
+    std::string type = "yardlines";
+    r.read(f, "type", type);
+
+    if (type == "yardlines")
+    {
+        static const char *const keys[] = {"type", "lines", "perLine", "width", "length", "count", NULL};
+        r.onlyKeys(f, keys, "a yardlines formation");
+        formation.kind = FormationYardLines;
+        r.read(f, "perLine", formation.perLine);
+        r.read(f, "width", formation.fieldWidth);
+        r.read(f, "length", formation.fieldLength);
+        r.read(f, "count", formation.count);
+        if (const JsonValue *lines = f.find("lines"))
+        {
+            if (r.expect(*lines, JsonValue::Array, "lines"))
+            {
+                formation.yardLines.clear();
+                for (const JsonValue &l : lines->items)
+                    if (r.expect(l, JsonValue::Number, "a yard line"))
+                        formation.yardLines.push_back(static_cast<float>(l.number));
+            }
+        }
+    }
+    else if (type == "grid")
+    {
+        static const char *const keys[] = {"type", "origin", "count", "spacing", NULL};
+        r.onlyKeys(f, keys, "a grid formation");
+        formation.kind = FormationGrid;
+        r.read(f, "origin", formation.origin);
+        r.read(f, "spacing", formation.spacing);
+        glm::vec3 count(1.0f);
+        r.read(f, "count", count);
+        for (int c = 0; c < 3 && r.ok(); ++c)
+            if (count[c] < 0.0f || count[c] != std::floor(count[c]))
+                r.fail(*f.find("count"), "grid counts must be whole numbers >= 0");
+        formation.countX = static_cast<std::size_t>(count.x);
+        formation.countY = static_cast<std::size_t>(count.y);
+        formation.countZ = static_cast<std::size_t>(count.z);
+    }
+    else if (type == "random")
+    {
+        static const char *const keys[] = {"type", "count", "min", "max", "seed", NULL};
+        r.onlyKeys(f, keys, "a random formation");
+        formation.kind = FormationRandom;
+        r.read(f, "count", formation.count);
+        r.read(f, "min", formation.boxMin);
+        r.read(f, "max", formation.boxMax);
+        r.read(f, "seed", formation.seed);
+    }
+    else if (type == "points")
+    {
+        static const char *const keys[] = {"type", "positions", NULL};
+        r.onlyKeys(f, keys, "a points formation");
+        formation.kind = FormationPoints;
+        if (const JsonValue *points = f.find("positions"))
+        {
+            if (r.expect(*points, JsonValue::Array, "positions"))
+            {
+                formation.points.resize(points->items.size());
+                for (std::size_t i = 0; i < points->items.size() && r.ok(); ++i)
+                    r.vec3(points->items[i], "a position", formation.points[i]);
+            }
+        }
+    }
+    else
+    {
+        r.fail(f, "unknown formation type \"%s\" (yardlines, grid, random or points)", type.c_str());
+    }
+}
+
+void readObstacle(ScenarioReader &r, const JsonValue &o, const std::string &directory, ScenarioObstacle &obstacle)
+{
+    static const char *const keys[] = {"mesh", "position", "scale", NULL};
+    if (!r.expect(o, JsonValue::Object, "an obstacle"))
+        return;
+    r.onlyKeys(o, keys, "an obstacle");
+    r.read(o, "mesh", obstacle.mesh);
+    r.read(o, "position", obstacle.position);
+    r.read(o, "scale", obstacle.scale);
+    if (r.ok() && obstacle.mesh.empty())
+        r.fail(o, "an obstacle needs a \"mesh\"");
+    if (r.ok() && !(obstacle.scale > 0.0f))
+        r.fail(*o.find("scale"), "scale must be positive");
+    if (!obstacle.mesh.empty() && obstacle.mesh[0] != '/')
+        obstacle.mesh = directory + obstacle.mesh;
+}
+
+template <class Emit> void generate(const Formation &f, Emit &&emit)
+{
+    std::size_t i = 0;
+    switch (f.kind)
+    {
+    case FormationYardLines:
+    {
+        const std::size_t n = f.droneCount();
+        for (const glm::vec3 &p : yardLineFormation(f.fieldWidth, f.fieldLength, f.yardLines, f.perLine))
+        {
+            if (i == n)
+                break;
+            emit(i++, p.x, p.y, p.z);
+        }
+        break;
+    }
+    case FormationGrid:
+    {
+        const std::size_t n = f.droneCount();
+        for (std::size_t z = 0; z < f.countZ; ++z)
+            for (std::size_t y = 0; y < f.countY; ++y)
+                for (std::size_t x = 0; x < f.countX && i < n; ++x)
+                    emit(i++, f.origin.x + f.spacing.x * static_cast<float>(x),
+                         f.origin.y + f.spacing.y * static_cast<float>(y),
+                         f.origin.z + f.spacing.z * static_cast<float>(z));
+        break;
+    }
+    case FormationRandom:
+    {
+        SwarmRng rng(f.seed);
+        const glm::vec3 extent = f.boxMax - f.boxMin;
+        for (; i < f.count; ++i)
+        {
+            const float x = f.boxMin.x + extent.x * rng.next01();
+            const float y = f.boxMin.y + extent.y * rng.next01();
+            const float z = f.boxMin.z + extent.z * rng.next01();
+            emit(i, x, y, z);
+        }
+        break;
+    }
+    case FormationPoints:
+        for (const glm::vec3 &p : f.points)
+            emit(i++, p.x, p.y, p.z);
+        break;
+    }
+}
+
+} // namespace
+
+glm::mat4 ScenarioObstacle::transform() const
+{
+    return glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(scale));
+}
+
+std::size_t Formation::droneCount() const
+{
+    switch (kind)
+    {
+    case FormationYardLines:
+    {
+        const std::size_t all = yardLines.size() * perLine;
+        return count ? std::min(count, all) : all;
+    }
+    case FormationGrid:
+    {
+        const std::size_t all = countX * countY * countZ;
+        return count ? std::min(count, all) : all;
+    }
+    case FormationRandom:
+        return count;
+    case FormationPoints:
+        return points.size();
+    }
+    return 0;
+}
+
+void Formation::positions(glm::vec3 *out) const
+{
+    generate(*this, [out](std::size_t i, float x, float y, float z) { out[i] = glm::vec3(x, y, z); });
+}
+
+void Formation::positions(float *x, float *y, float *z) const
+{
+    generate(*this, [x, y, z](std::size_t i, float px, float py, float pz) {
+        x[i] = px;
+        y[i] = py;
+        z[i] = pz;
+    });
+}
+
+std::size_t Scenario::droneCount() const
+{
+    std::size_t n = 0;
+    for (const ScenarioGroup &g : groups)
+        n += g.formation.droneCount();
+    return n;
+}
+
+std::size_t Scenario::stepCount() const
+{
+    if (steps)
+        return steps;
+    // dt is a float (0.01 is really 0.0099999998), so shave the ratio before rounding up
+    return static_cast<std::size_t>(std::ceil(duration / dt * (1.0 - 1e-6)));
+}
+
+Scenario defaultScenario(std::size_t drones)
+{
+    Scenario s;
+    s.name = "yard lines";
+    ScenarioGroup g;
+    Formation &f = g.formation;
+    const std::size_t lines = f.yardLines.size();
+    const std::size_t perLine = (drones + lines - 1) / lines;
+    if (perLine <= 3)
+    {
+        f.perLine = perLine;
+    }
+    else
+    {
+        // Anything larger than the original layout starts on a square grid two drone widths apart, so a
+        // scaling run times the simulation rather than a heap of overlapping drones. The yard lines do not
+        // scale: they are spread along z, and the physics rests drones on z = 0 (z is up there), which stacks
+        // the lines below the centre onto it. The grid lies in that ground plane, centred on the origin.
+        s.name = "ground grid";
+        const float spacing = 2.0f * kDroneSize;
+        const std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(drones))));
+        f.kind = FormationGrid;
+        f.countX = side;
+        f.countY = (drones + side - 1) / side;
+        f.countZ = 1;
+        f.spacing = glm::vec3(spacing);
+        f.origin = glm::vec3(-0.5f * spacing * static_cast<float>(f.countX - 1),
+                             -0.5f * spacing * static_cast<float>(f.countY - 1), 0.0f);
+    }
+    f.count = drones;
+    s.groups.push_back(g);
+    return s;
+}
+
+bool loadScenario(const char *path, Scenario &scenario)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        fprintf(stderr, "Failed to open scenario: %s\n", path);
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    JsonValue root;
+    if (!JsonParser(path, text.c_str()).parse(root))
+        return false;
+
+    ScenarioReader r(path);
+    Scenario s;
+    if (!r.expect(root, JsonValue::Object, "the scenario"))
+        return false;
+    static const char *const keys[] = {"name",       "dt",       "duration", "steps",     "seed",
+                                       "collisions", "collider", "groups",   "obstacles", NULL};
+    r.onlyKeys(root, keys, "the scenario");
+    r.read(root, "name", s.name);
+    r.read(root, "dt", s.dt);
+    r.read(root, "duration", s.duration);
+    r.read(root, "steps", s.steps);
+    r.read(root, "seed", s.seed);
+    r.read(root, "collisions", s.collisions);
+    if (r.ok() && !(s.dt > 0.0f))
+        r.fail(*root.find("dt"), "dt must be positive");
+    if (r.ok() && s.duration < 0.0)
+        r.fail(*root.find("duration"), "duration must not be negative");
+    std::string collider = "hash";
+    r.read(root, "collider", collider);
+    if (collider == "bullet")
+        s.collider = ColliderBullet;
+    else if (r.ok() && collider != "hash")
+        r.fail(*root.find("collider"), "unknown collider \"%s\" (hash or bullet)", collider.c_str());
+
+    const JsonValue *groups = root.find("groups");
+    if (groups && r.expect(*groups, JsonValue::Array, "groups"))
+    {
+        static const char *const groupKeys[] = {"name", "formation", "behavior", NULL};
+        for (const JsonValue &gv : groups->items)
+        {
+            if (!r.expect(gv, JsonValue::Object, "a group"))
+                break;
+            r.onlyKeys(gv, groupKeys, "a group");
+            ScenarioGroup g;
+            r.read(gv, "name", g.name);
+            if (const JsonValue *f = gv.find("formation"))
+                readFormation(r, *f, g.formation);
+            if (const JsonValue *b = gv.find("behavior"))
+                readParams(r, *b, g.params);
+            s.groups.push_back(std::move(g));
+        }
+    }
+
+    const JsonValue *obstacles = root.find("obstacles");
+    if (obstacles && r.expect(*obstacles, JsonValue::Array, "obstacles"))
+    {
+        // mesh paths are relative to the scenario file
+        const char *slash = strrchr(path, '/');
+        const std::string directory = slash ? std::string(path, slash + 1) : std::string();
+        for (const JsonValue &ov : obstacles->items)
+        {
+            ScenarioObstacle o;
+            readObstacle(r, ov, directory, o);
+            s.obstacles.push_back(std::move(o));
+        }
+        if (r.ok() && !s.obstacles.empty() && s.collider != ColliderBullet)
+            r.fail(*obstacles, "obstacles need \"collider\": \"bullet\"");
+    }
+    if (!r.ok())
+        return false;
+    scenario = std::move(s);
+    return true;
+}
+
+void populateSwarm(const Scenario &scenario, SwarmState &state)
+{
+    const std::size_t n = scenario.droneCount();
+    state.clear();
+    state.resize(n);
+
+    std::size_t first = 0;
+    for (const ScenarioGroup &g : scenario.groups)
+    {
+        const std::size_t count = g.formation.droneCount();
+        const DroneParams &p = g.params;
+        // data() + first, not &px[first]: an empty group (or scenario) may sit at first == n
+        g.formation.positions(state.px.data() + first, state.py.data() + first, state.pz.data() + first);
+
+        auto run = [first, count](std::vector<float> &v, float value) {
+            std::fill_n(v.begin() + first, count, value);
+        };
+        run(state.mass, p.mass);
+        run(state.maxForce, p.maxForce);
+        run(state.gravity, p.gravity);
+        run(state.ascendX, p.ascendTarget.x);
+        run(state.ascendY, p.ascendTarget.y);
+        run(state.ascendZ, p.ascendTarget.z);
+        run(state.centerX, p.sphereCenter.x);
+        run(state.centerY, p.sphereCenter.y);
+        run(state.centerZ, p.sphereCenter.z);
+        run(state.sphereRadius, p.sphereRadius);
+        run(state.waitSeconds, p.waitSeconds);
+        run(state.maxAscendSpeed, p.maxAscendSpeed);
+        run(state.minTangentialSpeed, p.minTangentialSpeed);
+        run(state.maxTangentialSpeed, p.maxTangentialSpeed);
+        first += count;
+    }
+
+    // resize zero-filled velocity, acceleration and start time; only the RNG streams are left
+    for (std::size_t i = 0; i < n; ++i)
+        state.rngState[i] = SwarmRng(scenario.seed + static_cast<std::uint32_t>(i)).state;
+}
+
+void applyParams(const DroneParams &params, ECE_UAV &uav)
+{
+    uav.mass = params.mass;
+    uav.maxForce = params.maxForce;
+    uav.gravity = params.gravity;
+    uav.ascendTarget = params.ascendTarget;
+    uav.sphereCenter = params.sphereCenter;
+    uav.sphereRadius = params.sphereRadius;
+    uav.waitSeconds = params.waitSeconds;
+    uav.maxAscendSpeed = params.maxAscendSpeed;
+    uav.minTangentialSpeed = params.minTangentialSpeed;
+    uav.maxTangentialSpeed = params.maxTangentialSpeed;
+}
@@ -0,0 +1,134 @@
+#pragma once
+// Scenario.hpp  -- swarm layouts, behaviour parameters and run length read from a scenario file
+//
+// A scenario file is JSON, plus // and # comments for hand editing:
+//
+//   {
+//     "name": "two groups",
+//     "dt": 0.01, "duration": 60, "seed": 1, "collisions": true,     // or "steps": 6000
+//     "groups": [
+//       { "formation": { "type": "yardlines", "lines": [0, 25, 50, 75, 100], "perLine": 3,
+//                        "width": 10, "length": 50 },
+//         "behavior": { "sphereCenter": [0, 50, 0], "sphereRadius": 10, "waitSeconds": 5 } },
+//       { "formation": { "type": "grid", "origin": [-50, 0, -50], "count": [100, 1, 100],
+//                        "spacing": [1, 1, 1] } },
+//       { "formation": { "type": "random", "count": 100000, "min": [-100, 0, -100],
+//                        "max": [100, 0, 100], "seed": 7 },
+//         "behavior": { "maxTangentialSpeed": 4 } },
+//       { "formation": { "type": "points", "positions": [[0, 0, 0], [1, 0, 0]] } }
+//     ],
+//     "collider": "bullet",                                           // or "hash" (the default)
+//     "obstacles": [ { "mesh": "suzanne.obj", "position": [0, 20, 5], "scale": 4 } ]
+//   }
+//
+// Obstacles are OBJ meshes, relative to the scenario file, placed by position and a uniform scale; they
+// need the bullet collider (BulletScene.hpp). Every key is optional. "behavior" takes any DroneParams field by name; the rest keep ECE_UAV's
+// defaults. Unknown keys are errors, so a misspelt parameter cannot silently fall back to its default.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "DroneParams.hpp"
+
+struct ECE_UAV;
+struct SwarmState;
+
+enum FormationKind
+{
+    FormationYardLines, // yardLineFormation
+    FormationGrid,      // countX x countY x countZ lattice from origin, x fastest
+    FormationRandom,    // count drones uniform in [boxMin, boxMax], from SwarmRng(seed)
+    FormationPoints     // explicit positions
+};
+
+struct Formation
+{
+    FormationKind kind = FormationYardLines;
+
+    // yard lines: tutorial17's field and its 15-drone layout by default
+    float fieldWidth = 10.0f;
+    float fieldLength = 50.0f;
+    std::vector<float> yardLines = {0.0f, 25.0f, 50.0f, 75.0f, 100.0f};
+    std::size_t perLine = 3;
+
+    // grid
+    glm::vec3 origin = glm::vec3(0.0f);
+    std::size_t countX = 1, countY = 1, countZ = 1;
+    glm::vec3 spacing = glm::vec3(1.0f);
+
+    // random; for yard lines and grids a nonzero count keeps only the first count drones
+    std::size_t count = 0;
+    glm::vec3 boxMin = glm::vec3(0.0f);
+    glm::vec3 boxMax = glm::vec3(0.0f);
+    std::uint32_t seed = 1;
+
+    // points
+    std::vector<glm::vec3> points;
+
+    std::size_t droneCount() const;
+    // Write the droneCount() start positions, in a fixed order, as vectors or as separate components
+    void positions(glm::vec3 *out) const;
+    void positions(float *x, float *y, float *z) const;
+};
+
+struct ScenarioGroup
+{
+    std::string name;
+    Formation formation;
+    DroneParams params;
+};
+
+enum ColliderKind
+{
+    ColliderHash,  // SpatialHash: drone-drone contacts only
+    ColliderBullet // BulletScene: drone-drone and drone-obstacle contacts
+};
+
+// A static mesh in the scene
+struct ScenarioObstacle
+{
+    std::string mesh; // OBJ path, resolved against the scenario file's directory
+    glm::vec3 position = glm::vec3(0.0f);
+    float scale = 1.0f;
+
+    // Model matrix: scale, then translate
+    glm::mat4 transform() const;
+};
+
+struct Scenario
+{
+    std::string name;
+    float dt = 0.01f;       // fixed step
+    double duration = 60.0; // simulated seconds, used when steps == 0
+    std::size_t steps = 0;
+    std::uint32_t seed = 1; // drone i (over all groups, in order) uses SwarmRng seed + i
+    bool collisions = true;
+    ColliderKind collider = ColliderHash;
+    std::vector<ScenarioGroup> groups;
+    std::vector<ScenarioObstacle> obstacles;
+
+    std::size_t droneCount() const;
+    // steps, or the duration in whole steps
+    std::size_t stepCount() const;
+};
+
+// tutorial17's built-in swarm: yard lines 0/25/50/75/100 with drones spread evenly across each,
+// 3 per line (the original 15) unless told otherwise. More than 15 go on a square grid on the ground
+// (z = 0), two drone widths apart and centred on the origin, so no two start in contact.
+Scenario defaultScenario(std::size_t drones = 15);
+
+// Replace `scenario` with the file's contents. Reports the first problem on stderr with its line and
+// returns false, leaving `scenario` unchanged.
+bool loadScenario(const char *path, Scenario &scenario);
+
+// Fill a SwarmState with every drone of the scenario in one pass: the arrays are sized once and each
+// group's parameters written as contiguous runs, with positions generated straight into px/py/pz.
+// Drones start at rest at simulation time 0.
+void populateSwarm(const Scenario &scenario, SwarmState &state);
+
+// Copy behaviour parameters onto a UAV (before start())
+void applyParams(const DroneParams &params, ECE_UAV &uav);
@@ -0,0 +1,123 @@
+// SpatialHash.cpp  -- near-linear broadphase for UAV-UAV contacts
+
+#include "SpatialHash.hpp"
+
+#include <cmath>
+#include <utility>
+
+#include "SwarmState.hpp"
+
+static inline std::uint32_t hashCell(std::int32_t cx, std::int32_t cy, std::int32_t cz, std::uint32_t mask)
+{
+    // large primes from Teschner et al., "Optimized Spatial Hashing for Collision Detection"
+    return (static_cast<std::uint32_t>(cx) + (static_cast<std::uint32_t>(cy) * 19349663u) +
+            (static_cast<std::uint32_t>(cz) * 83492791u)) &
+           mask;
+}
+
+void SpatialHash::findPairs(const float *x, const float *y, const float *z, std::size_t n, float size,
+                            std::vector<ContactPair> &pairs)
+{
+    pairs.clear();
+    if (n < 2)
+        return;
+
+    // power of two >= 2n buckets keeps chains short at one drone per occupied cell
+    std::uint32_t bucketCount = 1;
+    while (bucketCount < 2 * n)
+        bucketCount <<= 1;
+    const std::uint32_t mask = bucketCount - 1;
+    const float invCell = 1.0f / size;
+
+    cellX.resize(n);
+    cellY.resize(n);
+    cellZ.resize(n);
+    bucketOf.resize(n);
+    bucketStart.assign(bucketCount + 1, 0);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        cellX[i] = static_cast<std::int32_t>(std::floor(x[i] * invCell));
+        cellY[i] = static_cast<std::int32_t>(std::floor(y[i] * invCell));
+        cellZ[i] = static_cast<std::int32_t>(std::floor(z[i] * invCell));
+        bucketOf[i] = hashCell(cellX[i], cellY[i], cellZ[i], mask);
+        ++bucketStart[bucketOf[i] + 1];
+    }
+    for (std::uint32_t b = 0; b < bucketCount; ++b)
+        bucketStart[b + 1] += bucketStart[b];
+
+    // stable counting sort into bucket order, copying positions and cells alongside so every scan
+    // below walks contiguous memory
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    sortedIndex.resize(n);
+    sortedX.resize(n);
+    sortedY.resize(n);
+    sortedZ.resize(n);
+    sortedCell.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const std::uint32_t k = bucketFill[bucketOf[i]]++;
+        sortedIndex[k] = static_cast<std::uint32_t>(i);
+        sortedX[k] = x[i];
+        sortedY[k] = y[i];
+        sortedZ[k] = z[i];
+        sortedCell[k] = Cell{cellX[i], cellY[i], cellZ[i]};
+    }
+
+    // Half neighbourhood: the own cell plus the 13 neighbours that are "forward" in (z, y, x) order.
+    // Every pair of adjacent cells is then visited from exactly one side, so no pair is reported twice
+    // and each drone does 14 table lookups instead of 27.
+    static const std::int32_t forward[13][3] = {{1, 0, 0},  {-1, 1, 0}, {0, 1, 0},  {1, 1, 0},  {-1, -1, 1},
+                                                {0, -1, 1}, {1, -1, 1}, {-1, 0, 1}, {0, 0, 1},  {1, 0, 1},
+                                                {-1, 1, 1}, {0, 1, 1},  {1, 1, 1}};
+
+    // walking in sorted order keeps consecutive drones in the same cell, so repeated lookups stay in cache
+    for (std::uint32_t k = 0; k < n; ++k)
+    {
+        const Cell c = sortedCell[k];
+        const float px = sortedX[k], py = sortedY[k], pz = sortedZ[k];
+        const std::uint32_t i = sortedIndex[k];
+
+        auto test = [&](std::uint32_t m) {
+            if (std::fabs(sortedX[m] - px) < size && std::fabs(sortedY[m] - py) < size &&
+                std::fabs(sortedZ[m] - pz) < size)
+            {
+                const std::uint32_t j = sortedIndex[m];
+                pairs.push_back(i < j ? ContactPair{i, j} : ContactPair{j, i});
+            }
+        };
+
+        // own cell: only the entries after this one, the earlier ones already tested against us
+        const std::uint32_t own = bucketOf[i];
+        for (std::uint32_t m = k + 1; m < bucketStart[own + 1]; ++m)
+            if (sortedCell[m] == c)
+                test(m);
+
+        for (const auto &o : forward)
+        {
+            const Cell nc{c.x + o[0], c.y + o[1], c.z + o[2]};
+            const std::uint32_t b = hashCell(nc.x, nc.y, nc.z, mask);
+            for (std::uint32_t m = bucketStart[b]; m < bucketStart[b + 1]; ++m)
+                // the cell check drops hash collisions
+                if (sortedCell[m] == nc)
+                    test(m);
+        }
+    }
+}
+
+std::size_t resolveContacts(SwarmState &s, const std::vector<ContactPair> &pairs)
+{
+    std::size_t swaps = 0;
+    for (const ContactPair &c : pairs)
+    {
+        const float dx = s.px[c.b] - s.px[c.a], dy = s.py[c.b] - s.py[c.a], dz = s.pz[c.b] - s.pz[c.a];
+        const float wx = s.vx[c.b] - s.vx[c.a], wy = s.vy[c.b] - s.vy[c.a], wz = s.vz[c.b] - s.vz[c.a];
+        if (dx * wx + dy * wy + dz * wz >= 0.0f)
+            continue; // separating already
+        std::swap(s.vx[c.a], s.vx[c.b]);
+        std::swap(s.vy[c.a], s.vy[c.b]);
+        std::swap(s.vz[c.a], s.vz[c.b]);
+        ++swaps;
+    }
+    return swaps;
+}
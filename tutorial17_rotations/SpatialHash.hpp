@@ -0,0 +1,51 @@
+#pragma once
+// SpatialHash.hpp  -- near-linear broadphase for UAV-UAV contacts
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SwarmState;
+
+struct ContactPair
+{
+    std::uint32_t a, b; // drone indices, a < b
+};
+
+// Uniform grid with cell edge = bounding cube edge (ECE_UAV::size_m), stored as a hash table so the
+// world does not need bounds. Two cubes of edge `size` can only touch if their centres fall in the same
+// or adjacent cells. Building the table is a counting sort by bucket, which keeps each cell's drones
+// contiguous and makes the output order deterministic.
+class SpatialHash
+{
+  public:
+    // All pairs whose axis-aligned cubes of edge `size` centred on (x, y, z) overlap. Each pair is
+    // reported once, in an order that only depends on the input; pairs is cleared first.
+    void findPairs(const float *x, const float *y, const float *z, std::size_t n, float size,
+                   std::vector<ContactPair> &pairs);
+
+  private:
+    struct Cell
+    {
+        std::int32_t x, y, z;
+        bool operator==(const Cell &o) const
+        {
+            return x == o.x && y == o.y && z == o.z;
+        }
+    };
+
+    std::vector<std::int32_t> cellX, cellY, cellZ; // per drone
+    std::vector<std::uint32_t> bucketOf;           // per drone
+    std::vector<std::uint32_t> bucketStart;        // bucketCount + 1 prefix sums
+    std::vector<std::uint32_t> bucketFill;         // write cursor per bucket while sorting
+
+    // drones grouped by bucket
+    std::vector<std::uint32_t> sortedIndex;
+    std::vector<float> sortedX, sortedY, sortedZ;
+    std::vector<Cell> sortedCell;
+};
+
+// Elastic equal-mass response: swap the velocities of every pair that is still closing (pairs that
+// are already separating keep theirs, so an overlap lasting several ticks does not swap back and forth).
+// Pairs are applied in order; returns the number of swaps.
+std::size_t resolveContacts(SwarmState &state, const std::vector<ContactPair> &pairs);
@@ -0,0 +1,20 @@
+// SwarmFormation.cpp  -- start positions for the swarm, shared by the renderer and the headless runner
+
+#include "SwarmFormation.hpp"
+
+std::vector<glm::vec3> yardLineFormation(float fieldWidth, float fieldLength, const std::vector<float> &yardLines,
+                                         std::size_t perLine)
+{
+    std::vector<glm::vec3> positions;
+    positions.reserve(yardLines.size() * perLine);
+    for (float yard : yardLines)
+    {
+        const float z = ((yard / 100.0f) * fieldLength) - fieldLength / 2.0f;
+        for (std::size_t j = 0; j < perLine; ++j)
+        {
+            const float t = perLine > 1 ? static_cast<float>(j) / static_cast<float>(perLine - 1) : 0.5f;
+            positions.push_back(glm::vec3(-fieldWidth / 2.0f + fieldWidth * t, 0.0f, z));
+        }
+    }
+    return positions;
+}
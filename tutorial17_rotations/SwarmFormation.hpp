@@ -0,0 +1,15 @@
+#pragma once
+// SwarmFormation.hpp  -- start positions for the swarm, shared by the renderer and the headless runner
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Drones on the ground (y = 0) along football-field yard lines. The field is centred on the origin,
+// fieldWidth along x and fieldLength along z; a yard line at `yard` (0..100) sits at
+// z = yard / 100 * fieldLength - fieldLength / 2. Each line carries perLine drones spread evenly from
+// one sideline to the other (one drone sits on the centre line), line by line in the order given.
+// perLine = 3 over {0, 25, 50, 75, 100} is tutorial17's original 15-drone layout.
+std::vector<glm::vec3> yardLineFormation(float fieldWidth, float fieldLength, const std::vector<float> &yardLines,
+                                         std::size_t perLine);
@@ -0,0 +1,42 @@
+#pragma once
+// SwarmRng.hpp  -- 4-byte per-drone random generator shared by the scalar and SIMD physics paths
+
+#include <cstdint>
+
+// xorshift32: small enough to live in the SoA swarm store and cheap to advance in SIMD lanes
+// (shifts and xors only), so the vector kernel draws exactly the same numbers as ECE_UAV.
+struct SwarmRng
+{
+    std::uint32_t state = 0x9E3779B9u;
+
+    SwarmRng() = default;
+    explicit SwarmRng(std::uint32_t s)
+    {
+        seed(s);
+    }
+
+    // Hash the seed so consecutive seeds give unrelated streams; xorshift must never hold zero
+    void seed(std::uint32_t s)
+    {
+        s ^= s >> 16;
+        s *= 0x7FEB352Du;
+        s ^= s >> 15;
+        s *= 0x846CA68Bu;
+        s ^= s >> 16;
+        state = s ? s : 0x9E3779B9u;
+    }
+
+    std::uint32_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // uniform in [0, 1) from the top 24 bits
+    float next01()
+    {
+        return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+    }
+};
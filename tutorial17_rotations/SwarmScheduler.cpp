@@ -0,0 +1,483 @@
+// SwarmScheduler.cpp  -- fixed worker pool that steps the whole swarm at a fixed tick rate
+
+#include "SwarmScheduler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdio.h>
+
+#include "ECE_UAV.hpp"
+#include "SwarmState.hpp"
+#include "TrajectoryRecorder.hpp"
+
+static unsigned resolveWorkerCount(unsigned requested)
+{
+    if (requested > 0)
+        return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+SwarmScheduler::SwarmScheduler(unsigned workerCount, std::chrono::microseconds tick)
+    : numWorkers(resolveWorkerCount(workerCount)), tickPeriod(tick), epoch(clock::now()), timing(numWorkers)
+{
+}
+
+SwarmScheduler::~SwarmScheduler()
+{
+    stop();
+    join();
+}
+
+SwarmScheduler &SwarmScheduler::instance()
+{
+    static SwarmScheduler scheduler;
+    return scheduler;
+}
+
+void SwarmScheduler::add(ECE_UAV *uav)
+{
+    {
+        std::lock_guard<std::mutex> lk(membersMtx);
+        uav->startTime = clock::now();
+        uav->startTick = ticks;
+        uav->memberSlot = members.size();
+        members.push_back(uav);
+    }
+    if (!fixedStep.load())
+        start();
+}
+
+void SwarmScheduler::remove(ECE_UAV *uav)
+{
+    // a tick holds membersMtx while any worker is stepping, so once we own it nobody touches uav
+    std::lock_guard<std::mutex> lk(membersMtx);
+    const std::size_t slot = uav->memberSlot;
+    if (slot >= members.size() || members[slot] != uav)
+        return;
+    // order is irrelevant to the partitioning, so swap-and-pop with the slot the UAV carries keeps removal
+    // O(1); joining a whole swarm is then linear, not quadratic
+    members[slot] = members.back();
+    members[slot]->memberSlot = slot;
+    members.pop_back();
+
+    // a recorded drone may be among the ones gone; the rows cannot be remapped, so the recording stops
+    if (recorder && !recordRows.empty() && !recordEnded)
+    {
+        fprintf(stderr, "SwarmScheduler: a drone left the swarm, recording stopped\n");
+        recordEnded = true;
+    }
+}
+
+void SwarmScheduler::setFixedStep(float dt)
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    fixedDt = dt;
+    fixedStep.store(true);
+}
+
+void SwarmScheduler::setRealTime()
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    fixedStep.store(false);
+}
+
+void SwarmScheduler::setCollisions(bool enabled)
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    collisionsEnabled = enabled;
+    if (!enabled)
+    {
+        contacts.clear();
+        obstacleHits.clear();
+    }
+}
+
+void SwarmScheduler::setRecorder(TrajectoryRecorder *r)
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    recorder = r;
+    recordRows.clear();
+    recordEnded = false;
+}
+
+std::size_t SwarmScheduler::contactCount()
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    return contacts.size();
+}
+
+std::size_t SwarmScheduler::obstacleContactCount()
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    return obstacleHits.size();
+}
+
+void SwarmScheduler::setCollisionScene(BulletScene *s)
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    scene = s;
+    obstacleHits.clear();
+}
+
+std::size_t SwarmScheduler::size()
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    return members.size();
+}
+
+unsigned long long SwarmScheduler::tickCount()
+{
+    std::lock_guard<std::mutex> lk(membersMtx);
+    return ticks;
+}
+
+std::size_t SwarmScheduler::runSteps(std::size_t steps)
+{
+    {
+        std::lock_guard<std::mutex> lk(lifecycleMtx);
+        startHelpersLocked();
+    }
+
+    for (std::size_t k = 0; k < steps; ++k)
+    {
+        const bool profiling = timing.enabled();
+        const clock::time_point requested = profiling ? clock::now() : clock::time_point();
+        std::lock_guard<std::mutex> mlk(membersMtx);
+        const clock::time_point now = clock::now();
+        if (profiling)
+            timing.span(0, MetricLockWait, requested, now, ticks);
+        if (!runTick(Tick{fixedDt, now, ticks, true}))
+            return k;
+    }
+    return steps;
+}
+
+void SwarmScheduler::startHelpersLocked()
+{
+    if (helpersRunning)
+        return;
+
+    unsigned long long firstGeneration;
+    {
+        std::lock_guard<std::mutex> jlk(jobMtx);
+        quit = false;
+        firstGeneration = generation;
+    }
+
+    for (unsigned i = 1; i < numWorkers; ++i)
+        helpers.emplace_back(&SwarmScheduler::workerLoop, this, i, firstGeneration);
+    helpersRunning = true;
+}
+
+void SwarmScheduler::start()
+{
+    std::lock_guard<std::mutex> lk(lifecycleMtx);
+    bool stopped;
+    {
+        std::lock_guard<std::mutex> jlk(jobMtx);
+        stopped = quit;
+    }
+    if (ticker.joinable() && !stopped)
+        return;
+    // stop() without join(): the old threads are on their way out, so wait for them and start afresh
+    if (stopped)
+        joinLocked();
+    startHelpersLocked();
+    ticker = std::thread(&SwarmScheduler::tickLoop, this);
+}
+
+void SwarmScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(jobMtx);
+        quit = true;
+    }
+    jobReady.notify_all();
+}
+
+void SwarmScheduler::join()
+{
+    std::lock_guard<std::mutex> lk(lifecycleMtx);
+    joinLocked();
+}
+
+void SwarmScheduler::joinLocked()
+{
+    if (ticker.joinable())
+        ticker.join();
+    for (auto &t : helpers)
+        t.join();
+    helpers.clear();
+    helpersRunning = false;
+}
+
+void SwarmScheduler::workerLoop(unsigned index, unsigned long long firstGeneration)
+{
+    unsigned long long seen = firstGeneration;
+    for (;;)
+    {
+        Tick tick;
+        {
+            std::unique_lock<std::mutex> jlk(jobMtx);
+            jobReady.wait(jlk, [&]() { return quit || generation != seen; });
+            if (generation == seen)
+                return; // quit with no tick outstanding
+            seen = generation;
+            tick = job;
+        }
+
+        if (timing.enabled())
+        {
+            const clock::time_point begin = clock::now();
+            stepPartition(index, tick);
+            timing.span(index, MetricUpdate, begin, clock::now(), tick.index);
+        }
+        else
+            stepPartition(index, tick);
+
+        std::lock_guard<std::mutex> jlk(jobMtx);
+        if (--pending == 0)
+            jobDone.notify_one();
+    }
+}
+
+void SwarmScheduler::tickLoop()
+{
+    clock::time_point last = clock::now();
+    clock::time_point next = last;
+
+    for (;;)
+    {
+        // real time: sleep_until an absolute deadline so the 100 Hz rate does not drift with step cost;
+        // fixed step: no sleeping at all, ticks run back to back
+        if (!fixedStep.load())
+        {
+            next += tickPeriod;
+            std::this_thread::sleep_until(next);
+        }
+
+        const bool profiling = timing.enabled();
+        const clock::time_point woke = profiling ? clock::now() : clock::time_point();
+        std::lock_guard<std::mutex> mlk(membersMtx);
+        clock::time_point now = clock::now();
+        bool fixed = fixedStep.load();
+        if (profiling)
+        {
+            // lateness spans from the deadline to the wake-up, so the trace shows where the time went
+            if (!fixed && woke > next)
+                timing.span(0, MetricLateness, next, woke, ticks);
+            else if (!fixed)
+                timing.value(0, MetricLateness, 0);
+            timing.span(0, MetricLockWait, woke, now, ticks);
+        }
+        // more than a whole tick late: resync instead of bursting through missed ticks
+        if (now - next > tickPeriod)
+            next = now;
+
+        std::chrono::duration<float> frame_dt = now - last;
+        float dt = frame_dt.count();
+        if (dt <= 0.0f)
+            dt = 0.01f; // fallback
+        last = now;
+        if (profiling && !fixed)
+        {
+            const std::chrono::nanoseconds jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::duration<float>(dt) - tickPeriod);
+            timing.value(0, MetricJitter, static_cast<std::uint64_t>(std::abs(jitter.count())));
+        }
+
+        if (!runTick(Tick{fixed ? fixedDt : dt, now, ticks, fixed}))
+            return;
+    }
+}
+
+bool SwarmScheduler::runTick(const Tick &tick)
+{
+    const bool profiling = timing.enabled();
+    const clock::time_point begin = profiling ? clock::now() : clock::time_point();
+    {
+        // quit is checked in the same critical section that publishes the tick, so a helper can
+        // never exit between the check and the hand-off and leave us waiting on pending forever
+        std::lock_guard<std::mutex> jlk(jobMtx);
+        if (quit)
+            return false;
+        job = tick;
+        pending = numWorkers - 1;
+        ++generation;
+    }
+    jobReady.notify_all();
+
+    if (!profiling)
+    {
+        stepPartition(0, tick);
+        {
+            std::unique_lock<std::mutex> jlk(jobMtx);
+            jobDone.wait(jlk, [this]() { return pending == 0; });
+        }
+        if (collisionsEnabled)
+            resolveCollisions();
+        publishFrame(tick);
+        ++ticks;
+        return true;
+    }
+
+    // the same tick, timed phase by phase
+    clock::time_point t0 = clock::now();
+    stepPartition(0, tick);
+    clock::time_point t1 = clock::now();
+    timing.span(0, MetricUpdate, t0, t1, tick.index);
+    {
+        std::unique_lock<std::mutex> jlk(jobMtx);
+        jobDone.wait(jlk, [this]() { return pending == 0; });
+    }
+    t0 = clock::now();
+    timing.span(0, MetricBarrier, t1, t0, tick.index);
+    if (collisionsEnabled)
+    {
+        resolveCollisions();
+        t1 = clock::now();
+        timing.span(0, MetricCollisions, t0, t1, tick.index);
+        t0 = t1;
+    }
+    publishFrame(tick);
+    t1 = clock::now();
+    timing.span(0, MetricPublish, t0, t1, tick.index);
+    timing.span(0, MetricTick, begin, t1, tick.index);
+    ++ticks;
+    return true;
+}
+
+void SwarmScheduler::publishFrame(const Tick &tick)
+{
+    SwarmFrame &frame = frames.back();
+    frame.tick = tick.index;
+    if (tick.fixedStep)
+    {
+        frame.time = static_cast<double>(tick.index + 1) * tick.dt;
+    }
+    else
+    {
+        std::chrono::duration<double> wall = tick.now - epoch;
+        frame.time = wall.count();
+    }
+
+    frame.ids.clear();
+    frame.positions.clear();
+    frame.size = 0.0f;
+    // same reasoning as resolveCollisions: no worker is writing positions now
+    for (ECE_UAV *uav : members)
+    {
+        frame.ids.push_back(uav->id);
+        frame.positions.push_back(uav->position);
+        frame.size = std::max(frame.size, uav->size_m);
+    }
+    frames.publish();
+
+    if (recorder && !recordEnded)
+        recordFrame(tick, frame.time);
+}
+
+void SwarmScheduler::recordFrame(const Tick &tick, double time)
+{
+    if (recordRows.empty())
+    {
+        // swap-and-pop reorders members, so the rows are pinned to drones once, not read off members
+        if (members.size() != recorder->droneCount())
+            return;
+        recordRows = members;
+    }
+    TrajectoryFrame *out = recorder->beginFrame(time);
+    if (!out)
+        return;
+    for (std::size_t i = 0; i < recordRows.size(); ++i)
+    {
+        const ECE_UAV *uav = recordRows[i];
+        out->px[i] = uav->position.x;
+        out->py[i] = uav->position.y;
+        out->pz[i] = uav->position.z;
+        out->vx[i] = uav->velocity.x;
+        out->vy[i] = uav->velocity.y;
+        out->vz[i] = uav->velocity.z;
+        // elapsed time as stepPartition computed it for this tick
+        float elapsed;
+        if (tick.fixedStep)
+        {
+            elapsed = static_cast<float>(tick.index - uav->startTick) * tick.dt;
+        }
+        else
+        {
+            std::chrono::duration<float> wall = tick.now - uav->startTime;
+            elapsed = wall.count();
+        }
+        out->phase[i] = flightPhase(elapsed, uav->waitSeconds, glm::length(uav->ascendTarget - uav->position),
+                                    uav->sphereRadius);
+    }
+    recorder->commitFrame();
+}
+
+void SwarmScheduler::resolveCollisions()
+{
+    contactUavs.clear();
+    contactX.clear();
+    contactY.clear();
+    contactZ.clear();
+    float size = 0.0f;
+    // positions are only written by updatePhysics, and every worker has finished this tick, so they can
+    // be read without the per-UAV locks
+    for (ECE_UAV *uav : members)
+    {
+        if (!uav->running.load(std::memory_order_relaxed))
+            continue;
+        contactUavs.push_back(uav);
+        contactX.push_back(uav->position.x);
+        contactY.push_back(uav->position.y);
+        contactZ.push_back(uav->position.z);
+        size = std::max(size, uav->size_m);
+    }
+
+    if (scene)
+        scene->collide(contactX.data(), contactY.data(), contactZ.data(), contactUavs.size(), size, contacts,
+                       obstacleHits);
+    else
+        broadphase.findPairs(contactX.data(), contactY.data(), contactZ.data(), contactUavs.size(), size, contacts);
+
+    for (const ContactPair &c : contacts)
+    {
+        ECE_UAV *a = contactUavs[c.a];
+        ECE_UAV *b = contactUavs[c.b];
+        // only swap while closing, so an overlap lasting several ticks does not swap back and forth
+        glm::vec3 d = b->position - a->position;
+        if (glm::dot(d, b->getVelocity() - a->getVelocity()) >= 0.0f)
+            continue;
+        a->exchangeVelocity(*b);
+    }
+    // after the swaps, so a velocity handed over by a neighbour cannot carry a drone further into a wall
+    for (const ObstacleContact &h : obstacleHits)
+        contactUavs[h.drone]->leaveObstacle(h.normal, h.depth);
+}
+
+void SwarmScheduler::stepPartition(unsigned index, const Tick &tick)
+{
+    const std::size_t n = members.size();
+    const std::size_t begin = n * index / numWorkers;
+    const std::size_t end = n * (index + 1) / numWorkers;
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        ECE_UAV *uav = members[i];
+        if (!uav->running.load(std::memory_order_relaxed))
+            continue;
+        float elapsed;
+        if (tick.fixedStep)
+        {
+            // an integer tick count times dt, never a running float sum, so every run sees the same values
+            elapsed = static_cast<float>(tick.index - uav->startTick) * tick.dt;
+        }
+        else
+        {
+            std::chrono::duration<float> wall = tick.now - uav->startTime;
+            elapsed = wall.count();
+        }
+        uav->updatePhysics(tick.dt, elapsed);
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+// SwarmScheduler.hpp  -- fixed worker pool that steps the whole swarm at a fixed tick rate
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BulletScene.hpp"
+#include "SpatialHash.hpp"
+#include "SwarmSnapshot.hpp"
+#include "TickProfiler.hpp"
+
+struct ECE_UAV;
+class TrajectoryRecorder;
+
+// Owns a fixed set of worker threads (default = hardware_concurrency) instead of one thread per UAV.
+// Every tick the registered UAVs are split into contiguous partitions, one per worker, and each worker
+// calls updatePhysics on its partition. The tick thread itself works on partition 0, so N workers means
+// N threads in total regardless of swarm size.
+//
+// Two timing modes:
+//  - real time (default): ticks every 10 ms of wall clock, dt and elapsed time come from steady_clock
+//  - fixed step: every tick advances exactly dt of simulated time and elapsed time is tick count * dt,
+//    so with seeded UAVs a run is bit-identical regardless of machine load or worker count. Ticks run
+//    back to back (as fast as the CPU allows) from start(), or synchronously from runSteps().
+//
+// After the partitions finish, the tick thread runs a SpatialHash broadphase over all UAV positions and
+// swaps the velocities of contacting pairs (or, with a BulletScene attached, asks the scene for the pairs
+// and for the drones inside obstacles, and moves those out). No worker is stepping at that point, so each
+// swap takes one UAV mutex at a time and there is no lock ordering to get wrong. Finally it publishes every UAV's
+// position into a lock-free SwarmSnapshot for the renderer, and hands a frame to the TrajectoryRecorder
+// when one is attached and due.
+//
+// With profiler().enable(), every tick is timed phase by phase (TickProfiler.hpp), together with how late
+// the tick thread woke for its deadline and how long it waited for membersMtx.
+class SwarmScheduler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // workerCount == 0 selects std::thread::hardware_concurrency()
+    explicit SwarmScheduler(unsigned workerCount = 0, std::chrono::microseconds tick = std::chrono::milliseconds(10));
+    ~SwarmScheduler();
+
+    SwarmScheduler(const SwarmScheduler &) = delete;
+    SwarmScheduler &operator=(const SwarmScheduler &) = delete;
+
+    // Process-wide scheduler used by ECE_UAV::start()/join()
+    static SwarmScheduler &instance();
+
+    // Register a UAV; it is stepped from the next tick on. In real-time mode this starts the pool if it
+    // is not running yet; in fixed-step mode the caller decides when time advances.
+    void add(ECE_UAV *uav);
+    // Unregister a UAV; returns once no worker can touch it any more
+    void remove(ECE_UAV *uav);
+
+    // Timing mode; switch before adding UAVs so every UAV's elapsed time uses one clock
+    void setFixedStep(float dt);
+    void setRealTime();
+    bool isFixedStep() const
+    {
+        return fixedStep.load();
+    }
+
+    // UAV-UAV collision response (on by default)
+    void setCollisions(bool enabled);
+    // Contacting pairs found during the last tick
+    std::size_t contactCount();
+    // Drone-obstacle contacts resolved during the last tick (0 without a collision scene)
+    std::size_t obstacleContactCount();
+
+    // Collide through a BulletScene instead of the built-in SpatialHash (NULL switches back). The scene
+    // must outlive its attachment; it is only touched from the tick thread.
+    void setCollisionScene(BulletScene *scene);
+
+    // Record the swarm from the tick thread (NULL detaches); the recorder must stay open until it is
+    // detached. The first frame waits until the member count equals the recorder's drone count and fixes
+    // row i to the drone that was member i then. Drones added later are not recorded, and removing one
+    // ends the recording, since a replay takes each row to be one drone throughout.
+    void setRecorder(TrajectoryRecorder *recorder);
+
+    // Tick timing; disabled until profiler().enable()
+    TickProfiler &profiler()
+    {
+        return timing;
+    }
+
+    // Latest whole-swarm frame; a single consumer thread calls snapshot().acquire()
+    SwarmSnapshot &snapshot()
+    {
+        return frames;
+    }
+
+    // Fixed-step mode: run exactly `steps` ticks on the calling thread (plus the helper workers) and
+    // return how many ran; fewer only if stop() was called meanwhile
+    std::size_t runSteps(std::size_t steps);
+
+    // Pool lifetime. start() after stop() waits for the stopped threads (as join() would) and restarts.
+    void start();
+    void stop();
+    void join();
+
+    std::size_t size();
+    unsigned long long tickCount();
+    unsigned workerCount() const
+    {
+        return numWorkers;
+    }
+
+  private:
+    struct Tick
+    {
+        float dt;
+        clock::time_point now;
+        unsigned long long index;
+        bool fixedStep;
+    };
+
+    void startHelpersLocked();
+    void joinLocked();
+    void tickLoop();
+    void workerLoop(unsigned index, unsigned long long firstGeneration);
+    bool runTick(const Tick &tick);
+    void resolveCollisions();
+    void publishFrame(const Tick &tick);
+    void recordFrame(const Tick &tick, double time);
+    void stepPartition(unsigned index, const Tick &tick);
+
+    const unsigned numWorkers;
+    const std::chrono::microseconds tickPeriod;
+
+    // Registered UAVs and the tick counter; guarded by membersMtx, which a tick holds for its whole duration
+    std::mutex membersMtx;
+    std::vector<ECE_UAV *> members;
+    unsigned long long ticks = 0;
+    float fixedDt = 0.01f;
+    std::atomic<bool> fixedStep{false};
+
+    // Collision pass scratch; guarded by membersMtx
+    bool collisionsEnabled = true;
+    SpatialHash broadphase;
+    std::vector<ECE_UAV *> contactUavs;
+    std::vector<float> contactX, contactY, contactZ;
+    std::vector<ContactPair> contacts;
+    BulletScene *scene = NULL;
+    std::vector<ObstacleContact> obstacleHits;
+
+    // Attached recorder and the drone of each of its rows (empty until the first frame); guarded by
+    // membersMtx
+    TrajectoryRecorder *recorder = NULL;
+    std::vector<ECE_UAV *> recordRows;
+    bool recordEnded = false;
+
+    // Written by the tick thread only
+    SwarmSnapshot frames;
+    const clock::time_point epoch;
+
+    // One slot per thread, indexed like the partitions
+    TickProfiler timing;
+
+    // Tick hand-off between the tick thread and the helper workers
+    std::mutex jobMtx;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    unsigned long long generation = 0;
+    unsigned pending = 0;
+    Tick job{};
+    bool quit = false;
+
+    std::mutex lifecycleMtx;
+    bool helpersRunning = false;
+    std::thread ticker;
+    std::vector<std::thread> helpers;
+};
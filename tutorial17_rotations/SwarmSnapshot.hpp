@@ -0,0 +1,56 @@
+#pragma once
+// SwarmSnapshot.hpp  -- lock-free triple buffer that hands whole-swarm frames from physics to the renderer
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// One consistent picture of the swarm after a physics tick
+struct SwarmFrame
+{
+    unsigned long long tick = 0;
+    double time = 0.0; // simulated seconds (fixed step) or wall seconds since the first tick (real time)
+    std::vector<std::uint32_t> ids; // ECE_UAV::id of each entry
+    std::vector<glm::vec3> positions;
+    float size = 0.0f; // largest ECE_UAV::size_m: every entry fits in a cube of this edge around its position
+};
+
+// Single producer (the physics tick), single consumer (the render loop). The producer fills the back
+// buffer and swaps it with the middle one in a single atomic exchange; the consumer swaps the middle
+// buffer with its front buffer only when a newer frame was published. Neither side ever blocks or takes
+// a lock, and the consumer always sees a complete frame. Buffers are reused, so steady-state publishing
+// does not allocate.
+class SwarmSnapshot
+{
+  public:
+    // Producer: frame to fill for the next publish()
+    SwarmFrame &back()
+    {
+        return buffers[backIndex];
+    }
+    // Producer: make the back buffer the latest frame
+    void publish()
+    {
+        backIndex = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Consumer: latest published frame (the previous one again if nothing new was published). The
+    // reference stays valid and unchanged until the next acquire().
+    const SwarmFrame &acquire()
+    {
+        if (middle.load(std::memory_order_relaxed) & freshBit)
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return buffers[frontIndex];
+    }
+
+  private:
+    static constexpr unsigned freshBit = 4;
+    static constexpr unsigned indexMask = 3;
+
+    SwarmFrame buffers[3];
+    std::atomic<unsigned> middle{1};
+    unsigned backIndex = 0;  // producer only
+    unsigned frontIndex = 2; // consumer only
+};
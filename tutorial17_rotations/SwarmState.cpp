@@ -0,0 +1,833 @@
+// SwarmState.cpp  -- structure-of-arrays swarm store and the vectorized ECE_UAV physics kernel
+
+#include "SwarmState.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SWARM_HAVE_SSE2 1
+#endif
+
+#include "ECE_UAV.hpp"
+
+void SwarmState::reserve(std::size_t n)
+{
+    for (auto *v : {&px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &mass, &maxForce, &gravity, &ascendX, &ascendY,
+                    &ascendZ, &centerX, &centerY, &centerZ, &sphereRadius, &waitSeconds, &maxAscendSpeed,
+                    &minTangentialSpeed, &maxTangentialSpeed, &startTime})
+        v->reserve(n);
+    rngState.reserve(n);
+}
+
+void SwarmState::resize(std::size_t n)
+{
+    for (auto *v : {&px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &mass, &maxForce, &gravity, &ascendX, &ascendY,
+                    &ascendZ, &centerX, &centerY, &centerZ, &sphereRadius, &waitSeconds, &maxAscendSpeed,
+                    &minTangentialSpeed, &maxTangentialSpeed, &startTime})
+        v->resize(n);
+    rngState.resize(n);
+}
+
+void SwarmState::clear()
+{
+    for (auto *v : {&px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &mass, &maxForce, &gravity, &ascendX, &ascendY,
+                    &ascendZ, &centerX, &centerY, &centerZ, &sphereRadius, &waitSeconds, &maxAscendSpeed,
+                    &minTangentialSpeed, &maxTangentialSpeed, &startTime})
+        v->clear();
+    rngState.clear();
+}
+
+std::size_t SwarmState::add(const ECE_UAV &uav, float startedAt)
+{
+    std::size_t index = add(uav, uav.position, 0, startedAt);
+    vx[index] = uav.velocity.x;
+    vy[index] = uav.velocity.y;
+    vz[index] = uav.velocity.z;
+    ax[index] = uav.acceleration.x;
+    ay[index] = uav.acceleration.y;
+    az[index] = uav.acceleration.z;
+    rngState[index] = uav.rng.state;
+    return index;
+}
+
+std::size_t SwarmState::add(const ECE_UAV &prototype, const glm::vec3 &startPos, std::uint32_t seed, float startedAt)
+{
+    px.push_back(startPos.x);
+    py.push_back(startPos.y);
+    pz.push_back(startPos.z);
+    vx.push_back(0.0f);
+    vy.push_back(0.0f);
+    vz.push_back(0.0f);
+    ax.push_back(0.0f);
+    ay.push_back(0.0f);
+    az.push_back(0.0f);
+
+    mass.push_back(prototype.mass);
+    maxForce.push_back(prototype.maxForce);
+    gravity.push_back(prototype.gravity);
+    ascendX.push_back(prototype.ascendTarget.x);
+    ascendY.push_back(prototype.ascendTarget.y);
+    ascendZ.push_back(prototype.ascendTarget.z);
+    centerX.push_back(prototype.sphereCenter.x);
+    centerY.push_back(prototype.sphereCenter.y);
+    centerZ.push_back(prototype.sphereCenter.z);
+    sphereRadius.push_back(prototype.sphereRadius);
+    waitSeconds.push_back(prototype.waitSeconds);
+    maxAscendSpeed.push_back(prototype.maxAscendSpeed);
+    minTangentialSpeed.push_back(prototype.minTangentialSpeed);
+    maxTangentialSpeed.push_back(prototype.maxTangentialSpeed);
+    startTime.push_back(startedAt);
+
+    rngState.push_back(SwarmRng(seed).state);
+    return px.size() - 1;
+}
+
+namespace
+{
+
+// Cephes-style single precision sincos shared by every lane type: reduce by pi/4 in three parts, then
+// a degree 7 sine / degree 8 cosine polynomial. Max error ~1 ulp for |x| < 8192, far beyond the angles
+// the roaming law produces. Using it for the scalar lane too keeps stepSwarm bit-identical whichever
+// SIMD width it was built with.
+template <class L> static void laneSincos(typename L::F x, typename L::F &s, typename L::F &c)
+{
+    using F = typename L::F;
+    using I = typename L::I;
+
+    F ax = L::abs(x);
+    typename L::M sinNegative = L::lt(x, L::set1(0.0f));
+
+    I j = L::toInt(L::mul(ax, L::set1(1.27323954473516f))); // 4 / pi
+    j = L::iand(L::iadd(j, L::set1i(1)), L::set1i(~1));
+    F y = L::toFloat(j);
+
+    F r = L::sub(ax, L::mul(y, L::set1(0.78515625f)));
+    r = L::sub(r, L::mul(y, L::set1(2.4187564849853515625e-4f)));
+    r = L::sub(r, L::mul(y, L::set1(3.77489497744594108e-8f)));
+    F z = L::mul(r, r);
+
+    F pc = L::set1(2.443315711809948e-5f);
+    pc = L::add(L::mul(pc, z), L::set1(-1.388731625493765e-3f));
+    pc = L::add(L::mul(pc, z), L::set1(4.166664568298827e-2f));
+    pc = L::mul(L::mul(pc, z), z);
+    pc = L::sub(pc, L::mul(z, L::set1(0.5f)));
+    pc = L::add(pc, L::set1(1.0f));
+
+    F ps = L::set1(-1.9515295891e-4f);
+    ps = L::add(L::mul(ps, z), L::set1(8.3321608736e-3f));
+    ps = L::add(L::mul(ps, z), L::set1(-1.6666654611e-1f));
+    ps = L::mul(L::mul(ps, z), r);
+    ps = L::add(ps, r);
+
+    // octant selects which polynomial is sine and the sign of each result
+    typename L::M swap = L::ineqZero(L::iand(j, L::set1i(2)));
+    typename L::M sinFlip = L::mxor(sinNegative, L::ineqZero(L::iand(j, L::set1i(4))));
+    typename L::M cosFlip = L::ieqZero(L::iand(L::isub(j, L::set1i(2)), L::set1i(4)));
+
+    F sv = L::select(swap, pc, ps);
+    F cv = L::select(swap, ps, pc);
+    s = L::select(sinFlip, L::neg(sv), sv);
+    c = L::select(cosFlip, L::neg(cv), cv);
+}
+
+// Lane types. The kernel below is written once against this small interface and instantiated for
+// one drone at a time (Scalar), 4 drones (Sse2) or 8 drones (Avx2). Functions rather than operators,
+// since MSVC has no operator overloads on __m128/__m256.
+
+struct ScalarLane
+{
+    using F = float;
+    using U = std::uint32_t;
+    using I = std::int32_t;
+    using M = bool;
+    static constexpr std::size_t width = 1;
+
+    static F load(const float *p)
+    {
+        return *p;
+    }
+    static void store(float *p, F v)
+    {
+        *p = v;
+    }
+    static U loadU(const std::uint32_t *p)
+    {
+        return *p;
+    }
+    static void storeU(std::uint32_t *p, U v)
+    {
+        *p = v;
+    }
+    static F set1(float v)
+    {
+        return v;
+    }
+    static F add(F a, F b)
+    {
+        return a + b;
+    }
+    static F sub(F a, F b)
+    {
+        return a - b;
+    }
+    static F mul(F a, F b)
+    {
+        return a * b;
+    }
+    static F div(F a, F b)
+    {
+        return a / b;
+    }
+    static F sqrt(F a)
+    {
+        return std::sqrt(a);
+    }
+    // operand order matches minps/maxps so NaN and signed zero resolve the same way in every lane type
+    static F min(F a, F b)
+    {
+        return a < b ? a : b;
+    }
+    static F max(F a, F b)
+    {
+        return a > b ? a : b;
+    }
+    static F abs(F a)
+    {
+        return std::abs(a);
+    }
+    static M lt(F a, F b)
+    {
+        return a < b;
+    }
+    static M le(F a, F b)
+    {
+        return a <= b;
+    }
+    static M gt(F a, F b)
+    {
+        return a > b;
+    }
+    static M andNot(M a, M b) // !a && b
+    {
+        return !a && b;
+    }
+    static M orM(M a, M b)
+    {
+        return a || b;
+    }
+    static M notM(M a)
+    {
+        return !a;
+    }
+    static F select(M m, F a, F b)
+    {
+        return m ? a : b;
+    }
+    static U selectU(M m, U a, U b)
+    {
+        return m ? a : b;
+    }
+    static bool any(M m)
+    {
+        return m;
+    }
+    static bool all(M m)
+    {
+        return m;
+    }
+    static F neg(F a)
+    {
+        return -a;
+    }
+    static M mxor(M a, M b)
+    {
+        return a != b;
+    }
+    static I set1i(int v)
+    {
+        return v;
+    }
+    static I toInt(F a)
+    {
+        return static_cast<I>(a);
+    }
+    static F toFloat(I a)
+    {
+        return static_cast<F>(a);
+    }
+    static I iand(I a, I b)
+    {
+        return a & b;
+    }
+    static I iadd(I a, I b)
+    {
+        return a + b;
+    }
+    static I isub(I a, I b)
+    {
+        return a - b;
+    }
+    static M ieqZero(I a)
+    {
+        return a == 0;
+    }
+    static M ineqZero(I a)
+    {
+        return a != 0;
+    }
+    static void sincos(F x, F &s, F &c)
+    {
+        laneSincos<ScalarLane>(x, s, c);
+    }
+    // xorshift32 step + [0,1) conversion, identical to SwarmRng::next01
+    static F next01(U &state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+#if defined(SWARM_HAVE_SSE2)
+struct Sse2Lane
+{
+    using F = __m128;
+    using U = __m128i;
+    using I = __m128i;
+    using M = __m128;
+    static constexpr std::size_t width = 4;
+
+    static F load(const float *p)
+    {
+        return _mm_loadu_ps(p);
+    }
+    static void store(float *p, F v)
+    {
+        _mm_storeu_ps(p, v);
+    }
+    static U loadU(const std::uint32_t *p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    static void storeU(std::uint32_t *p, U v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+    static F set1(float v)
+    {
+        return _mm_set1_ps(v);
+    }
+    static F add(F a, F b)
+    {
+        return _mm_add_ps(a, b);
+    }
+    static F sub(F a, F b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+    static F mul(F a, F b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+    static F div(F a, F b)
+    {
+        return _mm_div_ps(a, b);
+    }
+    static F sqrt(F a)
+    {
+        return _mm_sqrt_ps(a);
+    }
+    static F min(F a, F b)
+    {
+        return _mm_min_ps(a, b);
+    }
+    static F max(F a, F b)
+    {
+        return _mm_max_ps(a, b);
+    }
+    static F abs(F a)
+    {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+    }
+    static F neg(F a)
+    {
+        return _mm_xor_ps(_mm_set1_ps(-0.0f), a);
+    }
+    static M lt(F a, F b)
+    {
+        return _mm_cmplt_ps(a, b);
+    }
+    static M le(F a, F b)
+    {
+        return _mm_cmple_ps(a, b);
+    }
+    static M gt(F a, F b)
+    {
+        return _mm_cmpgt_ps(a, b);
+    }
+    static M andNot(M a, M b)
+    {
+        return _mm_andnot_ps(a, b);
+    }
+    static M orM(M a, M b)
+    {
+        return _mm_or_ps(a, b);
+    }
+    static M notM(M a)
+    {
+        return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+    }
+    static M mxor(M a, M b)
+    {
+        return _mm_xor_ps(a, b);
+    }
+    static F select(M m, F a, F b)
+    {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    static U selectU(M m, U a, U b)
+    {
+        __m128i mi = _mm_castps_si128(m);
+        return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+    }
+    static bool any(M m)
+    {
+        return _mm_movemask_ps(m) != 0;
+    }
+    static bool all(M m)
+    {
+        return _mm_movemask_ps(m) == 0xF;
+    }
+
+    static I set1i(int v)
+    {
+        return _mm_set1_epi32(v);
+    }
+    static I toInt(F a)
+    {
+        return _mm_cvttps_epi32(a);
+    }
+    static F toFloat(I a)
+    {
+        return _mm_cvtepi32_ps(a);
+    }
+    static I iand(I a, I b)
+    {
+        return _mm_and_si128(a, b);
+    }
+    static I iadd(I a, I b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+    static I isub(I a, I b)
+    {
+        return _mm_sub_epi32(a, b);
+    }
+    static M ieqZero(I a)
+    {
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128()));
+    }
+    static M ineqZero(I a)
+    {
+        return notM(ieqZero(a));
+    }
+    static void sincos(F x, F &s, F &c)
+    {
+        laneSincos<Sse2Lane>(x, s, c);
+    }
+    static F next01(U &state)
+    {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+struct Avx2Lane
+{
+    using F = __m256;
+    using U = __m256i;
+    using I = __m256i;
+    using M = __m256;
+    static constexpr std::size_t width = 8;
+
+    static F load(const float *p)
+    {
+        return _mm256_loadu_ps(p);
+    }
+    static void store(float *p, F v)
+    {
+        _mm256_storeu_ps(p, v);
+    }
+    static U loadU(const std::uint32_t *p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static void storeU(std::uint32_t *p, U v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+    static F set1(float v)
+    {
+        return _mm256_set1_ps(v);
+    }
+    static F add(F a, F b)
+    {
+        return _mm256_add_ps(a, b);
+    }
+    static F sub(F a, F b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+    static F mul(F a, F b)
+    {
+        return _mm256_mul_ps(a, b);
+    }
+    static F div(F a, F b)
+    {
+        return _mm256_div_ps(a, b);
+    }
+    static F sqrt(F a)
+    {
+        return _mm256_sqrt_ps(a);
+    }
+    static F min(F a, F b)
+    {
+        return _mm256_min_ps(a, b);
+    }
+    static F max(F a, F b)
+    {
+        return _mm256_max_ps(a, b);
+    }
+    static F abs(F a)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a);
+    }
+    static F neg(F a)
+    {
+        return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a);
+    }
+    static M lt(F a, F b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    static M le(F a, F b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+    }
+    static M gt(F a, F b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    }
+    static M andNot(M a, M b)
+    {
+        return _mm256_andnot_ps(a, b);
+    }
+    static M orM(M a, M b)
+    {
+        return _mm256_or_ps(a, b);
+    }
+    static M notM(M a)
+    {
+        return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+    }
+    static M mxor(M a, M b)
+    {
+        return _mm256_xor_ps(a, b);
+    }
+    static F select(M m, F a, F b)
+    {
+        return _mm256_blendv_ps(b, a, m);
+    }
+    static U selectU(M m, U a, U b)
+    {
+        return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m));
+    }
+    static bool any(M m)
+    {
+        return _mm256_movemask_ps(m) != 0;
+    }
+    static bool all(M m)
+    {
+        return _mm256_movemask_ps(m) == 0xFF;
+    }
+
+    static I set1i(int v)
+    {
+        return _mm256_set1_epi32(v);
+    }
+    static I toInt(F a)
+    {
+        return _mm256_cvttps_epi32(a);
+    }
+    static F toFloat(I a)
+    {
+        return _mm256_cvtepi32_ps(a);
+    }
+    static I iand(I a, I b)
+    {
+        return _mm256_and_si256(a, b);
+    }
+    static I iadd(I a, I b)
+    {
+        return _mm256_add_epi32(a, b);
+    }
+    static I isub(I a, I b)
+    {
+        return _mm256_sub_epi32(a, b);
+    }
+    static M ieqZero(I a)
+    {
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()));
+    }
+    static M ineqZero(I a)
+    {
+        return notM(ieqZero(a));
+    }
+    static void sincos(F x, F &s, F &c)
+    {
+        laneSincos<Avx2Lane>(x, s, c);
+    }
+    static F next01(U &state)
+    {
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+        state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+        state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(state, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+    }
+};
+#endif
+
+template <class L> struct Vec3
+{
+    typename L::F x, y, z;
+};
+
+template <class L> static typename L::F dot3(const Vec3<L> &a, const Vec3<L> &b)
+{
+    // same association as glm::dot: (x + y) + z
+    return L::add(L::add(L::mul(a.x, b.x), L::mul(a.y, b.y)), L::mul(a.z, b.z));
+}
+
+template <class L> static Vec3<L> scale3(const Vec3<L> &a, typename L::F s)
+{
+    return {L::mul(a.x, s), L::mul(a.y, s), L::mul(a.z, s)};
+}
+
+template <class L> static Vec3<L> normalize3(const Vec3<L> &a)
+{
+    // glm::normalize: v * (1 / sqrt(dot(v, v)))
+    return scale3<L>(a, L::div(L::set1(1.0f), L::sqrt(dot3<L>(a, a))));
+}
+
+template <class L> static Vec3<L> clampMagnitude3(const Vec3<L> &v, typename L::F maxLen)
+{
+    typename L::F len2 = dot3<L>(v, v);
+    typename L::M over = L::gt(len2, L::mul(maxLen, maxLen));
+    typename L::F k = L::mul(maxLen, L::div(L::set1(1.0f), L::sqrt(len2)));
+    return {L::select(over, L::mul(v.x, k), v.x), L::select(over, L::mul(v.y, k), v.y),
+            L::select(over, L::mul(v.z, k), v.z)};
+}
+
+// ECE_UAV::updatePhysics for L::width drones starting at index i. Every branch of the scalar state
+// machine becomes a lane mask; a phase is only evaluated when at least one lane is in it.
+template <class L> static void stepBlock(SwarmState &s, std::size_t i, float dtValue, float simTime)
+{
+    using F = typename L::F;
+    using M = typename L::M;
+
+    static const float radialK = 50.0f;
+    static const float dampingK = 5.0f;
+
+    const F zero = L::set1(0.0f);
+    const F dt = L::set1(dtValue);
+    const F dtSafe = L::set1(std::max(dtValue, 1e-4f));
+
+    Vec3<L> p = {L::load(&s.px[i]), L::load(&s.py[i]), L::load(&s.pz[i])};
+    Vec3<L> v = {L::load(&s.vx[i]), L::load(&s.vy[i]), L::load(&s.vz[i])};
+
+    F elapsed = L::sub(L::set1(simTime), L::load(&s.startTime[i]));
+    M resting = L::lt(elapsed, L::load(&s.waitSeconds[i]));
+    F restZ = L::max(p.z, zero);
+
+    if (L::all(resting))
+    {
+        L::store(&s.pz[i], restZ);
+        L::store(&s.vx[i], zero);
+        L::store(&s.vy[i], zero);
+        L::store(&s.vz[i], zero);
+        L::store(&s.ax[i], zero);
+        L::store(&s.ay[i], zero);
+        L::store(&s.az[i], zero);
+        return;
+    }
+
+    F mass = L::load(&s.mass[i]);
+    F maxForce = L::load(&s.maxForce[i]);
+    F gravity = L::load(&s.gravity[i]);
+    F radius = L::load(&s.sphereRadius[i]);
+
+    Vec3<L> toAscend = {L::sub(L::load(&s.ascendX[i]), p.x), L::sub(L::load(&s.ascendY[i]), p.y),
+                        L::sub(L::load(&s.ascendZ[i]), p.z)};
+    F distToAscend = L::sqrt(dot3<L>(toAscend, toAscend));
+
+    M inSphere = L::andNot(resting, L::le(distToAscend, L::add(radius, L::set1(0.5f))));
+    M ascending = L::notM(L::orM(resting, inSphere));
+
+    Vec3<L> force = {zero, zero, zero};
+
+    if (L::any(ascending))
+    {
+        M far = L::gt(distToAscend, L::set1(1e-6f));
+        Vec3<L> dir = {L::select(far, L::div(toAscend.x, distToAscend), zero),
+                       L::select(far, L::div(toAscend.y, distToAscend), zero),
+                       L::select(far, L::div(toAscend.z, distToAscend), L::set1(1.0f))};
+        Vec3<L> vDes = scale3<L>(dir, L::load(&s.maxAscendSpeed[i]));
+        Vec3<L> aDes = {L::div(L::sub(vDes.x, v.x), dtSafe), L::div(L::sub(vDes.y, v.y), dtSafe),
+                        L::div(L::sub(vDes.z, v.z), dtSafe)};
+        // m * a_des - gravityForce, gravityForce = (0, 0, -g)
+        Vec3<L> req = {L::mul(mass, aDes.x), L::mul(mass, aDes.y), L::add(L::mul(mass, aDes.z), gravity)};
+        req = clampMagnitude3<L>(req, maxForce);
+
+        force.x = L::select(ascending, req.x, force.x);
+        force.y = L::select(ascending, req.y, force.y);
+        force.z = L::select(ascending, req.z, force.z);
+    }
+
+    if (L::any(inSphere))
+    {
+        Vec3<L> rel = {L::sub(p.x, L::load(&s.centerX[i])), L::sub(p.y, L::load(&s.centerY[i])),
+                       L::sub(p.z, L::load(&s.centerZ[i]))};
+        F r = L::sqrt(dot3<L>(rel, rel));
+        M degenerate = L::lt(r, L::set1(1e-6f));
+        rel.x = L::select(degenerate, zero, rel.x);
+        rel.y = L::select(degenerate, zero, rel.y);
+        rel.z = L::select(degenerate, radius, rel.z);
+        r = L::select(degenerate, radius, r);
+
+        Vec3<L> radialDir = {L::div(rel.x, r), L::div(rel.y, r), L::div(rel.z, r)};
+        F radialError = L::sub(r, radius);
+        Vec3<L> radialForce = scale3<L>(radialDir, L::mul(L::set1(-radialK), radialError));
+
+        Vec3<L> vRadial = scale3<L>(radialDir, dot3<L>(v, radialDir));
+        Vec3<L> vTangential = {L::sub(v.x, vRadial.x), L::sub(v.y, vRadial.y), L::sub(v.z, vRadial.z)};
+
+        // one draw per roaming step, and only for the lanes that are roaming
+        typename L::U rng = L::loadU(&s.rngState[i]);
+        typename L::U advanced = rng;
+        F rand01 = L::next01(advanced);
+        L::storeU(&s.rngState[i], L::selectU(inSphere, advanced, rng));
+
+        F minT = L::load(&s.minTangentialSpeed[i]);
+        F maxT = L::load(&s.maxTangentialSpeed[i]);
+        F vTarget = L::min(L::max(L::add(minT, L::mul(rand01, L::sub(maxT, minT))), minT), maxT);
+
+        // tangent1 = normalize(cross(radialDir, z)) or normalize(cross(radialDir, y)) near the poles
+        M awayFromPole = L::lt(L::abs(radialDir.z), L::set1(0.9f));
+        Vec3<L> t1 = {L::select(awayFromPole, radialDir.y, L::sub(zero, radialDir.z)),
+                      L::select(awayFromPole, L::sub(zero, radialDir.x), zero),
+                      L::select(awayFromPole, zero, radialDir.x)};
+        t1 = normalize3<L>(t1);
+        Vec3<L> c = {L::sub(L::mul(radialDir.y, t1.z), L::mul(t1.y, radialDir.z)),
+                     L::sub(L::mul(radialDir.z, t1.x), L::mul(t1.z, radialDir.x)),
+                     L::sub(L::mul(radialDir.x, t1.y), L::mul(t1.x, radialDir.y))};
+        Vec3<L> t2 = normalize3<L>(c);
+
+        F ang = L::add(L::mul(elapsed, L::set1(0.5f)), L::mul(rand01, L::set1(3.14f)));
+        F sinA, cosA;
+        L::sincos(ang, sinA, cosA);
+        Vec3<L> desiredDir = {L::add(L::mul(cosA, t1.x), L::mul(sinA, t2.x)),
+                              L::add(L::mul(cosA, t1.y), L::mul(sinA, t2.y)),
+                              L::add(L::mul(cosA, t1.z), L::mul(sinA, t2.z))};
+        desiredDir = normalize3<L>(desiredDir);
+        Vec3<L> vtDes = scale3<L>(desiredDir, vTarget);
+
+        Vec3<L> aT = {L::div(L::sub(vtDes.x, vTangential.x), dtSafe), L::div(L::sub(vtDes.y, vTangential.y), dtSafe),
+                      L::div(L::sub(vtDes.z, vTangential.z), dtSafe)};
+        Vec3<L> damping = scale3<L>(vTangential, L::set1(-dampingK));
+
+        // m * a_t + m * damping + radialForce - gravityForce
+        Vec3<L> req = {L::add(L::add(L::mul(mass, aT.x), L::mul(mass, damping.x)), radialForce.x),
+                       L::add(L::add(L::mul(mass, aT.y), L::mul(mass, damping.y)), radialForce.y),
+                       L::add(L::add(L::add(L::mul(mass, aT.z), L::mul(mass, damping.z)), radialForce.z), gravity)};
+        req = clampMagnitude3<L>(req, maxForce);
+
+        force.x = L::select(inSphere, req.x, force.x);
+        force.y = L::select(inSphere, req.y, force.y);
+        force.z = L::select(inSphere, req.z, force.z);
+    }
+
+    // constant-acceleration integration: x = x0 + v0 t + a t^2 / 2, v = v0 + a t
+    Vec3<L> acc = {L::div(force.x, mass), L::div(force.y, mass), L::div(force.z, mass)};
+    Vec3<L> newPos = {L::add(L::add(p.x, L::mul(v.x, dt)), L::mul(L::mul(L::mul(L::set1(0.5f), acc.x), dt), dt)),
+                      L::add(L::add(p.y, L::mul(v.y, dt)), L::mul(L::mul(L::mul(L::set1(0.5f), acc.y), dt), dt)),
+                      L::add(L::add(p.z, L::mul(v.z, dt)), L::mul(L::mul(L::mul(L::set1(0.5f), acc.z), dt), dt))};
+    Vec3<L> newVel = {L::add(v.x, L::mul(acc.x, dt)), L::add(v.y, L::mul(acc.y, dt)), L::add(v.z, L::mul(acc.z, dt))};
+
+    // ground clamp
+    M belowGround = L::lt(newPos.z, zero);
+    newPos.z = L::select(belowGround, zero, newPos.z);
+    newVel.z = L::select(belowGround, zero, newVel.z);
+
+    // resting lanes keep x/y, clamp z to the ground and zero their motion
+    L::store(&s.px[i], L::select(resting, p.x, newPos.x));
+    L::store(&s.py[i], L::select(resting, p.y, newPos.y));
+    L::store(&s.pz[i], L::select(resting, restZ, newPos.z));
+    L::store(&s.vx[i], L::select(resting, zero, newVel.x));
+    L::store(&s.vy[i], L::select(resting, zero, newVel.y));
+    L::store(&s.vz[i], L::select(resting, zero, newVel.z));
+    L::store(&s.ax[i], L::select(resting, zero, acc.x));
+    L::store(&s.ay[i], L::select(resting, zero, acc.y));
+    L::store(&s.az[i], L::select(resting, zero, acc.z));
+}
+
+} // namespace
+
+void stepSwarmScalar(SwarmState &state, std::size_t begin, std::size_t end, float dt, float simTime)
+{
+    for (std::size_t i = begin; i < end; ++i)
+        stepBlock<ScalarLane>(state, i, dt, simTime);
+}
+
+void stepSwarm(SwarmState &state, std::size_t begin, std::size_t end, float dt, float simTime)
+{
+    std::size_t i = begin;
+#if defined(__AVX2__)
+    for (; i + Avx2Lane::width <= end; i += Avx2Lane::width)
+        stepBlock<Avx2Lane>(state, i, dt, simTime);
+#elif defined(SWARM_HAVE_SSE2)
+    for (; i + Sse2Lane::width <= end; i += Sse2Lane::width)
+        stepBlock<Sse2Lane>(state, i, dt, simTime);
+#endif
+    stepSwarmScalar(state, i, end, dt, simTime);
+}
+
+const char *swarmKernelName()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(SWARM_HAVE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+std::size_t swarmKernelWidth()
+{
+#if defined(__AVX2__)
+    return Avx2Lane::width;
+#elif defined(SWARM_HAVE_SSE2)
+    return Sse2Lane::width;
+#else
+    return ScalarLane::width;
+#endif
+}
@@ -0,0 +1,100 @@
+#pragma once
+// SwarmState.hpp  -- structure-of-arrays swarm store and the vectorized ECE_UAV physics kernel
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct ECE_UAV;
+
+// One contiguous float array per component, so the kernel streams through memory with unit-stride
+// SIMD loads instead of hopping between ~5 KB ECE_UAV objects. Index i across every array is drone i.
+struct SwarmState
+{
+    // Kinematic state
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> ax, ay, az;
+
+    // Per-drone parameters (same meaning as the ECE_UAV members of the same name)
+    std::vector<float> mass;
+    std::vector<float> maxForce;
+    std::vector<float> gravity;
+    std::vector<float> ascendX, ascendY, ascendZ; // ascendTarget
+    std::vector<float> centerX, centerY, centerZ; // sphereCenter
+    std::vector<float> sphereRadius;
+    std::vector<float> waitSeconds;
+    std::vector<float> maxAscendSpeed;
+    std::vector<float> minTangentialSpeed;
+    std::vector<float> maxTangentialSpeed;
+    std::vector<float> startTime; // simulation time the drone was started at (seconds)
+
+    // SwarmRng state per drone
+    std::vector<std::uint32_t> rngState;
+
+    std::size_t size() const
+    {
+        return px.size();
+    }
+
+    void reserve(std::size_t n);
+    void resize(std::size_t n); // new drones are zero-filled; their parameters are the caller's to write
+    void clear();
+
+    // Append a drone with the kinematic state, parameters and RNG state of uav; returns its index
+    std::size_t add(const ECE_UAV &uav, float startedAt = 0.0f);
+    // Append a drone with prototype's parameters at startPos, at rest, with its own RNG seed
+    std::size_t add(const ECE_UAV &prototype, const glm::vec3 &startPos, std::uint32_t seed, float startedAt = 0.0f);
+
+    glm::vec3 position(std::size_t i) const
+    {
+        return glm::vec3(px[i], py[i], pz[i]);
+    }
+    glm::vec3 velocity(std::size_t i) const
+    {
+        return glm::vec3(vx[i], vy[i], vz[i]);
+    }
+    glm::vec3 acceleration(std::size_t i) const
+    {
+        return glm::vec3(ax[i], ay[i], az[i]);
+    }
+};
+
+// Branch of the control law a drone is in: on the ground until waitSeconds have passed, then climbing
+// toward ascendTarget until within sphereRadius + 0.5 m of it, then roaming the sphere
+enum FlightPhase : std::uint8_t
+{
+    PhaseResting = 0,
+    PhaseAscending = 1,
+    PhaseRoaming = 2
+};
+
+// The same tests stepSwarm and ECE_UAV::updatePhysics make
+inline FlightPhase flightPhase(float elapsedSinceStart, float waitSeconds, float distToAscend, float sphereRadius)
+{
+    if (elapsedSinceStart < waitSeconds)
+        return PhaseResting;
+    return distToAscend <= sphereRadius + 0.5f ? PhaseRoaming : PhaseAscending;
+}
+
+// Phase of drone i at simulation time simTime
+inline FlightPhase flightPhase(const SwarmState &s, std::size_t i, float simTime)
+{
+    const glm::vec3 toAscend = glm::vec3(s.ascendX[i], s.ascendY[i], s.ascendZ[i]) - s.position(i);
+    return flightPhase(simTime - s.startTime[i], s.waitSeconds[i], glm::length(toAscend), s.sphereRadius[i]);
+}
+
+// Advance drones [begin, end) by dt. simTime is the current simulation time; each drone's
+// elapsedSinceStart is simTime - startTime[i]. Uses the widest SIMD path compiled in (AVX2 when
+// built with -mavx2 / /arch:AVX2, else SSE2, else scalar) and the scalar path for the tail.
+void stepSwarm(SwarmState &state, std::size_t begin, std::size_t end, float dt, float simTime);
+
+// Same control law one drone at a time; the reference the SIMD paths are checked against
+void stepSwarmScalar(SwarmState &state, std::size_t begin, std::size_t end, float dt, float simTime);
+
+// "AVX2", "SSE2" or "scalar"
+const char *swarmKernelName();
+// Drones processed per SIMD iteration by stepSwarm
+std::size_t swarmKernelWidth();
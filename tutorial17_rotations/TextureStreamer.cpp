@@ -0,0 +1,266 @@
+// TextureStreamer.cpp  -- textures decoded and mipmapped on worker threads, uploaded through a ring of pixel
+// unpack buffers
+
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace
+{
+
+const unsigned kMaxDefaultWorkers = 4;
+const unsigned char kPlaceholder[4] = {128, 128, 128, 255};
+
+// One level down: each texel is the mean of the 2x2 block above it. An odd edge drops its last row or
+// column, as glGenerateMipmap's box filter does on most drivers.
+void downsample(const unsigned char *src, int width, int height, unsigned char *dst, int dstWidth, int dstHeight)
+{
+    for (int y = 0; y < dstHeight; ++y)
+    {
+        const unsigned char *row0 = src + static_cast<std::size_t>(std::min(2 * y, height - 1)) * width * 4;
+        const unsigned char *row1 = src + static_cast<std::size_t>(std::min(2 * y + 1, height - 1)) * width * 4;
+        unsigned char *out = dst + static_cast<std::size_t>(y) * dstWidth * 4;
+        for (int x = 0; x < dstWidth; ++x)
+        {
+            const int x0 = std::min(2 * x, width - 1) * 4, x1 = std::min(2 * x + 1, width - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                out[x * 4 + c] =
+                    static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+        }
+    }
+}
+
+} // namespace
+
+void TextureStreamer::create(unsigned workers)
+{
+    if (created)
+        return;
+    if (workers == 0)
+    {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        workers = std::max(1u, std::min(kMaxDefaultWorkers, hardware > 1 ? hardware - 1 : 1u));
+    }
+    for (Slot &slot : ring)
+        glGenBuffers(1, &slot.buffer);
+    stopping = false;
+    for (unsigned i = 0; i < workers; ++i)
+        threads.emplace_back(&TextureStreamer::work, this);
+    created = true;
+}
+
+void TextureStreamer::destroy()
+{
+    if (!created)
+        return;
+    stopWorkers();
+    done.clear();
+    outstanding = 0;
+    uploading = Decoded();
+
+    for (Slot &slot : ring)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+        slot = Slot();
+    }
+    created = false;
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    stopWorkers();
+}
+
+void TextureStreamer::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread &t : threads)
+        t.join();
+    threads.clear();
+}
+
+GLuint TextureStreamer::request(const char *path, bool flipVertically)
+{
+    if (!created)
+        return 0;
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, kPlaceholder);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(Job{texture, path, flipVertically});
+        ++outstanding;
+    }
+    wake.notify_one();
+    return texture;
+}
+
+TextureStreamer::Slot *TextureStreamer::freeSlot()
+{
+    Slot &slot = ring[ringNext];
+    if (slot.fence)
+    {
+        // zero timeout: a busy buffer means try again next frame, never wait here
+        const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+            return NULL;
+        glDeleteSync(slot.fence);
+        slot.fence = 0;
+    }
+    ringNext = (ringNext + 1) % kRingSlots;
+    return &slot;
+}
+
+std::size_t TextureStreamer::update(std::size_t byteBudget)
+{
+    if (!created)
+        return 0;
+    std::size_t uploaded = 0;
+    bool bound = false;
+    while (uploaded < byteBudget || uploaded == 0)
+    {
+        if (uploading.next == 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done.empty())
+                break;
+            uploading = std::move(done.front());
+            done.pop_front();
+            if (!uploading.ok)
+            {
+                --outstanding;
+                continue;
+            }
+        }
+
+        Slot *slot = freeSlot();
+        if (!slot)
+            break;
+        const std::size_t level = uploading.next - 1;
+        const Level &l = uploading.levels[level];
+        const std::size_t bytes = static_cast<std::size_t>(l.width) * l.height * 4;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->buffer);
+        bound = true;
+        if (slot->capacity < bytes)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            slot->capacity = bytes;
+        }
+        // the fence says the GPU is done with this buffer, so no implicit synchronisation is needed
+        void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!dst)
+        {
+            fprintf(stderr, "TextureStreamer: cannot map an unpack buffer of %zu bytes\n", bytes);
+            break;
+        }
+        memcpy(dst, uploading.pixels.data() + l.offset, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glBindTexture(GL_TEXTURE_2D, uploading.texture);
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, l.width, l.height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, (void *)0);
+        if (level + 1 == uploading.levels.size())
+        {
+            // first (coarsest) real level: from here on the texture samples the image, not the placeholder
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(level));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level));
+        slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        uploaded += bytes;
+
+        if (--uploading.next == 0)
+        {
+            uploading = Decoded();
+            std::lock_guard<std::mutex> lock(mutex);
+            --outstanding;
+        }
+    }
+    if (bound)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    return uploaded;
+}
+
+std::size_t TextureStreamer::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return outstanding;
+}
+
+void TextureStreamer::work()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        Decoded d;
+        d.texture = job.texture;
+        // the per-thread flag: the global one would race with the other workers
+        stbi_set_flip_vertically_on_load_thread(job.flip);
+        int width = 0, height = 0, channels = 0;
+        unsigned char *image = stbi_load(job.path.c_str(), &width, &height, &channels, 4);
+        if (!image)
+        {
+            fprintf(stderr, "TextureStreamer: cannot decode %s: %s\n", job.path.c_str(), stbi_failure_reason());
+        }
+        else
+        {
+            // the whole chain down to 1x1, laid out finest first
+            std::size_t total = 0;
+            for (int w = width, h = height;; w = std::max(1, w / 2), h = std::max(1, h / 2))
+            {
+                d.levels.push_back(Level{total, w, h});
+                total += static_cast<std::size_t>(w) * h * 4;
+                if (w == 1 && h == 1)
+                    break;
+            }
+            d.pixels.resize(total);
+            memcpy(d.pixels.data(), image, static_cast<std::size_t>(width) * height * 4);
+            stbi_image_free(image);
+            for (std::size_t l = 1; l < d.levels.size(); ++l)
+            {
+                const Level &src = d.levels[l - 1], &dst = d.levels[l];
+                downsample(d.pixels.data() + src.offset, src.width, src.height, d.pixels.data() + dst.offset,
+                           dst.width, dst.height);
+            }
+            d.next = d.levels.size();
+            d.ok = true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping)
+            done.push_back(std::move(d));
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+// TextureStreamer.hpp  -- textures decoded and mipmapped on worker threads, uploaded through a ring of pixel
+// unpack buffers
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Textures requested by path come back as GL names at once, showing a 1x1 placeholder. Worker threads
+// read and decode the file with stb_image (as RGBA8) and build the whole mip chain with a box filter, so
+// several textures decode and mipmap side by side and the render thread never touches a file.
+//
+// update(), on the GL thread once a frame, copies finished levels into a ring of pixel unpack buffers and
+// has glTexImage2D source them from there, so the copy into the texture runs asynchronously on the GPU.
+// A buffer is reused only once the fence of its last upload has signalled; while all are busy, uploads
+// wait for a later frame instead of stalling. Levels go up coarsest first and each lowers
+// GL_TEXTURE_BASE_LEVEL to itself, so a texture sharpens as it arrives and is complete all along.
+class TextureStreamer
+{
+  public:
+    // Default upload budget per update(): a 1024 x 1024 RGBA level
+    static const std::size_t kDefaultBudget = std::size_t(4) << 20;
+
+    // Starts the workers (0: one per hardware thread beyond the first, at most 4) and the buffer ring;
+    // needs the GL context current
+    void create(unsigned workers = 0);
+    // Drops queued and unfinished work and waits for decodes in progress. Textures already handed out
+    // stay with the caller, as far as they got.
+    void destroy();
+    // Stops the workers if destroy() was not called; the GL objects are left to the context
+    ~TextureStreamer();
+
+    // A new texture name showing the placeholder until `path` has been decoded and uploaded. Rows are
+    // flipped on decode unless flipVertically is false (image files store the top row first, GL wants the
+    // bottom one). A file that cannot be decoded leaves the placeholder, with a message on stderr.
+    GLuint request(const char *path, bool flipVertically = true);
+
+    // Upload finished levels until about byteBudget bytes have gone (at least one level if any is ready)
+    // or no ring buffer is free. Returns the bytes uploaded. Leaves the unpack buffer and GL_TEXTURE_2D
+    // unbound.
+    std::size_t update(std::size_t byteBudget = kDefaultBudget);
+
+    // Textures requested and not yet fully uploaded
+    std::size_t pending();
+
+  private:
+    struct Job
+    {
+        GLuint texture;
+        std::string path;
+        bool flip;
+    };
+    struct Level
+    {
+        std::size_t offset; // into Decoded::pixels
+        int width, height;
+    };
+    struct Decoded
+    {
+        GLuint texture = 0;
+        bool ok = false;
+        std::vector<unsigned char> pixels; // every level, finest first, RGBA8 rows packed
+        std::vector<Level> levels;
+        std::size_t next = 0; // levels still to upload: [0, next)
+    };
+    struct Slot
+    {
+        GLuint buffer = 0;
+        std::size_t capacity = 0;
+        GLsync fence = 0;
+    };
+
+    static const int kRingSlots = 4;
+
+    void work();
+    void stopWorkers();
+    Slot *freeSlot();
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::deque<Decoded> done;
+    std::size_t outstanding = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    // GL thread only
+    Decoded uploading; // texture whose levels are going up, if uploading.next
+    Slot ring[kRingSlots];
+    int ringNext = 0;
+    bool created = false;
+};
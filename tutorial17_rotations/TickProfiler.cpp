@@ -0,0 +1,229 @@
+// TickProfiler.cpp  -- per-thread timing of SwarmScheduler ticks: latency histograms and a Chrome trace
+
+#include "TickProfiler.hpp"
+
+#include <algorithm>
+
+namespace
+{
+
+const char *const kMetricNames[MetricCount] = {"tick",    "update",   "barrier", "collisions",
+                                               "publish", "lateness", "jitter",  "lock_wait"};
+
+// Index of the highest set bit of v > 0
+int highestBit(std::uint64_t v)
+{
+    int bit = 0;
+    for (int shift = 32; shift > 0; shift /= 2)
+        if (v >> shift)
+        {
+            v >>= shift;
+            bit += shift;
+        }
+    return bit;
+}
+
+} // namespace
+
+const char *tickMetricName(TickMetric metric)
+{
+    return metric < MetricCount ? kMetricNames[metric] : "?";
+}
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t ns)
+{
+    const std::uint64_t kSub = std::uint64_t(1) << kSubBucketBits;
+    ns = std::min(ns, (std::uint64_t(1) << kMaxBits) - 1);
+    if (ns < kSub)
+        return static_cast<std::size_t>(ns);
+    // the top kSubBucketBits + 1 bits of the value: its octave, then where in the octave
+    const int shift = highestBit(ns) - kSubBucketBits;
+    return (static_cast<std::size_t>(shift + 1) << kSubBucketBits) + static_cast<std::size_t>((ns >> shift) - kSub);
+}
+
+std::uint64_t LatencyHistogram::bucketHigh(std::size_t bucket)
+{
+    const std::size_t kSub = std::size_t(1) << kSubBucketBits;
+    if (bucket < kSub)
+        return bucket;
+    const int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+    const std::uint64_t low = static_cast<std::uint64_t>((bucket & (kSub - 1)) + kSub) << shift;
+    return low + (std::uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::clear()
+{
+    std::fill(counts, counts + kBuckets, 0);
+    total = sum = 0;
+}
+
+void LatencyHistogram::add(std::uint64_t ns)
+{
+    ++counts[bucketOf(ns)];
+    ++total;
+    sum += ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (std::size_t b = 0; b < kBuckets; ++b)
+        counts[b] += other.counts[b];
+    total += other.total;
+    sum += other.sum;
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram &earlier)
+{
+    for (std::size_t b = 0; b < kBuckets; ++b)
+        counts[b] -= std::min(counts[b], earlier.counts[b]);
+    total -= std::min(total, earlier.total);
+    sum -= std::min(sum, earlier.sum);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const
+{
+    if (total == 0)
+        return 0;
+    const double wanted = std::max(1.0, std::min(q, 1.0) * static_cast<double>(total));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b)
+    {
+        seen += counts[b];
+        if (static_cast<double>(seen) >= wanted)
+            return bucketHigh(b);
+    }
+    return bucketHigh(kBuckets - 1);
+}
+
+void TickProfile::subtract(const TickProfile &earlier)
+{
+    for (int m = 0; m < MetricCount; ++m)
+        metrics[m].subtract(earlier.metrics[m]);
+}
+
+void TickProfile::print(FILE *out) const
+{
+    fprintf(out, "%-11s %10s %9s %9s %9s %9s %9s %9s\n", "metric (ms)", "count", "mean", "p50", "p90", "p99",
+            "p99.9", "max");
+    for (int m = 0; m < MetricCount; ++m)
+    {
+        const LatencyHistogram &h = metrics[m];
+        if (h.count() == 0)
+            continue;
+        fprintf(out, "%-11s %10llu %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", tickMetricName(TickMetric(m)),
+                static_cast<unsigned long long>(h.count()), h.mean() * 1e-6, h.percentile(0.5) * 1e-6,
+                h.percentile(0.9) * 1e-6, h.percentile(0.99) * 1e-6, h.percentile(0.999) * 1e-6, h.max() * 1e-6);
+    }
+}
+
+TickProfiler::TickProfiler(unsigned threads) : epoch(clock::now())
+{
+    // value-initialized: every counter starts at zero
+    for (unsigned t = 0; t < threads; ++t)
+        slots.push_back(std::unique_ptr<Slot>(new Slot()));
+}
+
+void TickProfiler::enable(std::size_t eventsPerThread)
+{
+    for (auto &slot : slots)
+    {
+        slot->events.assign(std::max<std::size_t>(eventsPerThread, 1), Event());
+        slot->written.store(0, std::memory_order_relaxed);
+    }
+    on.store(true);
+}
+
+void TickProfiler::disable()
+{
+    on.store(false);
+}
+
+void TickProfiler::add(Slot &slot, TickMetric metric, std::uint64_t ns)
+{
+    // single writer per slot: a plain load and store, which readers may see a moment late but never torn
+    std::atomic<std::uint64_t> &bucket = slot.counts[metric][LatencyHistogram::bucketOf(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.totals[metric].store(slot.totals[metric].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.sums[metric].store(slot.sums[metric].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+void TickProfiler::span(unsigned thread, TickMetric metric, clock::time_point begin, clock::time_point end,
+                        unsigned long long tick)
+{
+    if (thread >= slots.size())
+        return;
+    Slot &slot = *slots[thread];
+    const std::int64_t b = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch).count();
+    const std::int64_t d = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    const std::uint64_t ns = d > 0 ? static_cast<std::uint64_t>(d) : 0;
+    add(slot, metric, ns);
+
+    const std::uint64_t w = slot.written.load(std::memory_order_relaxed);
+    Event &e = slot.events[w % slot.events.size()];
+    e.begin = b;
+    e.duration = static_cast<std::uint32_t>(std::min<std::uint64_t>(ns, UINT32_MAX));
+    e.metric = metric;
+    e.tick = tick;
+    slot.written.store(w + 1, std::memory_order_release);
+}
+
+void TickProfiler::value(unsigned thread, TickMetric metric, std::uint64_t ns)
+{
+    if (thread < slots.size())
+        add(*slots[thread], metric, ns);
+}
+
+void TickProfiler::collect(TickProfile &out) const
+{
+    for (int m = 0; m < MetricCount; ++m)
+    {
+        LatencyHistogram &h = out.metrics[m];
+        h.clear();
+        for (const auto &slot : slots)
+        {
+            for (std::size_t b = 0; b < LatencyHistogram::kBuckets; ++b)
+                h.counts[b] += slot->counts[m][b].load(std::memory_order_relaxed);
+            h.total += slot->totals[m].load(std::memory_order_relaxed);
+            h.sum += slot->sums[m].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TickProfiler::writeChromeTrace(const char *path) const
+{
+    FILE *out = fopen(path, "w");
+    if (!out)
+    {
+        fprintf(stderr, "TickProfiler: cannot write %s\n", path);
+        return false;
+    }
+    // complete ("X") events in microseconds; a metadata event names each thread's track
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    bool first = true;
+    for (std::size_t t = 0; t < slots.size(); ++t)
+    {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", t, t == 0 ? "tick thread" : "worker");
+        first = false;
+
+        const Slot &slot = *slots[t];
+        const std::uint64_t written = slot.written.load(std::memory_order_acquire);
+        const std::uint64_t capacity = slot.events.size();
+        for (std::uint64_t i = written > capacity ? written - capacity : 0; i < written; ++i)
+        {
+            const Event &e = slot.events[i % capacity];
+            fprintf(out,
+                    ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"tick\":%llu}}",
+                    tickMetricName(TickMetric(e.metric)), t, e.begin * 1e-3, e.duration * 1e-3, e.tick);
+        }
+    }
+    fputs("\n]}\n", out);
+    const bool ok = !ferror(out);
+    if (fclose(out) != 0 || !ok)
+    {
+        fprintf(stderr, "TickProfiler: failed writing %s\n", path);
+        return false;
+    }
+    return true;
+}
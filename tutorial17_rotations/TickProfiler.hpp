@@ -0,0 +1,136 @@
+#pragma once
+// TickProfiler.hpp  -- per-thread timing of SwarmScheduler ticks: latency histograms and a Chrome trace
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// What the scheduler times. Durations are per thread: a tick is timed on the tick thread, a partition
+// step on whichever worker ran it.
+enum TickMetric
+{
+    MetricTick,       // whole runTick on the tick thread: dispatch, step, barrier, collisions, publish
+    MetricUpdate,     // one worker's stepPartition (updatePhysics over its UAVs)
+    MetricBarrier,    // tick thread waiting for the other workers after its own partition
+    MetricCollisions, // broadphase and velocity swaps
+    MetricPublish,    // snapshot publish and the recorder's copy
+    MetricLateness,   // real time: wake-up after sleep_until minus the deadline
+    MetricJitter,     // real time: |dt - tick period|
+    MetricLockWait,   // tick thread acquiring membersMtx (held by add/remove/size/tickCount callers)
+    MetricCount
+};
+
+const char *tickMetricName(TickMetric metric);
+
+// Log-linear histogram of nanosecond values in the manner of HdrHistogram: 32 linear sub-buckets per
+// power of two, so any recorded value is known to within 1/32 (3%) from 1 ns up to 34 s, in a fixed 8 KB
+// with no allocation per value. Percentiles report the upper edge of their bucket.
+class LatencyHistogram
+{
+  public:
+    static const int kSubBucketBits = 5;
+    static const int kMaxBits = 35; // values clamp to 2^35 - 1 ns
+    static const std::size_t kBuckets = static_cast<std::size_t>(kMaxBits - kSubBucketBits + 1) << kSubBucketBits;
+
+    static std::size_t bucketOf(std::uint64_t ns);
+    static std::uint64_t bucketHigh(std::size_t bucket);
+
+    void clear();
+    void add(std::uint64_t ns);
+    void merge(const LatencyHistogram &other);
+    // Counts recorded since `earlier`, a previous copy of this histogram
+    void subtract(const LatencyHistogram &earlier);
+
+    std::uint64_t count() const
+    {
+        return total;
+    }
+    double mean() const
+    {
+        return total ? static_cast<double>(sum) / total : 0.0;
+    }
+    // Smallest bucket edge with at least fraction q (0..1) of the values at or below it; 0 when empty
+    std::uint64_t percentile(double q) const;
+    std::uint64_t max() const
+    {
+        return percentile(1.0);
+    }
+
+    std::uint64_t counts[kBuckets] = {};
+    std::uint64_t total = 0;
+    std::uint64_t sum = 0;
+};
+
+// Every metric merged over all threads at one moment
+struct TickProfile
+{
+    LatencyHistogram metrics[MetricCount];
+
+    // What was recorded between `earlier` and this profile, both from the same TickProfiler
+    void subtract(const TickProfile &earlier);
+    // Per metric: count, mean, p50, p90, p99, p99.9 and max in milliseconds, one line each
+    void print(FILE *out) const;
+};
+
+// Timing owned by a SwarmScheduler. Each thread (the tick thread is 0, helper worker i is i) writes only
+// its own slot, so recording takes no lock and no read-modify-write: histogram counters are relaxed
+// atomics with a single writer, and the events go into that thread's ring of the most recent ones. A
+// collect() from any other thread at any time sees every value recorded before it, give or take the ones
+// in flight. When disabled, the scheduler skips the clock reads as well.
+class TickProfiler
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    explicit TickProfiler(unsigned threads);
+
+    // Start recording, keeping the last `eventsPerThread` events per thread for the trace. Call while
+    // the scheduler is not ticking (before the first UAV starts, or between runSteps calls).
+    void enable(std::size_t eventsPerThread = 16384);
+    void disable();
+    bool enabled() const
+    {
+        return on.load(std::memory_order_relaxed);
+    }
+
+    // A timed span on `thread`: into the histogram and the event ring
+    void span(unsigned thread, TickMetric metric, clock::time_point begin, clock::time_point end,
+              unsigned long long tick);
+    // A value with no span of its own (jitter): histogram only
+    void value(unsigned thread, TickMetric metric, std::uint64_t ns);
+
+    // Histograms of everything recorded so far
+    void collect(TickProfile &out) const;
+
+    // The event rings as Chrome trace JSON (chrome://tracing, Perfetto), one track per thread. Only while
+    // the scheduler is not ticking: events are read without synchronization.
+    bool writeChromeTrace(const char *path) const;
+
+  private:
+    struct Event
+    {
+        std::int64_t begin; // ns since epoch
+        std::uint32_t duration; // ns, saturated
+        std::uint32_t metric;
+        unsigned long long tick;
+    };
+
+    struct Slot
+    {
+        std::atomic<std::uint64_t> counts[MetricCount][LatencyHistogram::kBuckets];
+        std::atomic<std::uint64_t> totals[MetricCount];
+        std::atomic<std::uint64_t> sums[MetricCount];
+        std::vector<Event> events; // ring
+        std::atomic<std::uint64_t> written;
+    };
+
+    void add(Slot &slot, TickMetric metric, std::uint64_t ns);
+
+    const clock::time_point epoch;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::atomic<bool> on{false};
+};
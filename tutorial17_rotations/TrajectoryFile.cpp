@@ -0,0 +1,158 @@
+// TrajectoryFile.cpp  -- on-disk layout of swarm trajectory recordings and the frame codec they use
+
+#include "TrajectoryFile.hpp"
+
+#include <cmath>
+
+namespace
+{
+
+// Keeps 2 q[-1] - q[-2] and every residual comfortably inside 64 bits, and a quantized position within
+// a metre-scale quantum of +-1000 km
+const float kMaxQuantized = 1073741824.0f; // 2^30
+
+std::int32_t quantize(float v, float inverseQuantum)
+{
+    float q = v * inverseQuantum;
+    if (!(q > -kMaxQuantized)) // also catches NaN
+        q = -kMaxQuantized;
+    if (q > kMaxQuantized)
+        q = kMaxQuantized;
+    // round half away from zero with a truncating conversion, which compiles to one instruction where
+    // nearbyint is a library call
+    return static_cast<std::int32_t>(q + (q < 0.0f ? -0.5f : 0.5f));
+}
+
+std::uint8_t *putVarint(std::uint8_t *out, std::int64_t value)
+{
+    // zigzag: small magnitudes of either sign become small unsigned numbers
+    std::uint64_t v = (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    while (v >= 0x80)
+    {
+        *out++ = static_cast<std::uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = static_cast<std::uint8_t>(v);
+    return out;
+}
+
+bool getVarint(const std::uint8_t *&p, const std::uint8_t *end, std::int64_t &value)
+{
+    std::uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (p == end)
+            return false;
+        const std::uint8_t byte = *p++;
+        v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            value = static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void TrajectoryFrame::resize(std::size_t n)
+{
+    for (auto *v : {&px, &py, &pz, &vx, &vy, &vz})
+        v->resize(n);
+    phase.resize(n);
+}
+
+void TrajectoryCodec::reset(std::size_t droneCount, float positionQuantum, float velocityQuantum)
+{
+    drones = droneCount;
+    quantum[0] = positionQuantum;
+    quantum[1] = velocityQuantum;
+    frames = 0;
+    for (auto &v : last)
+        v.assign(droneCount, 0);
+    for (auto &v : before)
+        v.assign(droneCount, 0);
+    lastPhase.assign(droneCount, 0);
+}
+
+void TrajectoryCodec::encode(const TrajectoryFrame &frame, std::vector<std::uint8_t> &out)
+{
+    // grow once for the worst case and write through a pointer; trimmed to what was used at the end
+    const std::size_t start = out.size();
+    out.resize(start + drones * kTrajectoryMaxBytesPerDrone);
+    std::uint8_t *o = out.data() + start;
+    const float *channels[6] = {frame.px.data(), frame.py.data(), frame.pz.data(),
+                                frame.vx.data(), frame.vy.data(), frame.vz.data()};
+    for (int c = 0; c < 6; ++c)
+    {
+        const float *in = channels[c];
+        const float inverse = 1.0f / quantum[c < 3 ? 0 : 1];
+        std::int32_t *q1 = last[c].data();
+        if (c < 3)
+        {
+            std::int32_t *q2 = before[c].data();
+            for (std::size_t i = 0; i < drones; ++i)
+            {
+                const std::int32_t q = quantize(in[i], inverse);
+                o = putVarint(o, static_cast<std::int64_t>(q) - (2 * static_cast<std::int64_t>(q1[i]) - q2[i]));
+                // the second frame of a chunk predicts "no change" from the first
+                q2[i] = frames ? q1[i] : q;
+                q1[i] = q;
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < drones; ++i)
+            {
+                const std::int32_t q = quantize(in[i], inverse);
+                o = putVarint(o, static_cast<std::int64_t>(q) - q1[i]);
+                q1[i] = q;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < drones; ++i)
+    {
+        *o++ = frame.phase[i] ^ lastPhase[i];
+        lastPhase[i] = frame.phase[i];
+    }
+    out.resize(o - out.data());
+    ++frames;
+}
+
+bool TrajectoryCodec::decode(const std::uint8_t *&p, const std::uint8_t *end, TrajectoryFrame &frame)
+{
+    frame.resize(drones);
+    float *channels[6] = {frame.px.data(), frame.py.data(), frame.pz.data(),
+                          frame.vx.data(), frame.vy.data(), frame.vz.data()};
+    for (int c = 0; c < 6; ++c)
+    {
+        float *out = channels[c];
+        const float scale = quantum[c < 3 ? 0 : 1];
+        std::int32_t *q1 = last[c].data();
+        std::int32_t *q2 = c < 3 ? before[c].data() : NULL;
+        for (std::size_t i = 0; i < drones; ++i)
+        {
+            std::int64_t residual;
+            if (!getVarint(p, end, residual))
+                return false;
+            const std::int64_t predicted = q2 ? 2 * static_cast<std::int64_t>(q1[i]) - q2[i] : q1[i];
+            const std::int64_t q = predicted + residual;
+            if (q < -static_cast<std::int64_t>(kMaxQuantized) || q > static_cast<std::int64_t>(kMaxQuantized))
+                return false;
+            if (q2)
+                q2[i] = frames ? q1[i] : static_cast<std::int32_t>(q);
+            q1[i] = static_cast<std::int32_t>(q);
+            out[i] = static_cast<float>(q) * scale;
+        }
+    }
+    if (static_cast<std::size_t>(end - p) < drones)
+        return false;
+    for (std::size_t i = 0; i < drones; ++i)
+    {
+        lastPhase[i] ^= *p++;
+        frame.phase[i] = lastPhase[i];
+    }
+    ++frames;
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+// TrajectoryFile.hpp  -- on-disk layout of swarm trajectory recordings and the frame codec they use
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// File layout, all values little-endian:
+//   TrajectoryHeader
+//   chunks, each: TrajectoryChunkHeader, one double (simulated seconds) per frame, then frameCount frames
+//                 as a single zlib stream (compressedSize bytes, rawSize once inflated), zero-padded to a
+//                 multiple of 8 bytes so every header and the index stay aligned in a mapping
+//   TrajectoryIndexEntry per chunk
+//   TrajectoryFooter, last in the file
+// A file whose writer died has no index or footer; its chunks can still be read front to back.
+//
+// Inside a chunk every frame holds, for each drone, the position and velocity quantized to integer
+// multiples of positionQuantum / velocityQuantum and its FlightPhase. Each channel is one run of values
+// (all px, then all py, ..., then all phases), so zlib sees long runs of similar numbers:
+//   position  zigzag varint of q - (2 q[-1] - q[-2]): the error of a constant-velocity prediction
+//   velocity  zigzag varint of q - q[-1]
+//   phase     one byte, xor the previous frame's
+// The first frame of a chunk predicts from zero and the second from the first alone, so every chunk
+// decodes without the ones before it.
+struct TrajectoryHeader
+{
+    char magic[8];         // "UAVTRAJ"
+    std::uint32_t version; // kTrajectoryVersion
+    std::uint32_t headerSize;
+    std::uint64_t droneCount;
+    double interval;       // nominal simulated seconds between frames; frame times are stored per chunk
+    float positionQuantum; // metres
+    float velocityQuantum; // metres per second
+    std::uint32_t framesPerChunk;
+    float droneSize; // edge of the bounding cube of every drone (ECE_UAV::size_m), for culling a replay
+};
+
+struct TrajectoryChunkHeader
+{
+    std::uint32_t magic; // kTrajectoryChunkMagic
+    std::uint32_t frameCount;
+    std::uint64_t firstFrame; // index of the chunk's first frame in the recording
+    std::uint32_t rawSize;
+    std::uint32_t compressedSize;
+};
+
+struct TrajectoryIndexEntry
+{
+    std::uint64_t offset; // of the TrajectoryChunkHeader, bytes from the start of the file
+    std::uint64_t firstFrame;
+    double firstTime;
+};
+
+struct TrajectoryFooter
+{
+    std::uint64_t indexOffset;
+    std::uint64_t chunkCount;
+    std::uint64_t frameCount;
+    std::uint32_t magic; // kTrajectoryFooterMagic
+    std::uint32_t reserved;
+};
+
+const std::uint32_t kTrajectoryVersion = 1;
+const std::uint32_t kTrajectoryChunkMagic = 0x4B4E4843;  // "CHNK"
+const std::uint32_t kTrajectoryFooterMagic = 0x444E4554; // "TEND"
+// Upper bound on the encoded size of one drone in one frame: six varints and the phase byte
+const std::size_t kTrajectoryMaxBytesPerDrone = 6 * 10 + 1;
+
+// One recorded instant of the whole swarm, a component per array
+struct TrajectoryFrame
+{
+    double time = 0.0;
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<std::uint8_t> phase; // FlightPhase
+
+    void resize(std::size_t n);
+    std::size_t size() const
+    {
+        return px.size();
+    }
+};
+
+// Encodes frames into a chunk's raw bytes and decodes them back, keeping the quantized history the
+// predictions need. reset() at every chunk start, on both sides.
+class TrajectoryCodec
+{
+  public:
+    void reset(std::size_t droneCount, float positionQuantum, float velocityQuantum);
+
+    // Append `frame` (droneCount drones) to `out`
+    void encode(const TrajectoryFrame &frame, std::vector<std::uint8_t> &out);
+    // Read the next frame from [p, end) into `frame` (resized to droneCount) and advance p; false if the
+    // data is truncated or malformed
+    bool decode(const std::uint8_t *&p, const std::uint8_t *end, TrajectoryFrame &frame);
+
+  private:
+    std::size_t drones = 0;
+    float quantum[2] = {1.0f, 1.0f}; // position, velocity
+    std::size_t frames = 0;          // since reset
+    std::vector<std::int32_t> last[6];   // q[-1] per channel: px py pz vx vy vz
+    std::vector<std::int32_t> before[3]; // q[-2] per position channel
+    std::vector<std::uint8_t> lastPhase;
+};
@@ -0,0 +1,266 @@
+// TrajectoryRecorder.cpp  -- streams swarm frames to a compressed trajectory file from a background thread
+
+#include "TrajectoryRecorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "SwarmState.hpp"
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    close();
+}
+
+bool TrajectoryRecorder::open(const char *path, std::size_t droneCount, const TrajectoryOptions &options)
+{
+    close();
+    if (!(options.interval > 0.0) || !(options.positionQuantum > 0.0f) || !(options.velocityQuantum > 0.0f) ||
+        options.queueDepth == 0)
+    {
+        fprintf(stderr, "TrajectoryRecorder: bad options for %s\n", path);
+        return false;
+    }
+    file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "TrajectoryRecorder: cannot create %s\n", path);
+        return false;
+    }
+
+    drones = droneCount;
+    opts = options;
+    // a chunk is compressed in one call, and zlib counts its input in 32 bits
+    const std::size_t maxFrames = 0xFFFFFFFFu / (std::max<std::size_t>(drones, 1) * kTrajectoryMaxBytesPerDrone);
+    opts.framesPerChunk = std::max<std::size_t>(1, std::min(opts.framesPerChunk, maxFrames));
+    started = false;
+    nextTime = -HUGE_VAL;
+    failed = false;
+    offset = 0;
+    framesWritten = 0;
+    index.clear();
+    chunkTimes.clear();
+    raw.clear();
+    dropped = 0;
+    writtenFrames = 0;
+    writtenChunks = 0;
+    writtenBytes = 0;
+
+    TrajectoryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "UAVTRAJ", 8);
+    header.version = kTrajectoryVersion;
+    header.headerSize = sizeof(header);
+    header.droneCount = drones;
+    header.interval = opts.interval;
+    header.positionQuantum = opts.positionQuantum;
+    header.velocityQuantum = opts.velocityQuantum;
+    header.framesPerChunk = static_cast<std::uint32_t>(opts.framesPerChunk);
+    header.droneSize = opts.droneSize;
+    if (!write(&header, sizeof(header)))
+    {
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+
+    // every buffer is sized up front so the producer never allocates
+    ring.reset(new TrajectoryFrame[opts.queueDepth]);
+    for (std::size_t i = 0; i < opts.queueDepth; ++i)
+        ring[i].resize(drones);
+    head = 0;
+    tail = 0;
+    closing = false;
+    writer = std::thread(&TrajectoryRecorder::writerLoop, this);
+    return true;
+}
+
+bool TrajectoryRecorder::close()
+{
+    if (!file)
+        return true;
+    closing.store(true, std::memory_order_release);
+    writer.join();
+    if (fclose(file) != 0 && !failed)
+    {
+        fprintf(stderr, "TrajectoryRecorder: error closing the recording\n");
+        failed = true;
+    }
+    file = NULL;
+    ring.reset();
+    return !failed;
+}
+
+TrajectoryFrame *TrajectoryRecorder::beginFrame(double time)
+{
+    if (!due(time))
+        return NULL;
+    // the next grid point after `time`, stepping over any the caller skipped
+    if (!started)
+    {
+        firstTime = time;
+        started = true;
+    }
+    const double k = std::floor((time - firstTime) / opts.interval + 1e-3) + 1.0;
+    nextTime = firstTime + k * opts.interval;
+
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) == opts.queueDepth)
+    {
+        if (!opts.waitWhenFull)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        std::this_thread::yield();
+    }
+    TrajectoryFrame &frame = ring[h % opts.queueDepth];
+    frame.time = time;
+    return &frame;
+}
+
+void TrajectoryRecorder::commitFrame()
+{
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void TrajectoryRecorder::record(const SwarmState &state, double time)
+{
+    if (state.size() != drones)
+        return;
+    TrajectoryFrame *frame = beginFrame(time);
+    if (!frame)
+        return;
+    std::copy(state.px.begin(), state.px.end(), frame->px.begin());
+    std::copy(state.py.begin(), state.py.end(), frame->py.begin());
+    std::copy(state.pz.begin(), state.pz.end(), frame->pz.begin());
+    std::copy(state.vx.begin(), state.vx.end(), frame->vx.begin());
+    std::copy(state.vy.begin(), state.vy.end(), frame->vy.begin());
+    std::copy(state.vz.begin(), state.vz.end(), frame->vz.begin());
+    for (std::size_t i = 0; i < drones; ++i)
+        frame->phase[i] = flightPhase(state, i, static_cast<float>(time));
+    commitFrame();
+}
+
+TrajectoryStats TrajectoryRecorder::stats() const
+{
+    TrajectoryStats s;
+    s.framesWritten = writtenFrames.load();
+    s.framesDropped = dropped.load();
+    s.chunks = writtenChunks.load();
+    s.rawBytes = s.framesWritten * drones * (6 * sizeof(float) + 1);
+    s.fileBytes = writtenBytes.load();
+    return s;
+}
+
+void TrajectoryRecorder::writerLoop()
+{
+    unsigned idle = 0;
+    for (;;)
+    {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+        {
+            // closing is set after the last commitFrame(), so one more look at head sees every frame
+            if (closing.load(std::memory_order_acquire) && t == head.load(std::memory_order_acquire))
+                break;
+            // polling keeps the producer free of locks and notifications. Right after a frame the next one
+            // is likely close (a fast fixed-step run), so yield for a while before falling back to sleeping.
+            if (++idle < 256)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        idle = 0;
+        encodeFrame(ring[t % opts.queueDepth]);
+        tail.store(t + 1, std::memory_order_release);
+    }
+    flushChunk();
+
+    TrajectoryFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    footer.indexOffset = offset;
+    footer.chunkCount = index.size();
+    footer.frameCount = framesWritten;
+    footer.magic = kTrajectoryFooterMagic;
+    write(index.data(), index.size() * sizeof(TrajectoryIndexEntry));
+    write(&footer, sizeof(footer));
+    if (!failed && fflush(file) != 0)
+    {
+        fprintf(stderr, "TrajectoryRecorder: write failed\n");
+        failed = true;
+    }
+}
+
+void TrajectoryRecorder::encodeFrame(const TrajectoryFrame &frame)
+{
+    if (failed)
+        return;
+    if (chunkTimes.empty())
+        codec.reset(drones, opts.positionQuantum, opts.velocityQuantum);
+    codec.encode(frame, raw);
+    chunkTimes.push_back(frame.time);
+    if (chunkTimes.size() == opts.framesPerChunk)
+        flushChunk();
+}
+
+void TrajectoryRecorder::flushChunk()
+{
+    if (chunkTimes.empty() || failed)
+        return;
+    uLongf size = compressBound(static_cast<uLong>(raw.size()));
+    compressed.resize(size);
+    if (compress2(compressed.data(), &size, raw.data(), static_cast<uLong>(raw.size()), opts.compressionLevel) !=
+        Z_OK)
+    {
+        fprintf(stderr, "TrajectoryRecorder: compression failed\n");
+        failed = true;
+        return;
+    }
+
+    TrajectoryChunkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = kTrajectoryChunkMagic;
+    header.frameCount = static_cast<std::uint32_t>(chunkTimes.size());
+    header.firstFrame = framesWritten;
+    header.rawSize = static_cast<std::uint32_t>(raw.size());
+    header.compressedSize = static_cast<std::uint32_t>(size);
+
+    TrajectoryIndexEntry entry;
+    entry.offset = offset;
+    entry.firstFrame = framesWritten;
+    entry.firstTime = chunkTimes.front();
+
+    // zero padding keeps the next chunk header, and the index after the last chunk, 8-byte aligned
+    static const std::uint8_t padding[8] = {0};
+    if (write(&header, sizeof(header)) && write(chunkTimes.data(), chunkTimes.size() * sizeof(double)) &&
+        write(compressed.data(), size) && write(padding, (8 - size % 8) % 8))
+    {
+        index.push_back(entry);
+        framesWritten += chunkTimes.size();
+        writtenFrames.store(framesWritten, std::memory_order_relaxed);
+        writtenChunks.fetch_add(1, std::memory_order_relaxed);
+    }
+    chunkTimes.clear();
+    raw.clear();
+}
+
+bool TrajectoryRecorder::write(const void *data, std::size_t size)
+{
+    if (failed)
+        return false;
+    if (size && fwrite(data, 1, size, file) != size)
+    {
+        fprintf(stderr, "TrajectoryRecorder: write failed\n");
+        failed = true;
+        return false;
+    }
+    offset += size;
+    writtenBytes.store(offset, std::memory_order_relaxed);
+    return true;
+}
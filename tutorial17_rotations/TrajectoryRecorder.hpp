@@ -0,0 +1,118 @@
+#pragma once
+// TrajectoryRecorder.hpp  -- streams swarm frames to a compressed trajectory file from a background thread
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "DroneParams.hpp"
+#include "TrajectoryFile.hpp"
+
+struct SwarmState;
+
+struct TrajectoryOptions
+{
+    double interval = 0.1;                 // simulated seconds between frames
+    float positionQuantum = 1.0f / 512.0f; // ~2 mm
+    float velocityQuantum = 1.0f / 128.0f; // ~8 mm/s
+    std::size_t framesPerChunk = 64;       // frames per zlib stream: the seek granularity of a replay
+    int compressionLevel = 1;              // zlib level; the writer shares the CPU with the simulation
+    std::size_t queueDepth = 8;            // frames that may wait for the writer before new ones are dropped
+    float droneSize = kDroneSize;          // ECE_UAV::size_m, stored for the replay's culling
+    bool waitWhenFull = false; // make the producer wait for the writer instead of dropping: for batch runs,
+                               // where a complete recording matters more than the pace of any one tick
+};
+
+struct TrajectoryStats
+{
+    unsigned long long framesWritten = 0;
+    unsigned long long framesDropped = 0; // the writer was queueDepth frames behind
+    unsigned long long chunks = 0;
+    unsigned long long rawBytes = 0; // the frames as float/byte arrays
+    unsigned long long fileBytes = 0;
+};
+
+// Recording from the simulation thread costs one copy of the swarm state per frame: the producer fills
+// a preallocated TrajectoryFrame and hands it over through a single-producer / single-consumer ring of
+// atomic indices. Quantizing, encoding, compression and file I/O all happen on the writer thread. The
+// producer never waits on I/O: when every buffer is still queued the frame is dropped and counted
+// instead, and the recording simply has a gap there (unless waitWhenFull).
+//
+// One producer thread at a time calls due() / beginFrame() / commitFrame() / record().
+class TrajectoryRecorder
+{
+  public:
+    TrajectoryRecorder() = default;
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+    TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+    // Create `path` for a swarm of droneCount drones and start the writer
+    bool open(const char *path, std::size_t droneCount, const TrajectoryOptions &options = TrajectoryOptions());
+    // Write everything queued, the index and the footer; false if any write failed
+    bool close();
+    bool isOpen() const
+    {
+        return file != NULL;
+    }
+
+    std::size_t droneCount() const
+    {
+        return drones;
+    }
+
+    // Producer: whether a frame is due at simulated time `time`. Frames fall on a grid of `interval` from
+    // the first one; the slack absorbs float step times (10 steps of 0.01f are 0.0999999978 s).
+    bool due(double time) const
+    {
+        return file != NULL && time >= nextTime - opts.interval * 1e-3;
+    }
+    // Producer: the buffer to fill for the frame at `time`, sized droneCount(); NULL if no frame is due or
+    // the writer is too far behind (the frame is then counted as dropped)
+    TrajectoryFrame *beginFrame(double time);
+    // Producer: queue the frame returned by beginFrame()
+    void commitFrame();
+
+    // Producer: record every drone of `state` at simulation time `time` if a frame is due
+    void record(const SwarmState &state, double time);
+
+    // Totals so far; exact once close() has returned
+    TrajectoryStats stats() const;
+
+  private:
+    void writerLoop();
+    void encodeFrame(const TrajectoryFrame &frame);
+    void flushChunk();
+    bool write(const void *data, std::size_t size);
+
+    FILE *file = NULL;
+    std::size_t drones = 0;
+    TrajectoryOptions opts;
+    double firstTime = 0.0;
+    double nextTime = 0.0;
+    bool started = false; // a frame has been begun, so firstTime is set
+
+    // Ring of queueDepth frame buffers: slots [tail, head) wait for the writer, the rest are the producer's
+    std::unique_ptr<TrajectoryFrame[]> ring;
+    std::atomic<std::size_t> head{0}; // next slot to fill; written by the producer
+    std::atomic<std::size_t> tail{0}; // next slot to write; written by the writer
+    std::atomic<bool> closing{false};
+    std::thread writer;
+
+    std::atomic<unsigned long long> dropped{0};
+
+    // Writer state
+    TrajectoryCodec codec;
+    std::vector<std::uint8_t> raw, compressed;
+    std::vector<double> chunkTimes;
+    std::vector<TrajectoryIndexEntry> index;
+    std::uint64_t offset = 0;
+    std::uint64_t framesWritten = 0;
+    bool failed = false;
+    std::atomic<unsigned long long> writtenFrames{0}, writtenChunks{0}, writtenBytes{0};
+};
@@ -0,0 +1,278 @@
+// TrajectoryReplay.cpp  -- plays a trajectory recording back from a memory mapping
+
+#include "TrajectoryReplay.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <zlib.h>
+
+bool TrajectoryReplay::open(const char *path)
+{
+    close();
+    if (!file.open(path))
+    {
+        fprintf(stderr, "Failed to open trajectory: %s\n", path);
+        return false;
+    }
+    const std::uint64_t size = file.size();
+    const TrajectoryHeader *h = reinterpret_cast<const TrajectoryHeader *>(file.data());
+    if (size < sizeof(TrajectoryHeader) || memcmp(h->magic, "UAVTRAJ", 8) != 0 || h->version != kTrajectoryVersion ||
+        h->headerSize != sizeof(TrajectoryHeader) || !(h->interval > 0.0) || !(h->positionQuantum > 0.0f) ||
+        !(h->velocityQuantum > 0.0f) || h->framesPerChunk == 0 ||
+        h->droneCount > size / kTrajectoryMaxBytesPerDrone) // cannot be the drone count of this file
+    {
+        fprintf(stderr, "%s: not a trajectory recording (or a different version)\n", path);
+        close();
+        return false;
+    }
+    header = h;
+
+    // the index at the end when the writer closed the file properly
+    bool indexed = false;
+    if (size >= sizeof(TrajectoryHeader) + sizeof(TrajectoryFooter))
+    {
+        const TrajectoryFooter *footer =
+            reinterpret_cast<const TrajectoryFooter *>(file.data() + size - sizeof(TrajectoryFooter));
+        const std::uint64_t indexEnd = size - sizeof(TrajectoryFooter);
+        if (footer->magic == kTrajectoryFooterMagic && footer->indexOffset <= indexEnd &&
+            footer->indexOffset % 8 == 0 &&
+            footer->chunkCount == (indexEnd - footer->indexOffset) / sizeof(TrajectoryIndexEntry) &&
+            (indexEnd - footer->indexOffset) % sizeof(TrajectoryIndexEntry) == 0)
+        {
+            const TrajectoryIndexEntry *index =
+                reinterpret_cast<const TrajectoryIndexEntry *>(file.data() + footer->indexOffset);
+            indexed = true;
+            for (std::uint64_t c = 0; c < footer->chunkCount && indexed; ++c)
+                indexed = index[c].firstFrame == frames && addChunk(index[c].offset, footer->indexOffset);
+            indexed = indexed && frames == footer->frameCount;
+            if (!indexed)
+            {
+                fprintf(stderr, "%s: damaged index, reading the chunks in order\n", path);
+                chunks.clear();
+                frames = 0;
+                uniform = true;
+            }
+        }
+    }
+    // otherwise every complete chunk from the front
+    if (!indexed)
+        for (std::uint64_t offset = sizeof(TrajectoryHeader); addChunk(offset, size);)
+        {
+            const Chunk &c = chunks.back();
+            offset = static_cast<std::uint64_t>(c.data - reinterpret_cast<const std::uint8_t *>(file.data())) +
+                     c.header->compressedSize;
+            offset = (offset + 7) & ~std::uint64_t(7);
+        }
+
+    if (frames == 0)
+    {
+        fprintf(stderr, "%s: no complete frames\n", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TrajectoryReplay::close()
+{
+    file.close();
+    header = NULL;
+    chunks.clear();
+    frames = 0;
+    uniform = true;
+    loaded = SIZE_MAX;
+    raw.clear();
+    cursor = NULL;
+    cached[0] = cached[1] = SIZE_MAX;
+}
+
+bool TrajectoryReplay::addChunk(std::uint64_t offset, std::uint64_t limit)
+{
+    if (offset % 8 != 0 || offset > limit || limit - offset < sizeof(TrajectoryChunkHeader))
+        return false;
+    const std::uint8_t *base = reinterpret_cast<const std::uint8_t *>(file.data());
+    const TrajectoryChunkHeader *h = reinterpret_cast<const TrajectoryChunkHeader *>(base + offset);
+    const std::uint64_t body = limit - offset - sizeof(TrajectoryChunkHeader);
+    if (h->magic != kTrajectoryChunkMagic || h->frameCount == 0 || h->frameCount > header->framesPerChunk ||
+        h->firstFrame != frames || body / sizeof(double) < h->frameCount ||
+        body - h->frameCount * sizeof(double) < h->compressedSize ||
+        h->rawSize > header->droneCount * kTrajectoryMaxBytesPerDrone * h->frameCount)
+        return false;
+    Chunk c;
+    c.header = h;
+    c.times = reinterpret_cast<const double *>(h + 1);
+    c.data = reinterpret_cast<const std::uint8_t *>(c.times + h->frameCount);
+    // frameAt() searches the times
+    for (std::uint32_t i = 1; i < h->frameCount; ++i)
+        if (!(c.times[i] >= c.times[i - 1]))
+            return false;
+    if (!chunks.empty() && !(c.times[0] >= chunks.back().times[chunks.back().header->frameCount - 1]))
+        return false;
+
+    if (!chunks.empty() && chunks.back().header->frameCount != header->framesPerChunk)
+        uniform = false;
+    chunks.push_back(c);
+    frames += h->frameCount;
+    return true;
+}
+
+double TrajectoryReplay::startTime() const
+{
+    return frames ? chunks.front().times[0] : 0.0;
+}
+
+double TrajectoryReplay::endTime() const
+{
+    return frames ? chunks.back().times[chunks.back().header->frameCount - 1] : 0.0;
+}
+
+std::size_t TrajectoryReplay::chunkOf(std::size_t frame) const
+{
+    if (uniform)
+        return frame / header->framesPerChunk;
+    // only a recorder that was not ours writes short chunks in the middle
+    std::size_t lo = 0, hi = chunks.size();
+    while (hi - lo > 1)
+    {
+        const std::size_t mid = (lo + hi) / 2;
+        if (chunks[mid].header->firstFrame <= frame)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+double TrajectoryReplay::frameTime(std::size_t index) const
+{
+    const Chunk &c = chunks[chunkOf(index)];
+    return c.times[index - c.header->firstFrame];
+}
+
+std::size_t TrajectoryReplay::frameAt(double time) const
+{
+    if (frames == 0)
+        return 0;
+    // chunks span framesPerChunk intervals unless frames were dropped, which only makes them longer: the
+    // estimate is the right chunk or a little past it
+    const double span = header->interval * header->framesPerChunk;
+    const double estimate = std::floor((time - startTime()) / span);
+    std::size_t c = estimate <= 0.0 ? 0 : static_cast<std::size_t>(std::min<double>(estimate, chunks.size() - 1.0));
+    while (c > 0 && chunks[c].times[0] > time)
+        --c;
+    while (c + 1 < chunks.size() && chunks[c + 1].times[0] <= time)
+        ++c;
+
+    const Chunk &chunk = chunks[c];
+    const double *end = chunk.times + chunk.header->frameCount;
+    const std::size_t i = std::upper_bound(chunk.times, end, time) - chunk.times;
+    return static_cast<std::size_t>(chunk.header->firstFrame) + (i ? i - 1 : 0);
+}
+
+bool TrajectoryReplay::loadChunk(std::size_t chunk)
+{
+    const Chunk &c = chunks[chunk];
+    raw.resize(c.header->rawSize);
+    loaded = SIZE_MAX;
+
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (inflateInit(&z) != Z_OK)
+        return false;
+    z.next_in = const_cast<Bytef *>(c.data);
+    z.avail_in = c.header->compressedSize;
+    z.next_out = raw.data();
+    z.avail_out = static_cast<uInt>(raw.size());
+    const int status = inflate(&z, Z_FINISH);
+    const bool ok = status == Z_STREAM_END && z.total_out == raw.size();
+    inflateEnd(&z);
+    if (!ok)
+    {
+        fprintf(stderr, "TrajectoryReplay: chunk %zu does not inflate\n", chunk);
+        return false;
+    }
+
+    codec.reset(droneCount(), header->positionQuantum, header->velocityQuantum);
+    cursor = raw.data();
+    nextInChunk = 0;
+    loaded = chunk;
+    return true;
+}
+
+const TrajectoryFrame *TrajectoryReplay::fetch(std::size_t index, int keep)
+{
+    for (int s = 0; s < 2; ++s)
+        if (cached[s] == index)
+            return &cache[s];
+    const int slot = keep == 0 ? 1 : 0;
+    cached[slot] = SIZE_MAX;
+
+    const std::size_t chunk = chunkOf(index);
+    const std::size_t inChunk = index - static_cast<std::size_t>(chunks[chunk].header->firstFrame);
+    // frames only decode forwards from the start of their chunk
+    if ((loaded != chunk || nextInChunk > inChunk) && !loadChunk(chunk))
+        return NULL;
+    const std::uint8_t *end = raw.data() + raw.size();
+    TrajectoryFrame &out = cache[slot];
+    while (nextInChunk <= inChunk)
+    {
+        if (!codec.decode(cursor, end, out))
+        {
+            fprintf(stderr, "TrajectoryReplay: chunk %zu is damaged\n", chunk);
+            loaded = SIZE_MAX;
+            return NULL;
+        }
+        ++nextInChunk;
+    }
+    out.time = chunks[chunk].times[inChunk];
+    cached[slot] = index;
+    return &out;
+}
+
+const TrajectoryFrame *TrajectoryReplay::frame(std::size_t index)
+{
+    return index < frames ? fetch(index, -1) : NULL;
+}
+
+bool TrajectoryReplay::sample(double time, SwarmFrame &out)
+{
+    if (frames == 0)
+        return false;
+    time = std::max(startTime(), std::min(time, endTime()));
+    const std::size_t first = frameAt(time);
+    const std::size_t second = std::min(first + 1, frames - 1);
+    // the earlier frame of the pair is usually already decoded: playing forward it was last call's later
+    const TrajectoryFrame *a = fetch(first, -1);
+    if (!a)
+        return false;
+    const TrajectoryFrame *b = fetch(second, a == &cache[0] ? 0 : 1);
+    if (!b)
+        return false;
+
+    const std::size_t n = droneCount();
+    const double h = b->time - a->time;
+    const float s = h > 0.0 ? static_cast<float>(std::min(1.0, (time - a->time) / h)) : 0.0f;
+    // cubic Hermite basis; the tangents are the recorded velocities scaled to the frame spacing
+    const float s2 = s * s, s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = (s3 - 2.0f * s2 + s) * static_cast<float>(h);
+    const float h01 = 3.0f * s2 - 2.0f * s3;
+    const float h11 = (s3 - s2) * static_cast<float>(h);
+
+    out.tick = first;
+    out.time = time;
+    out.size = header->droneSize;
+    out.ids.resize(n);
+    out.positions.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        out.ids[i] = static_cast<std::uint32_t>(i);
+        out.positions[i] = glm::vec3(h00 * a->px[i] + h10 * a->vx[i] + h01 * b->px[i] + h11 * b->vx[i],
+                                     h00 * a->py[i] + h10 * a->vy[i] + h01 * b->py[i] + h11 * b->vy[i],
+                                     h00 * a->pz[i] + h10 * a->vz[i] + h01 * b->pz[i] + h11 * b->vz[i]);
+    }
+    return true;
+}
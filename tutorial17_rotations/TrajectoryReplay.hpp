@@ -0,0 +1,85 @@
+#pragma once
+// TrajectoryReplay.hpp  -- plays a trajectory recording back from a memory mapping
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "common/mappedfile.hpp"
+
+#include "SwarmSnapshot.hpp"
+#include "TrajectoryFile.hpp"
+
+// Random access into a TrajectoryRecorder file without reading it. open() maps the file and checks the
+// header and every chunk header against the file size; frame data is only paged in and inflated when a
+// frame in that chunk is asked for. Chunks hold framesPerChunk frames each, so finding the chunk of a
+// frame is a division, and finding the frame at a time is a division plus a step or two to absorb frames
+// the recorder dropped: seeking costs the same anywhere in a multi-GB file. Inside a chunk frames decode
+// in order from its start, so a seek decodes at most framesPerChunk frames and playing forward one each.
+//
+// A recording whose writer never finished has no index; open() then walks the chunk headers once and
+// keeps every complete chunk.
+class TrajectoryReplay
+{
+  public:
+    bool open(const char *path);
+    void close();
+    bool isOpen() const
+    {
+        return header != NULL;
+    }
+
+    std::size_t droneCount() const
+    {
+        return header ? static_cast<std::size_t>(header->droneCount) : 0;
+    }
+    std::size_t frameCount() const
+    {
+        return frames;
+    }
+    double startTime() const;
+    double endTime() const;
+    // Simulated time of frame `index` (< frameCount())
+    double frameTime(std::size_t index) const;
+    // The last frame at or before `time`; the first frame for earlier times
+    std::size_t frameAt(double time) const;
+
+    // Frame `index` decoded; NULL if its chunk is damaged. Valid until the next frame() or sample().
+    const TrajectoryFrame *frame(std::size_t index);
+
+    // The swarm at `time` (clamped to the recording), for the renderer: positions follow the cubic
+    // Hermite curve through the frames on either side using their velocities, so motion stays smooth
+    // between frames even at slow playback. ids are the drone indices. False if the data is damaged.
+    bool sample(double time, SwarmFrame &out);
+
+  private:
+    struct Chunk
+    {
+        const TrajectoryChunkHeader *header;
+        const double *times;
+        const std::uint8_t *data;
+    };
+
+    bool addChunk(std::uint64_t offset, std::uint64_t limit);
+    std::size_t chunkOf(std::size_t frame) const;
+    bool loadChunk(std::size_t chunk);
+    // Decoded frame `index` in a cache slot other than `keep` (-1: any)
+    const TrajectoryFrame *fetch(std::size_t index, int keep);
+
+    MappedFile file;
+    const TrajectoryHeader *header = NULL;
+    std::vector<Chunk> chunks;
+    std::size_t frames = 0;
+    bool uniform = true; // every chunk but the last holds framesPerChunk frames
+
+    // Inflated chunk and the decoder's position in it
+    std::size_t loaded = SIZE_MAX;
+    std::vector<std::uint8_t> raw;
+    TrajectoryCodec codec;
+    const std::uint8_t *cursor = NULL;
+    std::size_t nextInChunk = 0;
+
+    // Two decoded frames: the pair being interpolated
+    TrajectoryFrame cache[2];
+    std::size_t cached[2] = {SIZE_MAX, SIZE_MAX};
+};
@@ -3,16 +3,24 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <vector>
 
+#include "common/assetmanager.hpp"
 #include "common/controls.hpp"
 #include "common/shader.hpp"  // LoadShaders from tutorial
-#include "common/texture.hpp" // loadBMP_custom
-#define STB_IMAGE_IMPLEMENTATION
+#include "BulletScene.hpp"
 #include "ECE_UAV.hpp"
-#include "stb_image.h"
+#include "FrameOverlay.hpp"
+#include "FrustumCull.hpp"
+#include "InstancedMesh.hpp"
+#include "Scenario.hpp"
+#include "TextureStreamer.hpp"
+#include "TrajectoryReplay.hpp"
 
 GLFWwindow *window = nullptr; // define the global
 
@@ -57,8 +65,65 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
     cameraFront = glm::normalize(front);
 }
 
-int main(void)
+// Replay transport (tutorial17 --replay FILE): space plays / pauses, up / down doubles / halves the speed,
+// home, end and 0-9 jump to the start, the end or a tenth of the way through; left / right held scrubs
+bool replayPlaying = true;
+double replaySpeed = 1.0;
+double replaySeek = -1.0; // fraction of the recording to jump to; < 0: none pending
+
+// F1 shows / hides the frame time overlay
+bool overlayVisible = false;
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    if (action != GLFW_PRESS)
+        return;
+    if (key == GLFW_KEY_F1)
+        overlayVisible = !overlayVisible;
+    else if (key == GLFW_KEY_SPACE)
+        replayPlaying = !replayPlaying;
+    else if (key == GLFW_KEY_UP)
+        replaySpeed = std::min(replaySpeed * 2.0, 64.0);
+    else if (key == GLFW_KEY_DOWN)
+        replaySpeed = std::max(replaySpeed * 0.5, 1.0 / 16.0);
+    else if (key == GLFW_KEY_HOME)
+        replaySeek = 0.0;
+    else if (key == GLFW_KEY_END)
+        replaySeek = 1.0;
+    else if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9)
+        replaySeek = (key - GLFW_KEY_0) / 10.0;
+}
+
+int main(int argc, char **argv)
 {
+    // tutorial17 [--profile trace.json] [scenario.json | --replay recording.traj]
+    //   scenario.json: the swarm to fly, 15 drones on the yard lines by default
+    //   --replay: a uav_sim_headless --record file instead, with no simulation
+    //   --profile: time every physics tick, print percentiles every 5 s and write a Chrome trace at exit
+    Scenario scenario = defaultScenario();
+    TrajectoryReplay replay;
+    const char *profilePath = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            if (!replay.open(argv[++i]))
+                return -1;
+        }
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            profilePath = argv[++i];
+        else if (argv[i][0] != '-')
+        {
+            if (!loadScenario(argv[i], scenario))
+                return -1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: tutorial17 [--profile trace.json] [scenario.json | --replay recording.traj]\n");
+            return -1;
+        }
+    }
+
     // Initialize GLFW
     if (!glfwInit())
     {
@@ -143,64 +208,45 @@ int main(void)
     }
 
     glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // hide & capture cursor
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    // Load image
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // Flip BMP vertically
-    unsigned char *data = stbi_load("ff.bmp", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        printf("Loaded texture: %d x %d, channels=%d\n", width, height, nrChannels);
-    }
-    else
-    {
-        fprintf(stderr, "Failed to load texture (data == NULL)\n");
-    }
+    // The field texture is decoded and mipmapped on the streamer's workers and goes up through its unpack
+    // buffer ring from the render loop; until then the field shows a gray placeholder
+    TextureStreamer textures;
+    textures.create();
+    GLuint texture = textures.request("ff.bmp");
 
     /*
     Load and handle OBJ
     */
-    std::vector<float> verts, uvs, norms;
-
-    if (!loadOBJ("chicken_01.obj", verts, uvs, norms))
-    {
-        printf("OBJ load failed!\n");
-    }
-
-    GLuint objVAO, objVBO;
-    glGenVertexArrays(1, &objVAO);
-    glGenBuffers(1, &objVBO);
-
-    glBindVertexArray(objVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, objVBO);
-    glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(float), verts.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    if (data)
+    // Imported on the asset workers while the window is already up: parsed, welded (the swarm draws it from
+    // positions alone), cache-ordered and given a LOD chain once, then kept as chicken_01.obj.mesh and
+    // mapped straight from disk on later runs. The render loop uploads it when it lands.
+    AssetManager assets;
+    const std::uint32_t chickenRequest = assets.request("chicken_01.obj", AssetWeldPositions | AssetBuildLods);
+
+    // every UAV shares this mesh; one instanced draw per level of detail covers the whole swarm. Empty (one
+    // level, nothing drawn) until the import arrives.
+    InstancedMesh chickenMesh;
+    chickenMesh.create(NULL, 0, NULL, 0, GL_UNSIGNED_INT);
+    float chickenRadius = 0.0f; // bounding radius in mesh units, for LOD selection
+
+    // The scenario's static obstacles: one single-instance mesh each for drawing, streamed in like the chicken,
+    // and with the bullet collider a BulletScene the scheduler collides the swarm against. The collision
+    // meshes are loaded here and now: the swarm must not fly through an obstacle that has not arrived yet.
+    // They go through the same mesh cache with the same options as the drawn ones, which are requested
+    // only afterwards, so each obstacle is parsed at most once and the workers map what is loaded here.
+    BulletScene scene;
+    if (scenario.collider == ColliderBullet && addScenarioObstacles(scenario, scene))
+        SwarmScheduler::instance().setCollisionScene(&scene);
+    std::vector<InstancedMesh> obstacleMeshes(scenario.obstacles.size());
+    std::vector<std::uint32_t> obstacleRequests(scenario.obstacles.size());
+    for (std::size_t o = 0; o < scenario.obstacles.size(); ++o)
     {
-        GLenum format = (nrChannels == 3) ? GL_RGB : GL_RGBA;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        obstacleMeshes[o].create(NULL, 0, NULL, 0, GL_UNSIGNED_INT);
+        obstacleRequests[o] = assets.request(scenario.obstacles[o].mesh, AssetWeldPositions);
     }
-    else
-    {
-        fprintf(stderr, "Failed to load texture\n");
-    }
-    stbi_image_free(data);
 
     glUseProgram(programID);
     glUniform1i(glGetUniformLocation(programID, "myTextureSampler"), 0);
@@ -215,54 +261,117 @@ int main(void)
 
     // --- BEFORE the main loop ---
     GLuint MatrixID = glGetUniformLocation(programID, "MVP");
+    GLuint ViewProjectionID = glGetUniformLocation(programID, "VP");
+    GLuint UseInstancingID = glGetUniformLocation(programID, "useInstancing");
+    GLuint UseSolidColorID = glGetUniformLocation(programID, "useSolidColor");
+    GLuint SolidColorID = glGetUniformLocation(programID, "solidColor");
+
+    // Shared part of every UAV model matrix (scale and 180 degree turn); only the translation differs
+    const float uavScale = 0.01f;
+    glm::mat4 uavBaseModel = glm::scale(glm::mat4(1.0f), glm::vec3(uavScale));
+    uavBaseModel = glm::rotate(uavBaseModel, glm::radians(180.0f), glm::vec3(0, 1, 0));
+
+    // LOD selection: a UAV at distance d covers radius * pixelsPerUnit / d pixels of the 600 pixel high
+    // viewport under the 45 degree projection below; each picks the coarsest level whose simplification
+    // error stays under a pixel there
+    const float pixelsPerUnit = 0.5f * 600.0f / std::tan(glm::radians(45.0f) * 0.5f);
+    float uavRadius = chickenRadius * uavScale;
+    std::vector<unsigned char> uavLod;
+
+    // frustum culling output and its counters, averaged into the window title once a second
+    std::vector<std::uint32_t> uavVisible;
+    std::size_t uavsVisible = 0, uavsCulled = 0, cullFrames = 0;
+    double cullReportTime = glfwGetTime();
+    std::vector<std::size_t> lodInstances(chickenMesh.lodCount()), lodSlot(chickenMesh.lodCount());
 
     // Optional: precompute a base field VAO scale if you want
     glm::vec3 fieldScale = glm::vec3(5.0f, 0.01f, 3.0f); // wide, thin floor
 
-    // Yard lines at 0, 25, 50, 25, 0 (like a V formation)
-    std::vector<float> yardLines = {0.0f, 25.0f, 50.0f, 75.0f, 100.0f};
-
-    // UAV positions container
-    std::vector<glm::vec3> UAVPositions;
-
-    // Map yard lines to Z coordinates
-    for (float yard : yardLines)
+    // UAVs group by group from the scenario, each with its group's behaviour parameters; none when
+    // replaying, where the recording alone drives the swarm. The profiler must be on before the first
+    // UAV starts the tick thread.
+    SwarmScheduler::instance().setCollisions(scenario.collisions);
+    std::unique_ptr<TickProfile> tickTotals, tickPrevious, tickInterval;
+    if (profilePath)
     {
-        float zPos = ((yard / 100.0f) * fieldLength) - fieldLength / 2.0f;
-        UAVPositions.push_back(glm::vec3(-fieldWidth / 2.0f, 0.0f, zPos)); // left
-        UAVPositions.push_back(glm::vec3(0.0, 0.0f, zPos));
-        UAVPositions.push_back(glm::vec3(fieldWidth / 2.0f, 0.0f, zPos)); // right
+        tickTotals.reset(new TickProfile());
+        tickPrevious.reset(new TickProfile());
+        tickInterval.reset(new TickProfile());
+        SwarmScheduler::instance().profiler().enable();
     }
-
-    // assuming UAVPositions (std::vector<glm::vec3>) contains 15 start positions
+    double profileReportTime = glfwGetTime();
     std::vector<std::unique_ptr<ECE_UAV>> uavs;
-    for (int i = 0; i < (int)UAVPositions.size(); ++i)
+    uavs.reserve(scenario.droneCount());
+    std::vector<glm::vec3> UAVPositions;
+    for (const ScenarioGroup &group : replay.isOpen() ? std::vector<ScenarioGroup>() : scenario.groups)
     {
-        auto u = std::make_unique<ECE_UAV>(UAVPositions[i]);
-        // optionally set different sphere center if needed:
-        u->sphereCenter = glm::vec3(0.0f, 50.0f, 0.0f);
-        u->ascendTarget = glm::vec3(0.0f, 50.0f, 0.0f);
+        UAVPositions.resize(group.formation.droneCount());
+        group.formation.positions(UAVPositions.data());
+        for (const glm::vec3 &p : UAVPositions)
+        {
+            auto u = std::make_unique<ECE_UAV>(p, scenario.seed + static_cast<std::uint32_t>(uavs.size()));
+            applyParams(group.params, *u);
 
-        u->start(); // spawns the thread
-        uavs.push_back(std::move(u));
+            u->start(); // registers with the scheduler's worker pool
+            uavs.push_back(std::move(u));
+        }
     }
 
+    // per-phase frame timing, shown with F1
+    FrameOverlay overlay;
+    overlay.create("overlayfont.DDS");
+    FrameCounts frameCounts;
+
+    // replay position in simulated seconds, and the interpolated swarm at it
+    const double kScrubRate = 10.0; // simulated seconds per second with left / right held, times the speed
+    double replayTime = replay.startTime();
+    SwarmFrame replayFrame;
+
     // Main render loop
     while (!glfwWindowShouldClose(window))
     {
-        // in your rendering loop (run at whatever frame-rate you like)
-        static double lastPoll = glfwGetTime();
-        double now = glfwGetTime();
-        if (now - lastPoll >= 0.03)
-        { // 30 ms
-            lastPoll = now;
-            // read positions (thread-safe)
-            for (size_t i = 0; i < uavs.size(); ++i)
+        overlay.beginFrame();
+        // at most one finished import per frame, so a burst of arrivals spreads its uploads over frames
+        ImportedModel imported;
+        if (assets.poll(imported) && imported.ok)
+        {
+            const GLenum indexType = imported.indexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            if (imported.id == chickenRequest)
             {
-                glm::vec3 p = uavs[i]->getPosition();
-                // convert simulation coords to your scene coords and draw model at 'p'
+                const glm::vec3 extent =
+                    glm::vec3(imported.boundsMax[0], imported.boundsMax[1], imported.boundsMax[2]) -
+                    glm::vec3(imported.boundsMin[0], imported.boundsMin[1], imported.boundsMin[2]);
+                chickenRadius = 0.5f * glm::length(extent);
+                uavRadius = chickenRadius * uavScale;
+                printf("%s: %zu vertices in %.1f ms (%s), LOD triangles:", imported.path.c_str(),
+                       imported.vertexCount(), imported.importMs, imported.cached ? "cached" : "rebuilt cache");
+                for (const MeshLod &lod : imported.lods)
+                    printf(" %u", lod.indexCount / 3);
+                printf("\n");
+                chickenMesh.destroy();
+                chickenMesh.create(imported.positions(), imported.vertexCount(), imported.indices(),
+                                   imported.indexCount(), indexType, imported.lods.data(), imported.lods.size());
+                lodInstances.assign(chickenMesh.lodCount(), 0);
+                lodSlot.assign(chickenMesh.lodCount(), 0);
+            }
+            for (std::size_t o = 0; o < obstacleRequests.size(); ++o)
+            {
+                if (imported.id != obstacleRequests[o])
+                    continue;
+                obstacleMeshes[o].destroy();
+                obstacleMeshes[o].create(imported.positions(), imported.vertexCount(), imported.indices(),
+                                         imported.indexCount(), indexType);
+                if (glm::mat4 *model = obstacleMeshes[o].mapInstances(1))
+                    *model = scenario.obstacles[o].transform();
+                obstacleMeshes[o].unmapInstances();
             }
         }
+        textures.update();
+        overlay.lap(FrameUpload);
+        // latest complete swarm frame from the physics tick (lock-free, never blocks physics), or the
+        // replay's, which is brought up to date below
+        const SwarmFrame &frame = replay.isOpen() ? replayFrame : SwarmScheduler::instance().snapshot().acquire();
+        overlay.lap(FrameSnapshot);
 
         glm::vec3 front;
         front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
@@ -287,7 +396,27 @@ int main(void)
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(window, true);
 
+        overlay.lap(FrameOther);
+        if (replay.isOpen())
+        {
+            if (replaySeek >= 0.0)
+            {
+                replayTime = replay.startTime() + replaySeek * (replay.endTime() - replay.startTime());
+                replaySeek = -1.0;
+            }
+            if (replayPlaying)
+                replayTime += deltaTime * replaySpeed;
+            if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+                replayTime -= deltaTime * kScrubRate * replaySpeed;
+            if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+                replayTime += deltaTime * kScrubRate * replaySpeed;
+            replayTime = std::max(replay.startTime(), std::min(replayTime, replay.endTime()));
+            replay.sample(replayTime, replayFrame);
+            overlay.lap(FrameSnapshot);
+        }
+
         // Clear buffers
+        overlay.beginGpu(GpuField);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Use shader program
@@ -303,37 +432,118 @@ int main(void)
         glm::mat4 fieldMVP = Projection * View * fieldModel;
         glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &fieldMVP[0][0]);
 
-        glUniform1i(glGetUniformLocation(programID, "useSolidColor"), 0);
+        glUniform1i(UseInstancingID, 0);
+        glUniform1i(UseSolidColorID, 0);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, texture);
 
         glBindVertexArray(fieldVAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        // --- Draw chicken OBJ ---
-        for (int i = 0; i < uavs.size(); i++)
+        overlay.endGpu();
+        overlay.lap(FrameDraw);
+
+        // --- Draw chicken OBJ (all visible UAVs at one level of detail in one instanced call) ---
+        // only UAVs whose bounding cube reaches into the view frustum get an instance
+        glm::mat4 VP = Projection * View;
+        const CullStats cull =
+            cullCubes(Frustum::fromMatrix(VP), frame.positions.data(), frame.positions.size(), frame.size, uavVisible);
+        uavsVisible += cull.visible;
+        uavsCulled += cull.culled;
+        overlay.lap(FrameCull);
+
+        // count the UAVs per level first, so each level's matrices can be written as one contiguous batch
+        const std::size_t uavCount = uavVisible.size();
+        uavLod.resize(uavCount);
+        std::fill(lodInstances.begin(), lodInstances.end(), 0);
+        for (size_t k = 0; k < uavCount; k++)
         {
-            glm::vec3 p = uavs[i]->getPosition();
-
-            glm::mat4 Model = glm::mat4(1.0f);
-            Model = glm::translate(Model, p);
-            Model = glm::scale(Model, glm::vec3(0.01f));
-            Model = glm::rotate(Model, glm::radians(180.0f), glm::vec3(0, 1, 0));
-
-            glm::mat4 MVP = Projection * View * Model;
-            glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
+            const float distance = glm::length(frame.positions[uavVisible[k]] - cameraPos);
+            const float projected = distance > 0.0f ? uavRadius * pixelsPerUnit / distance : 1e30f;
+            uavLod[k] = static_cast<unsigned char>(chickenMesh.selectLod(projected));
+            ++lodInstances[uavLod[k]];
+        }
+        for (size_t l = 0, first = 0; l < lodSlot.size(); first += lodInstances[l], l++)
+            lodSlot[l] = first;
+        overlay.lap(FrameMatrices);
 
-            glBindVertexArray(objVAO);
+        glm::mat4 *models = chickenMesh.mapInstances(uavCount);
+        overlay.lap(FrameUpload);
+        if (models)
+        {
+            for (size_t k = 0; k < uavCount; k++)
+            {
+                // translate(p) * base == base with p in the translation column
+                glm::mat4 &model = models[lodSlot[uavLod[k]]++];
+                model = uavBaseModel;
+                model[3] = glm::vec4(frame.positions[uavVisible[k]], 1.0f);
+            }
+        }
+        overlay.lap(FrameMatrices);
+        chickenMesh.unmapInstances();
+        chickenMesh.setLodInstanceCounts(lodInstances.data());
+        overlay.lap(FrameUpload);
+
+        glUniformMatrix4fv(ViewProjectionID, 1, GL_FALSE, &VP[0][0]);
+        glUniform1i(UseInstancingID, 1);
+        glUniform1i(UseSolidColorID, 1);
+        glUniform3f(SolidColorID, 0.0f, 0.0f, 0.0f);
+        overlay.beginGpu(GpuSwarm);
+        chickenMesh.draw();
+        glUniform3f(SolidColorID, 0.45f, 0.45f, 0.5f);
+        for (const InstancedMesh &obstacle : obstacleMeshes)
+            obstacle.draw();
+        overlay.endGpu();
+        overlay.lap(FrameDraw);
+
+        // the field is one draw call of two triangles
+        frameCounts.drones = frame.positions.size();
+        frameCounts.visible = cull.visible;
+        frameCounts.drawCalls = 1 + chickenMesh.drawCallCount();
+        frameCounts.triangles = 2 + chickenMesh.drawnTriangleCount();
+        for (const InstancedMesh &obstacle : obstacleMeshes)
+        {
+            frameCounts.drawCalls += obstacle.drawCallCount();
+            frameCounts.triangles += obstacle.drawnTriangleCount();
+        }
+        if (overlayVisible)
+        {
+            overlay.beginGpu(GpuOverlay);
+            overlay.draw();
+            overlay.endGpu();
+        }
 
-            glUniform1i(glGetUniformLocation(programID, "useSolidColor"), 1);
-            glUniform3f(glGetUniformLocation(programID, "solidColor"), 0.0f, 0.0f, 0.0f);
+        ++cullFrames;
+        // the replay clock needs to be readable while scrubbing
+        if (currentFrame - cullReportTime >= (replay.isOpen() ? 0.25 : 1.0))
+        {
+            char title[192];
+            int length = snprintf(title, sizeof(title), "BMP Texture Rectangle - %zu UAVs visible, %zu culled",
+                                  uavsVisible / cullFrames, uavsCulled / cullFrames);
+            if (replay.isOpen())
+                snprintf(title + length, sizeof(title) - length, " - replay %.2f / %.2f s x%g%s", replayTime,
+                         replay.endTime(), replaySpeed, replayPlaying ? "" : " (paused)");
+            glfwSetWindowTitle(window, title);
+            uavsVisible = uavsCulled = cullFrames = 0;
+            cullReportTime = currentFrame;
+        }
 
-            glDrawArrays(GL_TRIANGLES, 0, verts.size() / 3);
+        // tick timing over the last 5 s, read without stopping physics
+        if (profilePath && currentFrame - profileReportTime >= 5.0)
+        {
+            SwarmScheduler::instance().profiler().collect(*tickTotals);
+            *tickInterval = *tickTotals;
+            tickInterval->subtract(*tickPrevious);
+            *tickPrevious = *tickTotals;
+            printf("physics ticks, last %.0f s:\n", currentFrame - profileReportTime);
+            tickInterval->print(stdout);
+            profileReportTime = currentFrame;
         }
 
         // Swap buffers and poll events
         glfwSwapBuffers(window);
         glfwPollEvents();
+        overlay.lap(FrameOther);
+        overlay.endFrame(frameCounts);
     }
 
     for (auto &u : uavs)
@@ -344,6 +554,17 @@ int main(void)
     {
         u->join();
     }
+    SwarmScheduler::instance().setCollisionScene(NULL);
+    if (profilePath)
+    {
+        // the trace reads the event rings unsynchronized, so the tick thread goes first
+        SwarmScheduler::instance().stop();
+        SwarmScheduler::instance().join();
+        SwarmScheduler::instance().profiler().collect(*tickTotals);
+        printf("physics ticks, whole run:\n");
+        tickTotals->print(stdout);
+        SwarmScheduler::instance().profiler().writeChromeTrace(profilePath);
+    }
 
     // Delete field buffers
     glDeleteVertexArrays(1, &fieldVAO);
@@ -351,8 +572,12 @@ int main(void)
     glDeleteBuffers(1, &fieldEBO);
 
     // Delete chicken OBJ buffers
-    glDeleteVertexArrays(1, &objVAO);
-    glDeleteBuffers(1, &objVBO);
+    chickenMesh.destroy();
+    for (InstancedMesh &obstacle : obstacleMeshes)
+        obstacle.destroy();
+    overlay.destroy();
+    textures.destroy();
+    glDeleteTextures(1, &texture);
 
     glfwTerminate();
     return 0;
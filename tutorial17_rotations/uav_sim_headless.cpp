@@ -0,0 +1,531 @@
+// uav_sim_headless.cpp  -- the swarm simulation without a window or GL context, for batch runs
+//
+//   uav_sim_headless [--config FILE] [--key value | --key=value ...]
+//
+// Options are applied in order, so anything after --config or --scenario overrides the file. A config file
+// holds the same keys, one "key = value" per line, with # comments; a scenario file (Scenario.hpp) describes
+// the swarm itself. Metrics go out as JSON lines: one per report interval, then a summary, then the
+// recording totals when --record is given. --profile adds tick timing lines after each of the first two.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BulletScene.hpp"
+#include "ECE_UAV.hpp"
+#include "Scenario.hpp"
+#include "SpatialHash.hpp"
+#include "SwarmState.hpp"
+#include "TickProfiler.hpp"
+#include "TrajectoryRecorder.hpp"
+
+namespace
+{
+
+// A batch run has no frame deadline, so by default it waits for the writer rather than lose frames
+TrajectoryOptions batchRecording()
+{
+    TrajectoryOptions r;
+    r.waitWhenFull = true;
+    return r;
+}
+
+struct Options
+{
+    std::string engine = "scheduler"; // "scheduler" (ECE_UAV objects on the worker pool) or "soa" (stepSwarm)
+    Scenario scenario = defaultScenario(); // the swarm, and dt / duration / steps / seed / collisions
+    std::size_t reportEvery = 0; // steps between metric lines; 0: summary only
+    std::string output;          // metrics file; empty: stdout
+    std::string record;          // trajectory file; empty: no recording
+    std::string profile;         // Chrome trace of the last ticks; empty: no tick profiling
+    TrajectoryOptions recording = batchRecording();
+};
+
+const char *const kUsage =
+    "usage: uav_sim_headless [options]\n"
+    "  --config FILE        read \"key = value\" lines (same keys as below)\n"
+    "  --engine NAME        scheduler (ECE_UAV worker pool, default) or soa (vectorized SwarmState)\n"
+    "  --scenario FILE      swarm layout, behaviour and run length from a scenario file\n"
+    "  --drones N           replace the swarm with N drones on the yard lines 0/25/50/75/100 (default 15),\n"
+    "                       or past 15 on a square ground grid 0.4 m apart\n"
+    "  --steps N            fixed steps to run (overrides --duration)\n"
+    "  --duration SECONDS   simulated time to run (default 60)\n"
+    "  --dt SECONDS         fixed step (default 0.01)\n"
+    "  --seed N             RNG seed of the first drone; drone i uses seed + i (default 1)\n"
+    "  --collisions 0|1     UAV-UAV contact response (default 1)\n"
+    "  --collider NAME      hash (SpatialHash, default) or bullet (BulletScene, needed for obstacles)\n"
+    "  --report-every N     emit a metrics line every N steps (default 0: summary only)\n"
+    "  --output FILE        write metrics to FILE instead of stdout\n"
+    "  --record FILE        record the trajectories of every drone to FILE\n"
+    "  --record-interval S  simulated seconds between recorded frames (default 0.1)\n"
+    "  --record-level N     zlib level 1-9 for the recording (default 1)\n"
+    "  --record-drop 0|1    drop frames while the writer is behind instead of waiting for it (default 0)\n"
+    "  --profile FILE       time every tick (scheduler engine), report latency percentiles and write the\n"
+    "                       last ticks to FILE as a Chrome trace\n";
+
+bool parseUnsigned(const std::string &text, std::size_t &out)
+{
+    char *end = NULL;
+    const unsigned long long v = strtoull(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || text[0] == '-')
+        return false;
+    out = static_cast<std::size_t>(v);
+    return true;
+}
+
+bool parseDouble(const std::string &text, double &out)
+{
+    char *end = NULL;
+    const double v = strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || !std::isfinite(v))
+        return false;
+    out = v;
+    return true;
+}
+
+bool loadConfig(const std::string &path, Options &options);
+
+bool setOption(Options &o, const std::string &key, const std::string &value)
+{
+    std::size_t n = 0;
+    double d = 0.0;
+    if (key == "config")
+        return loadConfig(value, o);
+    if (key == "scenario")
+        return loadScenario(value.c_str(), o.scenario);
+    Scenario &s = o.scenario;
+    if (key == "engine" && (value == "scheduler" || value == "soa"))
+        o.engine = value;
+    else if (key == "drones" && parseUnsigned(value, n))
+    {
+        // a new swarm, but the run settings given so far stay
+        Scenario swarm = defaultScenario(n);
+        s.groups.swap(swarm.groups);
+        s.name = swarm.name;
+    }
+    else if (key == "steps" && parseUnsigned(value, n))
+        s.steps = n;
+    else if (key == "duration" && parseDouble(value, d) && d >= 0.0)
+        s.duration = d;
+    else if (key == "dt" && parseDouble(value, d) && d > 0.0)
+        s.dt = static_cast<float>(d);
+    else if (key == "seed" && parseUnsigned(value, n))
+        s.seed = static_cast<std::uint32_t>(n);
+    else if (key == "collisions" && (value == "0" || value == "1"))
+        s.collisions = value == "1";
+    else if (key == "collider" && (value == "hash" || value == "bullet"))
+        s.collider = value == "bullet" ? ColliderBullet : ColliderHash;
+    else if (key == "report-every" && parseUnsigned(value, n))
+        o.reportEvery = n;
+    else if (key == "output")
+        o.output = value;
+    else if (key == "record")
+        o.record = value;
+    else if (key == "record-interval" && parseDouble(value, d) && d > 0.0)
+        o.recording.interval = d;
+    else if (key == "record-level" && parseUnsigned(value, n) && n >= 1 && n <= 9)
+        o.recording.compressionLevel = static_cast<int>(n);
+    else if (key == "record-drop" && (value == "0" || value == "1"))
+        o.recording.waitWhenFull = value == "0";
+    else if (key == "profile")
+        o.profile = value;
+    else
+    {
+        fprintf(stderr, "uav_sim_headless: bad option %s = \"%s\"\n", key.c_str(), value.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string trim(const std::string &s)
+{
+    const std::size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos)
+        return std::string();
+    return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+}
+
+bool loadConfig(const std::string &path, Options &options)
+{
+    std::ifstream in(path.c_str());
+    if (!in)
+    {
+        fprintf(stderr, "uav_sim_headless: cannot open config %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo)
+    {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos)
+        {
+            fprintf(stderr, "%s:%d: expected key = value\n", path.c_str(), lineNo);
+            return false;
+        }
+        if (!setOption(options, trim(line.substr(0, eq)), trim(line.substr(eq + 1))))
+            return false;
+    }
+    return true;
+}
+
+bool parseArguments(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+        {
+            fputs(kUsage, stdout);
+            exit(0);
+        }
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            fprintf(stderr, "uav_sim_headless: unexpected argument %s\n%s", arg.c_str(), kUsage);
+            return false;
+        }
+        arg = arg.substr(2);
+        std::string value;
+        const std::size_t eq = arg.find('=');
+        if (eq != std::string::npos)
+        {
+            value = arg.substr(eq + 1);
+            arg = arg.substr(0, eq);
+        }
+        else if (i + 1 < argc)
+            value = argv[++i];
+        else
+        {
+            fprintf(stderr, "uav_sim_headless: --%s needs a value\n", arg.c_str());
+            return false;
+        }
+        if (!setOption(options, arg, value))
+            return false;
+    }
+    return true;
+}
+
+// Whole-swarm statistics at one instant
+struct Sample
+{
+    std::size_t phases[3] = {0, 0, 0}; // by FlightPhase
+    double speedSum = 0.0, maxSpeed = 0.0;
+    double altitudeSum = 0.0;       // z: the control law's up axis
+    double radialErrorSquares = 0.0; // |distance to sphereCenter - sphereRadius|^2 over roaming drones
+    std::size_t drones = 0;
+
+    void add(const glm::vec3 &p, const glm::vec3 &v, FlightPhase phase, const glm::vec3 &center, float radius)
+    {
+        const double speed = glm::length(v);
+        ++phases[phase];
+        speedSum += speed;
+        maxSpeed = std::max(maxSpeed, speed);
+        altitudeSum += p.z;
+        if (phase == PhaseRoaming)
+        {
+            const double e = glm::length(p - center) - radius;
+            radialErrorSquares += e * e;
+        }
+        ++drones;
+    }
+};
+
+class MetricsWriter
+{
+  public:
+    explicit MetricsWriter(FILE *out) : out(out)
+    {
+    }
+
+    void interval(unsigned long long step, double simTime, double wallSeconds, std::size_t contacts,
+                  std::size_t obstacleContacts, const Sample &s)
+    {
+        fprintf(out, "{\"step\":%llu,\"time\":%.6g,\"wall_s\":%.6g,", step, simTime, wallSeconds);
+        fields(contacts, obstacleContacts, s);
+        fputs("}\n", out);
+        fflush(out);
+    }
+
+    void summary(const Options &o, const char *kernel, unsigned long long steps, double wallSeconds,
+                 std::size_t contacts, std::size_t obstacleContacts, const Sample &s)
+    {
+        const double rate = wallSeconds > 0.0 ? steps / wallSeconds : 0.0;
+        fprintf(out,
+                "{\"summary\":true,\"engine\":\"%s\",\"kernel\":\"%s\",\"drones\":%zu,\"steps\":%llu,\"dt\":%.6g,"
+                "\"seed\":%u,\"collisions\":%s,\"collider\":\"%s\",\"obstacles\":%zu,\"sim_s\":%.6g,\"wall_s\":%.6g,"
+                "\"steps_per_s\":%.6g,\"drone_steps_per_s\":%.6g,",
+                o.engine.c_str(), kernel, s.drones, steps, o.scenario.dt, o.scenario.seed,
+                o.scenario.collisions ? "true" : "false", o.scenario.collider == ColliderBullet ? "bullet" : "hash",
+                o.scenario.obstacles.size(), steps * static_cast<double>(o.scenario.dt), wallSeconds, rate,
+                rate * s.drones);
+        fields(contacts, obstacleContacts, s);
+        fputs("}\n", out);
+        fflush(out);
+    }
+
+    void recording(const std::string &path, bool ok, const TrajectoryStats &r, double sim)
+    {
+        fprintf(out,
+                "{\"recording\":\"%s\",\"ok\":%s,\"frames\":%llu,\"dropped\":%llu,\"chunks\":%llu,"
+                "\"raw_bytes\":%llu,\"file_bytes\":%llu,\"ratio\":%.6g,\"bytes_per_sim_s\":%.6g}\n",
+                path.c_str(), ok ? "true" : "false", r.framesWritten, r.framesDropped, r.chunks, r.rawBytes,
+                r.fileBytes, r.fileBytes ? static_cast<double>(r.rawBytes) / r.fileBytes : 0.0,
+                sim > 0.0 ? r.fileBytes / sim : 0.0);
+        fflush(out);
+    }
+
+    // Tick timing percentiles in milliseconds, for the interval ending at `step` or (summary) the whole run
+    void profile(unsigned long long step, bool summary, const TickProfile &p)
+    {
+        fprintf(out, "{\"profile\":\"%s\",\"step\":%llu", summary ? "summary" : "interval", step);
+        for (int m = 0; m < MetricCount; ++m)
+        {
+            const LatencyHistogram &h = p.metrics[m];
+            if (h.count() == 0)
+                continue;
+            fprintf(out,
+                    ",\"%s\":{\"count\":%llu,\"mean_ms\":%.6g,\"p50_ms\":%.6g,\"p99_ms\":%.6g,\"p999_ms\":%.6g,"
+                    "\"max_ms\":%.6g}",
+                    tickMetricName(TickMetric(m)), static_cast<unsigned long long>(h.count()), h.mean() * 1e-6,
+                    h.percentile(0.5) * 1e-6, h.percentile(0.99) * 1e-6, h.percentile(0.999) * 1e-6, h.max() * 1e-6);
+        }
+        fputs("}\n", out);
+        fflush(out);
+    }
+
+  private:
+    void fields(std::size_t contacts, std::size_t obstacleContacts, const Sample &s)
+    {
+        const double n = s.drones ? static_cast<double>(s.drones) : 1.0;
+        const double roaming = s.phases[PhaseRoaming] ? static_cast<double>(s.phases[PhaseRoaming]) : 1.0;
+        fprintf(out,
+                "\"resting\":%zu,\"ascending\":%zu,\"roaming\":%zu,\"contacts\":%zu,\"obstacle_contacts\":%zu,"
+                "\"mean_speed\":%.6g,\"max_speed\":%.6g,\"mean_altitude\":%.6g,\"rms_radial_error\":%.6g",
+                s.phases[PhaseResting], s.phases[PhaseAscending], s.phases[PhaseRoaming], contacts, obstacleContacts,
+                s.speedSum / n, s.maxSpeed, s.altitudeSum / n, std::sqrt(s.radialErrorSquares / roaming));
+    }
+
+    FILE *out;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// ECE_UAV objects on the shared SwarmScheduler, in fixed-step mode: the same code path tutorial17 runs
+void runScheduler(const Options &o, BulletScene *scene, TrajectoryRecorder *recorder, MetricsWriter &metrics)
+{
+    const Scenario &scenario = o.scenario;
+    const std::size_t steps = scenario.stepCount();
+    const float dt = scenario.dt;
+    SwarmScheduler &scheduler = SwarmScheduler::instance();
+    scheduler.setFixedStep(dt);
+    scheduler.setCollisions(scenario.collisions);
+    scheduler.setCollisionScene(scene);
+
+    std::vector<std::unique_ptr<ECE_UAV>> uavs;
+    uavs.reserve(scenario.droneCount());
+    std::vector<glm::vec3> starts;
+    for (const ScenarioGroup &g : scenario.groups)
+    {
+        starts.resize(g.formation.droneCount());
+        g.formation.positions(starts.data());
+        for (const glm::vec3 &p : starts)
+        {
+            uavs.push_back(std::make_unique<ECE_UAV>(p, scenario.seed + static_cast<std::uint32_t>(uavs.size())));
+            applyParams(g.params, *uavs.back());
+            uavs.back()->start();
+        }
+    }
+
+    auto sample = [&]() {
+        Sample s;
+        const unsigned long long tick = scheduler.tickCount();
+        for (auto &u : uavs)
+        {
+            const glm::vec3 p = u->getPosition();
+            // elapsed time the way the scheduler computes it in fixed-step mode
+            const float elapsed = static_cast<float>(tick - u->startTick) * dt;
+            const FlightPhase phase = flightPhase(elapsed, u->waitSeconds, glm::length(u->ascendTarget - p),
+                                                  u->sphereRadius);
+            s.add(p, u->getVelocity(), phase, u->sphereCenter, u->sphereRadius);
+        }
+        return s;
+    };
+
+    // profiles are large (a histogram per metric), so they live on the heap; the interval figures are the
+    // latest totals minus the previous ones
+    const bool profiling = !o.profile.empty();
+    std::unique_ptr<TickProfile> totals, previous, interval;
+    if (profiling)
+    {
+        totals.reset(new TickProfile());
+        previous.reset(new TickProfile());
+        interval.reset(new TickProfile());
+        scheduler.profiler().enable();
+    }
+
+    scheduler.setRecorder(recorder);
+    const Clock::time_point t0 = Clock::now();
+    std::size_t done = 0;
+    while (done < steps)
+    {
+        const std::size_t chunk = o.reportEvery ? std::min(o.reportEvery, steps - done) : steps - done;
+        done += scheduler.runSteps(chunk);
+        if (o.reportEvery)
+            metrics.interval(done, done * static_cast<double>(dt), secondsSince(t0), scheduler.contactCount(),
+                             scheduler.obstacleContactCount(), sample());
+        if (o.reportEvery && profiling)
+        {
+            scheduler.profiler().collect(*totals);
+            *interval = *totals;
+            interval->subtract(*previous);
+            *previous = *totals;
+            metrics.profile(done, false, *interval);
+        }
+    }
+    const double wall = secondsSince(t0);
+    metrics.summary(o, "updatePhysics", done, wall, scheduler.contactCount(), scheduler.obstacleContactCount(),
+                    sample());
+    scheduler.setRecorder(NULL);
+    scheduler.setCollisionScene(NULL);
+    if (profiling)
+    {
+        scheduler.profiler().collect(*totals);
+        metrics.profile(done, true, *totals);
+        // between runSteps calls nothing is ticking, so the event rings can be read
+        scheduler.profiler().writeChromeTrace(o.profile.c_str());
+        scheduler.profiler().disable();
+    }
+
+    for (auto &u : uavs)
+        u->stop();
+    for (auto &u : uavs)
+        u->join();
+    scheduler.stop();
+    scheduler.join();
+}
+
+// The vectorized kernel over a SwarmState, with the SpatialHash (or BulletScene) contact pass after every step
+void runSoa(const Options &o, BulletScene *scene, TrajectoryRecorder *recorder, MetricsWriter &metrics)
+{
+    const std::size_t steps = o.scenario.stepCount();
+    const float dt = o.scenario.dt;
+    const ECE_UAV prototype;
+    SwarmState state;
+    populateSwarm(o.scenario, state);
+
+    SpatialHash broadphase;
+    std::vector<ContactPair> contacts;
+    std::vector<ObstacleContact> hits;
+
+    auto sample = [&](float simTime) {
+        Sample s;
+        for (std::size_t i = 0; i < state.size(); ++i)
+            s.add(state.position(i), state.velocity(i), flightPhase(state, i, simTime),
+                  glm::vec3(state.centerX[i], state.centerY[i], state.centerZ[i]), state.sphereRadius[i]);
+        return s;
+    };
+
+    const Clock::time_point t0 = Clock::now();
+    std::size_t step = 0;
+    while (step < steps)
+    {
+        // simulated time from the step count, as the scheduler's fixed-step mode does
+        stepSwarm(state, 0, state.size(), dt, static_cast<float>(step) * dt);
+        ++step;
+        if (o.scenario.collisions && scene)
+        {
+            scene->collide(state.px.data(), state.py.data(), state.pz.data(), state.size(), prototype.size_m,
+                           contacts, hits);
+            resolveContacts(state, contacts);
+            resolveObstacleContacts(state, hits);
+        }
+        else if (o.scenario.collisions)
+        {
+            broadphase.findPairs(state.px.data(), state.py.data(), state.pz.data(), state.size(), prototype.size_m,
+                                 contacts);
+            resolveContacts(state, contacts);
+        }
+        if (recorder)
+            recorder->record(state, step * static_cast<double>(dt));
+        if (o.reportEvery && (step % o.reportEvery == 0 || step == steps))
+            metrics.interval(step, step * static_cast<double>(dt), secondsSince(t0), contacts.size(), hits.size(),
+                             sample(static_cast<float>(step) * dt));
+    }
+    const double wall = secondsSince(t0);
+    metrics.summary(o, swarmKernelName(), step, wall, contacts.size(), hits.size(),
+                    sample(static_cast<float>(step) * dt));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+        return 2;
+
+    FILE *out = stdout;
+    if (!options.output.empty() && !(out = fopen(options.output.c_str(), "w")))
+    {
+        fprintf(stderr, "uav_sim_headless: cannot write %s\n", options.output.c_str());
+        return 1;
+    }
+    MetricsWriter metrics(out);
+
+    TrajectoryRecorder recorder;
+    if (!options.record.empty() &&
+        !recorder.open(options.record.c_str(), options.scenario.droneCount(), options.recording))
+        return 1;
+    TrajectoryRecorder *recording = recorder.isOpen() ? &recorder : NULL;
+
+    if (!options.profile.empty() && options.engine != "scheduler")
+    {
+        fprintf(stderr, "uav_sim_headless: --profile times the scheduler engine only\n");
+        return 2;
+    }
+
+    if (!options.scenario.obstacles.empty() && options.scenario.collider != ColliderBullet)
+    {
+        fprintf(stderr, "uav_sim_headless: obstacles need --collider bullet\n");
+        return 2;
+    }
+    // the scene (and its obstacle meshes) exists only with the bullet collider
+    std::unique_ptr<BulletScene> scene;
+    if (options.scenario.collider == ColliderBullet)
+    {
+        scene.reset(new BulletScene());
+        if (!addScenarioObstacles(options.scenario, *scene))
+            return 1;
+    }
+
+    if (options.engine == "soa")
+        runSoa(options, scene.get(), recording, metrics);
+    else
+        runScheduler(options, scene.get(), recording, metrics);
+
+    int status = 0;
+    if (recording)
+    {
+        const bool ok = recorder.close();
+        metrics.recording(options.record, ok, recorder.stats(),
+                          options.scenario.stepCount() * static_cast<double>(options.scenario.dt));
+        status = ok ? 0 : 1;
+    }
+
+    if (out != stdout)
+        fclose(out);
+    return status;
+}